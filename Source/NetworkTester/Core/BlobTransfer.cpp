@@ -0,0 +1,343 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+//
+
+#include "BlobTransfer.h"
+#include "Engine/NetConnection.h"
+#include "Misc/Crc.h"
+#include "Net/DataBunch.h"
+#include "MyChatChannel.h"
+#include "MinimalClient.h"
+
+
+void FBlobSender::Start(uint32 BlobId, const FBlobDataRef& Data, const TArray<UMyChatChannel*>& Channels)
+{
+	FBlobTransfer& Transfer = Transfers.Emplace_GetRef(Data);
+
+	Transfer.BlobId = BlobId;
+	Transfer.Crc = FCrc::MemCrc32(Data->GetData(), Data->Num());
+	Transfer.StartTime = FPlatformTime::Seconds();
+
+	for (UMyChatChannel* CurChannel : Channels)
+	{
+		Transfer.Destinations.AddDefaulted_GetRef().Channel = CurChannel;
+	}
+
+	UE_LOG(LogNetworkTester, Log, TEXT("Blob %u: streaming %d bytes to %d connections"), BlobId, Data->Num(), Channels.Num());
+}
+
+void FBlobSender::Pause(uint32 BlobId)
+{
+	FBlobTransfer* Transfer = FindTransfer(BlobId);
+
+	if (Transfer != nullptr && !Transfer->IsPaused())
+	{
+		Transfer->PauseStartTime = FPlatformTime::Seconds();
+	}
+}
+
+void FBlobSender::Resume(uint32 BlobId)
+{
+	FBlobTransfer* Transfer = FindTransfer(BlobId);
+
+	if (Transfer != nullptr && Transfer->IsPaused())
+	{
+		Transfer->PausedSeconds += FPlatformTime::Seconds() - Transfer->PauseStartTime;
+		Transfer->PauseStartTime = 0.0;
+	}
+}
+
+void FBlobSender::Cancel(uint32 BlobId)
+{
+	const int32 TransferIdx = Transfers.IndexOfByPredicate([BlobId](const FBlobTransfer& InTransfer)
+		{
+			return InTransfer.BlobId == BlobId;
+		});
+
+	if (TransferIdx != INDEX_NONE && !Transfers[TransferIdx].bCancelled)
+	{
+		FBlobTransfer& Transfer = Transfers[TransferIdx];
+
+		Transfer.bCancelled = true;
+
+		if (TickCancel(Transfer))
+		{
+			FinishTransfer(Transfer, true);
+			Transfers.RemoveAt(TransferIdx);
+		}
+		else
+		{
+			UE_LOG(LogNetworkTester, Log, TEXT("Blob %u: cancel waiting for reliable buffer room"), BlobId);
+		}
+	}
+}
+
+bool FBlobSender::TickCancel(FBlobTransfer& Transfer)
+{
+	bool bReturnVal = true;
+
+	for (FBlobDestination& CurDest : Transfer.Destinations)
+	{
+		UMyChatChannel* Channel = CurDest.Channel.Get();
+
+		if (CurDest.bDone)
+		{
+			continue;
+		}
+		else if (CurDest.bEndSent)
+		{
+			// Fully sent already, only the ack was outstanding
+			CurDest.bDone = true;
+			CurDest.EndTime = FPlatformTime::Seconds();
+		}
+		else if (Channel == nullptr || !CurDest.bBegun || Channel->Closing)
+		{
+			CurDest.bDone = true;
+			CurDest.bFailed = true;
+		}
+		// A reliable bunch sent into a full reliable buffer closes the connection, so wait for acks to make room
+		else if (Channel->NumOutRec < RELIABLE_BUFFER - 1)
+		{
+			uint8 MessageType = (uint8)EChatMessageType::BlobEnd;
+			uint32 Id = Transfer.BlobId;
+			uint8 bCancelled = 1;
+			FOutBunch OutBunch(Channel, false);
+
+			OutBunch.bReliable = 1;
+			OutBunch << MessageType;
+			OutBunch.SerializeIntPacked(Id);
+			OutBunch << bCancelled;
+
+			Channel->SendBunch(&OutBunch, false);
+
+			CurDest.bDone = true;
+			CurDest.bFailed = true;
+		}
+		else
+		{
+			bReturnVal = false;
+		}
+	}
+
+	return bReturnVal;
+}
+
+void FBlobSender::Tick()
+{
+	const int32 ReliableLimit = FMath::Max(1, (int32)(RELIABLE_BUFFER * FlowSettings.ReliableBufferFraction));
+
+	for (int32 TransferIdx = Transfers.Num() - 1; TransferIdx >= 0; TransferIdx--)
+	{
+		FBlobTransfer& Transfer = Transfers[TransferIdx];
+
+		if (Transfer.bCancelled)
+		{
+			if (TickCancel(Transfer))
+			{
+				FinishTransfer(Transfer, true);
+				Transfers.RemoveAt(TransferIdx);
+			}
+
+			continue;
+		}
+
+		bool bAllDone = true;
+
+		for (FBlobDestination& CurDest : Transfer.Destinations)
+		{
+			if (!Transfer.IsPaused() && !CurDest.bDone)
+			{
+				TickDestination(Transfer, CurDest, ReliableLimit);
+			}
+
+			bAllDone = bAllDone && CurDest.bDone;
+		}
+
+		if (bAllDone)
+		{
+			FinishTransfer(Transfer, false);
+			Transfers.RemoveAt(TransferIdx);
+		}
+	}
+}
+
+void FBlobSender::TickDestination(FBlobTransfer& Transfer, FBlobDestination& Dest, int32 ReliableLimit)
+{
+	UMyChatChannel* Channel = Dest.Channel.Get();
+	const TArray<uint8>& Data = *Transfer.Data;
+
+	if (Channel == nullptr || Channel->Closing || Channel->Connection == nullptr ||
+		Channel->Connection->GetConnectionState() == USOCK_Closed)
+	{
+		Dest.bDone = true;
+		Dest.bFailed = true;
+		Dest.EndTime = FPlatformTime::Seconds();
+		return;
+	}
+
+	UNetConnection* Connection = Channel->Connection;
+
+	// Done once BlobEnd is acked - acked bunches leave the reliable buffer in sequence order
+	if (Dest.bEndSent)
+	{
+		if (Channel->OutRec == nullptr || Channel->OutRec->ChSequence > Dest.EndSequence)
+		{
+			Dest.bDone = true;
+			Dest.EndTime = FPlatformTime::Seconds();
+		}
+
+		return;
+	}
+
+	while (!Dest.bEndSent && !Dest.bDone)
+	{
+		// Leave the rest of the reliable buffer to other traffic, and stop once the connection is saturated
+		if (Channel->NumOutRec >= ReliableLimit || !Connection->IsNetReady(false))
+		{
+			Dest.NumStalls++;
+			break;
+		}
+
+		uint8 MessageType = 0;
+		uint32 Id = Transfer.BlobId;
+		FOutBunch OutBunch(Channel, false);
+
+		OutBunch.bReliable = 1;
+
+		if (!Dest.bBegun)
+		{
+			int64 TotalBytes = Data.Num();
+			uint32 Crc = Transfer.Crc;
+
+			MessageType = (uint8)EChatMessageType::BlobBegin;
+			OutBunch << MessageType;
+			OutBunch.SerializeIntPacked(Id);
+			OutBunch << TotalBytes;
+			OutBunch << Crc;
+
+			Dest.bBegun = true;
+		}
+		else if (Dest.Offset < Data.Num())
+		{
+			int64 Offset = Dest.Offset;
+			uint32 ChunkBytes = (uint32)FMath::Min<int64>(FlowSettings.ChunkBytes, Data.Num() - Offset);
+
+			MessageType = (uint8)EChatMessageType::BlobChunk;
+			OutBunch << MessageType;
+			OutBunch.SerializeIntPacked(Id);
+			OutBunch << Offset;
+			OutBunch.SerializeIntPacked(ChunkBytes);
+			OutBunch.Serialize((void*)(Data.GetData() + Offset), ChunkBytes);
+
+			Dest.Offset += ChunkBytes;
+		}
+		else
+		{
+			uint8 bCancelled = 0;
+
+			MessageType = (uint8)EChatMessageType::BlobEnd;
+			OutBunch << MessageType;
+			OutBunch.SerializeIntPacked(Id);
+			OutBunch << bCancelled;
+		}
+
+		if (OutBunch.IsError())
+		{
+			UE_LOG(LogNetworkTester, Warning, TEXT("Blob %u: chunk does not fit in a bunch, abandoning transfer to %s"),
+				Transfer.BlobId, *Connection->LowLevelGetRemoteAddress(true));
+
+			Dest.bDone = true;
+			Dest.bFailed = true;
+			break;
+		}
+
+		Channel->SendBunch(&OutBunch, false);
+
+		if (MessageType == (uint8)EChatMessageType::BlobEnd)
+		{
+			Dest.bEndSent = true;
+			Dest.EndSequence = Connection->OutReliable[Channel->ChIndex];
+		}
+	}
+}
+
+void FBlobSender::FinishTransfer(const FBlobTransfer& Transfer, bool bCancelled)
+{
+	FBlobTransferResult& Result = Results.AddDefaulted_GetRef();
+	const double PausedSeconds = Transfer.PausedSeconds + (Transfer.IsPaused() ? FPlatformTime::Seconds() - Transfer.PauseStartTime : 0.0);
+
+	Result.BlobId = Transfer.BlobId;
+	Result.NumBytes = Transfer.Data->Num();
+	Result.NumDestinations = Transfer.Destinations.Num();
+	Result.bCancelled = bCancelled;
+
+	for (const FBlobDestination& CurDest : Transfer.Destinations)
+	{
+		if (CurDest.bDone && !CurDest.bFailed)
+		{
+			Result.NumCompleted++;
+			Result.Seconds = FMath::Max(Result.Seconds, CurDest.EndTime - Transfer.StartTime - PausedSeconds);
+		}
+
+		Result.NumStalls += CurDest.NumStalls;
+	}
+
+	UE_LOG(LogNetworkTester, Log, TEXT("Blob %u: %s, %d/%d connections, %lld bytes in %.3f s (%.2f MB/s per connection), %u stalls"),
+		Result.BlobId, bCancelled ? TEXT("cancelled") : TEXT("sent"), Result.NumCompleted, Result.NumDestinations, Result.NumBytes,
+		Result.Seconds, Result.GetMBps(), Result.NumStalls);
+}
+
+void FBlobSender::SetFlowSettings(const FBlobFlowSettings& InSettings)
+{
+	FlowSettings.ChunkBytes = FMath::Clamp(InSettings.ChunkBytes, 64, FBlobFlowSettings::MaxChunkBytes);
+	FlowSettings.ReliableBufferFraction = FMath::Clamp(InSettings.ReliableBufferFraction, 0.01f, 0.75f);
+}
+
+void FBlobSender::Reset()
+{
+	for (FBlobTransfer& CurTransfer : Transfers)
+	{
+		CurTransfer.bCancelled = true;
+
+		if (!TickCancel(CurTransfer))
+		{
+			UE_LOG(LogNetworkTester, Warning, TEXT("Blob %u: dropped without telling every destination (reliable buffer full)"),
+				CurTransfer.BlobId);
+		}
+
+		FinishTransfer(CurTransfer, true);
+	}
+
+	Transfers.Reset();
+}
+
+void FBlobSender::LogReport() const
+{
+	for (const FBlobTransfer& CurTransfer : Transfers)
+	{
+		int64 MinOffset = CurTransfer.Data->Num();
+
+		for (const FBlobDestination& CurDest : CurTransfer.Destinations)
+		{
+			MinOffset = CurDest.bDone ? MinOffset : FMath::Min(MinOffset, CurDest.Offset);
+		}
+
+		UE_LOG(LogNetworkTester, Log, TEXT("Blob %u: %s, slowest connection at %lld/%d bytes"), CurTransfer.BlobId,
+			CurTransfer.bCancelled ? TEXT("cancelling") : CurTransfer.IsPaused() ? TEXT("paused") : TEXT("streaming"), MinOffset,
+			CurTransfer.Data->Num());
+	}
+
+	for (const FBlobTransferResult& CurResult : Results)
+	{
+		UE_LOG(LogNetworkTester, Log, TEXT("Blob %u: %s, %d/%d connections, %lld bytes in %.3f s (%.2f MB/s per connection), %u stalls"),
+			CurResult.BlobId, CurResult.bCancelled ? TEXT("cancelled") : TEXT("sent"), CurResult.NumCompleted,
+			CurResult.NumDestinations, CurResult.NumBytes, CurResult.Seconds, CurResult.GetMBps(), CurResult.NumStalls);
+	}
+}
+
+FBlobTransfer* FBlobSender::FindTransfer(uint32 BlobId)
+{
+	return Transfers.FindByPredicate([BlobId](const FBlobTransfer& InTransfer)
+		{
+			return InTransfer.BlobId == BlobId;
+		});
+}
@@ -0,0 +1,214 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/WeakObjectPtrTemplates.h"
+
+
+class UMyChatChannel;
+
+
+/** Shared, immutable blob data (shared between the game thread, the net thread and every destination) */
+typedef TSharedRef<const TArray<uint8>, ESPMode::ThreadSafe> FBlobDataRef;
+
+
+/** Flow control of blob streaming */
+struct FBlobFlowSettings
+{
+	/** The size of each chunk bunch, in bytes. Chunks larger than a packet go out as partial bunches, all counted by flow control */
+	int32 ChunkBytes = 4096;
+
+	/** The largest allowed chunk, well within the engine's partial bunch limits */
+	static constexpr int32 MaxChunkBytes = 32 * 1024;
+
+	/**
+	 * Chunks are only sent while the chat channel has fewer unacked reliable bunches than this fraction of RELIABLE_BUFFER
+	 * (at most 0.75, leaving room for the partial bunches of one more chunk)
+	 */
+	float ReliableBufferFraction = 0.5f;
+};
+
+
+/** Progress of one blob to one connection */
+struct FBlobDestination
+{
+	TWeakObjectPtr<UMyChatChannel> Channel;
+
+	/** The number of bytes sent so far */
+	int64 Offset = 0;
+
+	/** Whether or not BlobBegin has been sent */
+	bool bBegun = false;
+
+	/** Whether or not BlobEnd has been sent (the blob is done once it is acked) */
+	bool bEndSent = false;
+
+	/** The reliable sequence of the BlobEnd bunch */
+	int32 EndSequence = 0;
+
+	/** Whether or not the blob has been fully sent and acked (or the connection went away, or it was cancelled) */
+	bool bDone = false;
+
+	/** Whether or not the connection went away, or the transfer was cancelled, before the blob was fully sent */
+	bool bFailed = false;
+
+	/** The time (FPlatformTime::Seconds) BlobEnd was acked */
+	double EndTime = 0.0;
+
+	/** The number of ticks sending stopped early, because of flow control */
+	uint32 NumStalls = 0;
+};
+
+
+/** A blob being streamed to a set of connections */
+struct FBlobTransfer
+{
+	uint32 BlobId = 0;
+
+	FBlobDataRef Data;
+
+	uint32 Crc = 0;
+
+	/** The time (FPlatformTime::Seconds) the transfer started */
+	double StartTime = 0.0;
+
+	/** Time spent paused (excluded from throughput) */
+	double PausedSeconds = 0.0;
+
+	/** The time (FPlatformTime::Seconds) the transfer was paused, or 0 if it isn't */
+	double PauseStartTime = 0.0;
+
+	/** Whether or not the transfer was cancelled, and is waiting for reliable buffer room to tell some destinations */
+	bool bCancelled = false;
+
+	TArray<FBlobDestination> Destinations;
+
+	explicit FBlobTransfer(const FBlobDataRef& InData)
+		: Data(InData)
+	{
+	}
+
+	bool IsPaused() const
+	{
+		return PauseStartTime > 0.0;
+	}
+};
+
+
+/** A finished transfer, kept for reporting */
+struct FBlobTransferResult
+{
+	uint32 BlobId = 0;
+
+	int64 NumBytes = 0;
+
+	int32 NumDestinations = 0;
+
+	/** The number of destinations which received the whole blob */
+	int32 NumCompleted = 0;
+
+	/** Time to completion of the slowest destination, excluding pauses */
+	double Seconds = 0.0;
+
+	uint32 NumStalls = 0;
+
+	bool bCancelled = false;
+
+	/** @return The sustained throughput per destination, in MB/s */
+	double GetMBps() const
+	{
+		return Seconds > 0.0 ? NumBytes / (1024.0 * 1024.0) / Seconds : 0.0;
+	}
+};
+
+
+/** A blob being received on one chat channel */
+struct FBlobReceiveState
+{
+	/** The largest blob accepted */
+	static constexpr int64 MaxBlobBytes = 256ll * 1024 * 1024;
+
+	/** The most blobs received at once, per channel */
+	static constexpr int32 MaxIncomingBlobs = 16;
+
+	/** The bytes received so far - grown as chunks arrive, never preallocated to the size the peer claims */
+	TArray<uint8> Data;
+
+	int64 TotalBytes = 0;
+
+	uint32 Crc = 0;
+
+	double StartTime = 0.0;
+};
+
+
+/**
+ * Streams blobs of any size to a set of connections over the chat channel, as a sequence of reliable chunk bunches.
+ *
+ * Each tick, every destination is sent chunks until its reliable buffer reaches the flow control limit or the
+ * connection is saturated, so blobs never overflow the reliable buffer and other chat traffic always has room.
+ * Paused transfers keep their position, and resume from it.
+ */
+class NETWORKTESTER_API FBlobSender
+{
+public:
+	/**
+	 * Starts streaming a blob
+	 *
+	 * @param BlobId		The id of the blob (unique within the session)
+	 * @param Data			The blob
+	 * @param Channels		The chat channels to stream to
+	 */
+	void Start(uint32 BlobId, const FBlobDataRef& Data, const TArray<UMyChatChannel*>& Channels);
+
+	void Pause(uint32 BlobId);
+
+	void Resume(uint32 BlobId);
+
+	/**
+	 * Stops streaming a blob, telling the destinations to discard what they received. Destinations whose reliable
+	 * buffer is full are told by later ticks, once acks make room.
+	 */
+	void Cancel(uint32 BlobId);
+
+	/** Sends as many chunks as flow control allows, and retires finished transfers */
+	void Tick();
+
+	void SetFlowSettings(const FBlobFlowSettings& InSettings);
+
+	/** Cancels every transfer, dropping them even if some destinations could not be told */
+	void Reset();
+
+	/** Writes active and finished transfers to the log (on the thread ticking the net driver, or under its NetTickLock) */
+	void LogReport() const;
+
+	int32 GetNumActive() const
+	{
+		return Transfers.Num();
+	}
+
+	const TArray<FBlobTransferResult>& GetResults() const
+	{
+		return Results;
+	}
+
+private:
+	FBlobTransfer* FindTransfer(uint32 BlobId);
+
+	/** Sends chunks to one destination, until flow control stops it */
+	void TickDestination(FBlobTransfer& Transfer, FBlobDestination& Dest, int32 ReliableLimit);
+
+	/** Tells the destinations of a cancelled transfer to discard it, @return Whether or not every destination is settled */
+	bool TickCancel(FBlobTransfer& Transfer);
+
+	void FinishTransfer(const FBlobTransfer& Transfer, bool bCancelled);
+
+private:
+	FBlobFlowSettings FlowSettings;
+
+	TArray<FBlobTransfer> Transfers;
+
+	TArray<FBlobTransferResult> Results;
+};
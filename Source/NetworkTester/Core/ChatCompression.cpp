@@ -0,0 +1,171 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+//
+
+#include "ChatCompression.h"
+#include "Serialization/BitWriter.h"
+#include "MyChatChannel.h"
+
+
+/** Codecs are sent as an index into this table, rather than as a name */
+static FName GetCodecByIndex(uint32 Index)
+{
+	static const FName Codecs[] = { NAME_Zlib, NAME_Gzip, NAME_LZ4, NAME_Oodle };
+
+	return Index < UE_ARRAY_COUNT(Codecs) ? Codecs[Index] : FName(NAME_None);
+}
+
+static uint32 GetCodecIndex(FName Codec)
+{
+	uint32 ReturnVal = 0;
+
+	while (GetCodecByIndex(ReturnVal) != NAME_None && GetCodecByIndex(ReturnVal) != Codec)
+	{
+		ReturnVal++;
+	}
+
+	return ReturnVal;
+}
+
+
+bool FChatCompression::Compress(const FChatCompressionSettings& Settings, const FBitWriter& Payload, FBitWriter& OutPayload,
+	TArray<uint8>& Scratch, FChatCompressionStats& Stats)
+{
+	const int32 UncompressedSize = (int32)Payload.GetNumBytes();
+	uint32 CodecIndex = GetCodecIndex(Settings.Codec);
+	bool bReturnVal = false;
+
+	if (!Settings.bEnabled || GetCodecByIndex(CodecIndex) == NAME_None || UncompressedSize > MaxUncompressedBytes)
+	{
+		return false;
+	}
+
+	if (UncompressedSize < Settings.ThresholdBytes)
+	{
+		Stats.NumBelowThreshold++;
+		return false;
+	}
+
+	const ECompressionFlags Flags = GetCompressionFlags(Settings.Level);
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+	int32 CompressedSize = FCompression::CompressMemoryBound(Settings.Codec, UncompressedSize, Flags);
+
+	Scratch.SetNumUninitialized(CompressedSize, false);
+
+	const bool bCompressed = FCompression::CompressMemory(Settings.Codec, Scratch.GetData(), CompressedSize, Payload.GetData(),
+		UncompressedSize, Flags);
+
+	Stats.CompressSeconds += FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles);
+	Stats.AttemptedBytes += UncompressedSize;
+
+	// The wrapper costs a type byte and three packed ints, so only count it as a win if the total shrinks
+	if (bCompressed && CompressedSize + 8 < UncompressedSize)
+	{
+		uint8 MessageType = (uint8)EChatMessageType::Compressed;
+		uint32 NumBits = (uint32)Payload.GetNumBits();
+		uint32 NumCompressedBytes = (uint32)CompressedSize;
+
+		OutPayload.Reset();
+		OutPayload << MessageType;
+		OutPayload.SerializeIntPacked(CodecIndex);
+		OutPayload.SerializeIntPacked(NumBits);
+		OutPayload.SerializeIntPacked(NumCompressedBytes);
+		OutPayload.Serialize(Scratch.GetData(), CompressedSize);
+
+		Stats.NumCompressed++;
+		Stats.UncompressedBytes += UncompressedSize;
+		Stats.CompressedBytes += OutPayload.GetNumBytes();
+
+		bReturnVal = true;
+	}
+	else
+	{
+		Stats.NumIncompressible++;
+	}
+
+	return bReturnVal;
+}
+
+bool FChatCompression::Decompress(FArchive& Ar, TArray<uint8>& OutData, int64& OutNumBits, TArray<uint8>& Scratch,
+	FChatCompressionStats& Stats)
+{
+	uint32 CodecIndex = 0;
+	uint32 NumBits = 0;
+	uint32 NumCompressedBytes = 0;
+
+	Ar.SerializeIntPacked(CodecIndex);
+	Ar.SerializeIntPacked(NumBits);
+	Ar.SerializeIntPacked(NumCompressedBytes);
+
+	const FName Codec = GetCodecByIndex(CodecIndex);
+	const int32 UncompressedSize = (int32)((NumBits + 7) / 8);
+
+	if (Ar.IsError() || Codec == NAME_None || NumBits == 0 || UncompressedSize > MaxUncompressedBytes ||
+		NumCompressedBytes > (uint32)MaxUncompressedBytes)
+	{
+		Ar.SetError();
+		return false;
+	}
+
+	Scratch.SetNumUninitialized(NumCompressedBytes, false);
+	Ar.Serialize(Scratch.GetData(), NumCompressedBytes);
+
+	if (Ar.IsError())
+	{
+		return false;
+	}
+
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+
+	OutData.SetNumUninitialized(UncompressedSize, false);
+
+	const bool bReturnVal = FCompression::UncompressMemory(Codec, OutData.GetData(), UncompressedSize, Scratch.GetData(),
+		NumCompressedBytes);
+
+	Stats.DecompressSeconds += FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles);
+
+	if (bReturnVal)
+	{
+		Stats.NumDecompressed++;
+		Stats.DecompressedBytes += UncompressedSize;
+
+		OutNumBits = NumBits;
+	}
+	else
+	{
+		Ar.SetError();
+	}
+
+	return bReturnVal;
+}
+
+FName FChatCompression::FindCodec(const FString& InName)
+{
+	FName ReturnVal = NAME_None;
+
+	for (uint32 i = 0; GetCodecByIndex(i) != NAME_None; i++)
+	{
+		if (InName.Equals(GetCodecByIndex(i).ToString(), ESearchCase::IgnoreCase))
+		{
+			ReturnVal = GetCodecByIndex(i);
+			break;
+		}
+	}
+
+	return ReturnVal;
+}
+
+ECompressionFlags FChatCompression::GetCompressionFlags(EChatCompressionLevel Level)
+{
+	ECompressionFlags ReturnVal = COMPRESS_NoFlags;
+
+	if (Level == EChatCompressionLevel::Fast)
+	{
+		ReturnVal = COMPRESS_BiasSpeed;
+	}
+	else if (Level == EChatCompressionLevel::Size)
+	{
+		ReturnVal = COMPRESS_BiasSize;
+	}
+
+	return ReturnVal;
+}
@@ -0,0 +1,123 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/Compression.h"
+
+
+class FBitWriter;
+
+
+/** How hard the codec works, mapped onto the engine's compression bias flags */
+enum class EChatCompressionLevel : uint8
+{
+	Fast,
+	Default,
+	Size
+};
+
+
+/** Settings for compressing chat payloads */
+struct FChatCompressionSettings
+{
+	/** Whether or not payloads are compressed */
+	bool bEnabled = false;
+
+	/** The FCompression codec (NAME_Zlib, NAME_Gzip, NAME_LZ4 or NAME_Oodle) */
+	FName Codec = NAME_Zlib;
+
+	EChatCompressionLevel Level = EChatCompressionLevel::Default;
+
+	/** Payloads smaller than this (in bytes) are sent as-is */
+	int32 ThresholdBytes = 256;
+};
+
+
+/** Compression counters, for deciding whether compression pays for its CPU cost */
+struct FChatCompressionStats
+{
+	/** Payloads sent compressed */
+	uint64 NumCompressed = 0;
+
+	/** Payloads below the threshold */
+	uint64 NumBelowThreshold = 0;
+
+	/** Payloads compressed, but sent as-is because compression didn't make them smaller */
+	uint64 NumIncompressible = 0;
+
+	/** Input/output bytes of the payloads sent compressed */
+	uint64 UncompressedBytes = 0;
+	uint64 CompressedBytes = 0;
+
+	/** Time spent compressing (including incompressible payloads) */
+	double CompressSeconds = 0.0;
+
+	/** Input bytes of every compression attempt, for CPU per KB */
+	uint64 AttemptedBytes = 0;
+
+	/** Payloads received compressed, and time spent decompressing them */
+	uint64 NumDecompressed = 0;
+	uint64 DecompressedBytes = 0;
+	double DecompressSeconds = 0.0;
+
+	/** @return Compressed size as a fraction of the uncompressed size (lower is better) */
+	double GetRatio() const
+	{
+		return UncompressedBytes > 0 ? (double)CompressedBytes / (double)UncompressedBytes : 1.0;
+	}
+
+	/** @return Microseconds of compression CPU per KB attempted */
+	double GetCompressMicrosPerKB() const
+	{
+		return AttemptedBytes > 0 ? CompressSeconds * 1000000.0 / (AttemptedBytes / 1024.0) : 0.0;
+	}
+
+	/** @return Microseconds of decompression CPU per KB produced */
+	double GetDecompressMicrosPerKB() const
+	{
+		return DecompressedBytes > 0 ? DecompressSeconds * 1000000.0 / (DecompressedBytes / 1024.0) : 0.0;
+	}
+};
+
+
+/**
+ * Wraps chat payloads into EChatMessageType::Compressed messages and back. The wrapped message is the complete original
+ * payload (type and body), so any message type can be compressed.
+ */
+struct NETWORKTESTER_API FChatCompression
+{
+	/** The largest uncompressed payload accepted when decompressing */
+	static constexpr int32 MaxUncompressedBytes = 1024 * 1024;
+
+	/**
+	 * Compresses a payload, if enabled and worthwhile
+	 *
+	 * @param Settings		The compression settings
+	 * @param Payload		The complete chat message
+	 * @param OutPayload	Receives the Compressed message (reset first)
+	 * @param Scratch		Reusable compression buffer
+	 * @param Stats			Updated with the outcome
+	 * @return				Whether or not OutPayload should be sent instead of Payload
+	 */
+	static bool Compress(const FChatCompressionSettings& Settings, const FBitWriter& Payload, FBitWriter& OutPayload,
+		TArray<uint8>& Scratch, FChatCompressionStats& Stats);
+
+	/**
+	 * Reads the body of a Compressed message (after its type), and decompresses the wrapped payload
+	 *
+	 * @param Ar			The archive to read from (set to error on malformed input)
+	 * @param OutData		Receives the wrapped payload (allocation reused)
+	 * @param OutNumBits	Receives the size of the wrapped payload in bits
+	 * @param Scratch		Reusable buffer for the compressed bytes
+	 * @param Stats			Updated with the decompression cost
+	 * @return				Whether or not decompression succeeded
+	 */
+	static bool Decompress(FArchive& Ar, TArray<uint8>& OutData, int64& OutNumBits, TArray<uint8>& Scratch, FChatCompressionStats& Stats);
+
+	/** @return The codec matching a name (case insensitive), or NAME_None if unsupported */
+	static FName FindCodec(const FString& InName);
+
+	static ECompressionFlags GetCompressionFlags(EChatCompressionLevel Level);
+};
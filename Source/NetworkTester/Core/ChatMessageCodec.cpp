@@ -0,0 +1,246 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+//
+
+#include "ChatMessageCodec.h"
+
+
+/** The code point substituted for malformed input */
+static constexpr uint32 ReplacementCodePoint = 0xFFFD;
+
+/** Reads the code point at Src[Index], combining UTF-16 surrogate pairs, and advances Index past it */
+static FORCEINLINE uint32 NextCodePoint(const TCHAR* Src, int32 Len, int32& Index)
+{
+	uint32 ReturnVal = (uint32)Src[Index++];
+
+	if (ReturnVal >= 0xD800 && ReturnVal <= 0xDBFF && Index < Len)
+	{
+		const uint32 LowSurrogate = (uint32)Src[Index];
+
+		if (LowSurrogate >= 0xDC00 && LowSurrogate <= 0xDFFF)
+		{
+			ReturnVal = 0x10000 + ((ReturnVal - 0xD800) << 10) + (LowSurrogate - 0xDC00);
+			Index++;
+		}
+	}
+
+	if (ReturnVal > 0x10FFFF || (ReturnVal >= 0xD800 && ReturnVal <= 0xDFFF))
+	{
+		ReturnVal = ReplacementCodePoint;
+	}
+
+	return ReturnVal;
+}
+
+static FORCEINLINE int32 GetUtf8Bytes(uint32 CodePoint)
+{
+	return CodePoint < 0x80 ? 1 : (CodePoint < 0x800 ? 2 : (CodePoint < 0x10000 ? 3 : 4));
+}
+
+/** Encodes a code point as UTF-8, returning the number of bytes written (up to 4) */
+static FORCEINLINE int32 EncodeUtf8(uint32 CodePoint, uint8* Dest)
+{
+	const int32 NumBytes = GetUtf8Bytes(CodePoint);
+
+	switch (NumBytes)
+	{
+	case 1:
+		Dest[0] = (uint8)CodePoint;
+		break;
+
+	case 2:
+		Dest[0] = (uint8)(0xC0 | (CodePoint >> 6));
+		Dest[1] = (uint8)(0x80 | (CodePoint & 0x3F));
+		break;
+
+	case 3:
+		Dest[0] = (uint8)(0xE0 | (CodePoint >> 12));
+		Dest[1] = (uint8)(0x80 | ((CodePoint >> 6) & 0x3F));
+		Dest[2] = (uint8)(0x80 | (CodePoint & 0x3F));
+		break;
+
+	default:
+		Dest[0] = (uint8)(0xF0 | (CodePoint >> 18));
+		Dest[1] = (uint8)(0x80 | ((CodePoint >> 12) & 0x3F));
+		Dest[2] = (uint8)(0x80 | ((CodePoint >> 6) & 0x3F));
+		Dest[3] = (uint8)(0x80 | (CodePoint & 0x3F));
+		break;
+	}
+
+	return NumBytes;
+}
+
+/** Appends a code point to a character array, as a surrogate pair if TCHAR is UTF-16 */
+static FORCEINLINE void AppendCodePoint(TArray<TCHAR>& Chars, uint32 CodePoint)
+{
+	// Embedded nulls would terminate the string early
+	if (CodePoint == 0 || CodePoint > 0x10FFFF || (CodePoint >= 0xD800 && CodePoint <= 0xDFFF))
+	{
+		CodePoint = ReplacementCodePoint;
+	}
+
+	if (sizeof(TCHAR) == 2 && CodePoint >= 0x10000)
+	{
+		CodePoint -= 0x10000;
+
+		Chars.Add((TCHAR)(0xD800 + (CodePoint >> 10)));
+		Chars.Add((TCHAR)(0xDC00 + (CodePoint & 0x3FF)));
+	}
+	else
+	{
+		Chars.Add((TCHAR)CodePoint);
+	}
+}
+
+
+void FChatMessageCodec::WriteText(FArchive& Ar, const FString& InText)
+{
+	const TCHAR* Src = *InText;
+	const int32 Len = InText.Len();
+	uint32 NumBytes = 0;
+	uint8 Buffer[256];
+	int32 BufferLen = 0;
+
+	// Measure first, so the length can be written up front without buffering the whole string
+	for (int32 i = 0; i < Len;)
+	{
+		NumBytes += GetUtf8Bytes(NextCodePoint(Src, Len, i));
+	}
+
+	Ar.SerializeIntPacked(NumBytes);
+
+	for (int32 i = 0; i < Len;)
+	{
+		if (BufferLen > (int32)sizeof(Buffer) - 4)
+		{
+			Ar.Serialize(Buffer, BufferLen);
+			BufferLen = 0;
+		}
+
+		BufferLen += EncodeUtf8(NextCodePoint(Src, Len, i), Buffer + BufferLen);
+	}
+
+	if (BufferLen > 0)
+	{
+		Ar.Serialize(Buffer, BufferLen);
+	}
+}
+
+bool FChatMessageCodec::ReadText(FArchive& Ar, FString& OutText)
+{
+	uint32 NumBytes = 0;
+
+	Ar.SerializeIntPacked(NumBytes);
+
+	if (Ar.IsError() || NumBytes > MaxTextBytes)
+	{
+		Ar.SetError();
+		return false;
+	}
+
+	TArray<TCHAR>& Chars = OutText.GetCharArray();
+	uint8 Buffer[256];
+	uint32 CodePoint = 0;
+	int32 NumContinuationBytes = 0;
+
+	// Never more characters than bytes, Reset keeps the existing allocation
+	Chars.Reset(NumBytes + 1);
+
+	for (uint32 Offset = 0; Offset < NumBytes && !Ar.IsError();)
+	{
+		const int32 ChunkLen = (int32)FMath::Min<uint32>(NumBytes - Offset, sizeof(Buffer));
+
+		Ar.Serialize(Buffer, ChunkLen);
+		Offset += ChunkLen;
+
+		for (int32 i = 0; i < ChunkLen;)
+		{
+			const uint8 CurByte = Buffer[i];
+
+			if (NumContinuationBytes > 0)
+			{
+				if ((CurByte & 0xC0) == 0x80)
+				{
+					CodePoint = (CodePoint << 6) | (CurByte & 0x3F);
+					i++;
+
+					if (--NumContinuationBytes == 0)
+					{
+						AppendCodePoint(Chars, CodePoint);
+					}
+				}
+				else
+				{
+					// Truncated sequence - substitute it, and reprocess this byte as a lead byte
+					AppendCodePoint(Chars, ReplacementCodePoint);
+					NumContinuationBytes = 0;
+				}
+
+				continue;
+			}
+
+			if (CurByte < 0x80)
+			{
+				AppendCodePoint(Chars, CurByte);
+			}
+			else if ((CurByte & 0xE0) == 0xC0)
+			{
+				CodePoint = CurByte & 0x1F;
+				NumContinuationBytes = 1;
+			}
+			else if ((CurByte & 0xF0) == 0xE0)
+			{
+				CodePoint = CurByte & 0x0F;
+				NumContinuationBytes = 2;
+			}
+			else if ((CurByte & 0xF8) == 0xF0)
+			{
+				CodePoint = CurByte & 0x07;
+				NumContinuationBytes = 3;
+			}
+			else
+			{
+				AppendCodePoint(Chars, ReplacementCodePoint);
+			}
+
+			i++;
+		}
+	}
+
+	if (NumContinuationBytes > 0)
+	{
+		AppendCodePoint(Chars, ReplacementCodePoint);
+	}
+
+	if (Chars.Num() > 0)
+	{
+		Chars.Add(TEXT('\0'));
+	}
+
+	return !Ar.IsError();
+}
+
+void FChatMessageCodec::WriteRecord(FArchive& Ar, const FChatRecord& InRecord)
+{
+	FChatRecord Record = InRecord;
+
+	Ar << Record.Tag;
+	Ar << Record.Sequence;
+
+	for (float& CurValue : Record.Values)
+	{
+		Ar << CurValue;
+	}
+}
+
+bool FChatMessageCodec::ReadRecord(FArchive& Ar, FChatRecord& OutRecord)
+{
+	Ar << OutRecord.Tag;
+	Ar << OutRecord.Sequence;
+
+	for (float& CurValue : OutRecord.Values)
+	{
+		Ar << CurValue;
+	}
+
+	return !Ar.IsError();
+}
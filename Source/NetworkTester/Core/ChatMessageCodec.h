@@ -0,0 +1,62 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+
+/** The wire format used for sending chat text */
+enum class EChatWireFormat : uint8
+{
+	/** FString serialization: int32 length, then ANSI or UTF-16 characters with a terminator */
+	Legacy,
+
+	/** Packed length, then UTF-8 bytes */
+	Compact
+};
+
+
+/** A fixed-layout binary record, for telemetry-style traffic on the chat channel */
+struct FChatRecord
+{
+	/** Application defined record type */
+	uint8 Tag = 0;
+
+	/** Sender defined sequence number */
+	uint32 Sequence = 0;
+
+	/** The record values */
+	float Values[4] = {};
+
+	/** The serialized size of every record, in bytes */
+	static constexpr int32 WireBytes = 1 + 4 + 4 * 4;
+};
+
+
+/**
+ * Encoding/decoding of the compact chat message format. Text is transcoded to/from UTF-8 through stack buffers, and
+ * decoded into a caller-owned string whose allocation is reused, so neither direction allocates in steady state.
+ * (Received text is only copied again when it is queued for the game thread, while the net thread is in use.)
+ */
+struct NETWORKTESTER_API FChatMessageCodec
+{
+	/** The largest UTF-8 payload accepted when decoding */
+	static constexpr uint32 MaxTextBytes = 64 * 1024;
+
+	/** Writes text as a packed UTF-8 byte count, followed by the UTF-8 bytes */
+	static void WriteText(FArchive& Ar, const FString& InText);
+
+	/**
+	 * Reads text written by WriteText
+	 *
+	 * @param Ar		The archive to read from (set to error on malformed input)
+	 * @param OutText	Receives the text (its allocation is reused)
+	 * @return			Whether or not the text was read successfully
+	 */
+	static bool ReadText(FArchive& Ar, FString& OutText);
+
+	static void WriteRecord(FArchive& Ar, const FChatRecord& InRecord);
+
+	static bool ReadRecord(FArchive& Ar, FChatRecord& OutRecord);
+};
@@ -11,33 +11,278 @@
 #include "GameFramework/Actor.h"
 #include "Net/DataChannel.h"
 #include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/DateTime.h"
+#include "Misc/Paths.h"
+#include "UObject/UObjectGlobals.h"
+#include "UObject/UObjectIterator.h"
 #include "MyActorChannel.h"
 #include "MyChatChannel.h"
 #include "MyPackageMap.h"
 #include "MyConnection.h"
+#include "MyNetDriver.h"
+#include "NetLoopbackTransport.h"
+#include "MinimalClientNetThread.h"
+#include "NetworkTesterTrace.h"
+#include "MinimalClientWorldPool.h"
 
 
 DEFINE_LOG_CATEGORY(LogNetworkTester);
 
+FMinimalClientCleanupSettings UMinimalClient::CleanupSettings;
+int32 UMinimalClient::NumUncollectedCleanups = 0;
+bool UMinimalClient::bSharedWorldMode = false;
+UWorld* UMinimalClient::SharedWorld = nullptr;
+int32 UMinimalClient::NumSharedWorldUsers = 0;
+FMinimalClientActorFilterSettings UMinimalClient::ActorFilterSettings;
+TSharedPtr<const FMinimalClientActorFilterClasses, ESPMode::ThreadSafe> UMinimalClient::ActorFilterClasses;
+FDelegateHandle UMinimalClient::ActorFilterGCHandle;
+bool UMinimalClient::bDefaultLoopbackTransport = false;
+float UMinimalClient::DefaultNetThreadRate = 0.f;
+
 
 UMinimalClient::UMinimalClient(const FObjectInitializer& ObjectInitializor)
 	: Super(ObjectInitializor)
+	, bDropOutgoingPackets(false)
+	, bLoopbackTransport(bDefaultLoopbackTransport)
 	, Timeout(5)
 	, UnitWorld(NULL)
 	, UnitNetDriver(NULL)
+	, bPooledWorld(false)
+	, bUsingSharedWorld(false)
+	, bConnected(false)
+	, bConnectFailed(false)
+	, ConnectStartTime(0.0)
+	, ConnectSeconds(0.0)
+	, LastTickSeconds(0.0)
+	, PingInterval(0.f)
+	, TimeSinceLastPing(0.f)
+	, NetThread(nullptr)
+	, NetThreadRate(0.f)
+	, bBatchSends(false)
+	, BatchWindowSeconds(0.f)
+	, BatchByteBudget(1000)
+	, PendingBatch(0, true)
+	, NumBatchedMessages(0)
+	, BatchStartTime(0.0)
+	, ChatWireFormat(EChatWireFormat::Legacy)
+	, PayloadWriter(0, true)
+	, CompressedPayload(0, true)
+	, NextBlobId(1)
+	, NetConditionProfile(TEXT("Off"))
+	, LiveSampleInterval(0.f)
+	, NextLiveSampleTime(0.0)
+{
+
+}
+
+void UMinimalClient::BeginDestroy()
 {
+	StopNetThread();
 
+	Super::BeginDestroy();
 }
 
 void UMinimalClient::Tick(float DeltaTime)
 {
+	NETTESTER_TRACE_SCOPE(UMinimalClient_Tick);
+
+	if (NetThread != nullptr)
+	{
+		FMinimalClientNetEvent CurEvent;
+
+		while (NetEvents.Dequeue(CurEvent))
+		{
+			HandleNetEvent(CurEvent);
+		}
+	}
+	else
+	{
+		TickNetDriver(DeltaTime);
+	}
+}
+
+void UMinimalClient::TickNetThread(float DeltaTime)
+{
+	NETTESTER_TRACE_SCOPE(UMinimalClient_TickNetThread);
+
+	FScopeLock ScopeLock(&NetTickLock);
+
+	FMinimalClientNetCommand CurCommand;
+
+	while (NetCommands.Dequeue(CurCommand))
+	{
+		ExecuteNetCommand(CurCommand);
+	}
+
+	TickNetDriver(DeltaTime);
+}
+
+void UMinimalClient::ExecuteNetCommand(const FMinimalClientNetCommand& InCommand)
+{
+	switch (InCommand.Type)
+	{
+	case FMinimalClientNetCommand::EType::SendText:
+		SendTextImmediate(InCommand.Text, InCommand.bReliable);
+		break;
+
+	case FMinimalClientNetCommand::EType::SendPing:
+		SendPingImmediate();
+		break;
+
+	case FMinimalClientNetCommand::EType::SendRecord:
+		SendRecordImmediate(InCommand.Record, InCommand.bReliable);
+		break;
+
+	case FMinimalClientNetCommand::EType::SendBlob:
+		if (UnitNetDriver)
+		{
+			int ChannelIndex = UnitNetDriver->ChannelDefinitionMap[NAME_Voice].StaticChannelIndex;
+			TArray<UMyChatChannel*> Channels;
+
+			for (UNetConnection* UnitConn : GetConnections())
+			{
+				UMyChatChannel* UnitChatChan = Cast<UMyChatChannel>(UnitConn->Channels[ChannelIndex]);
+
+				if (UnitChatChan != nullptr)
+				{
+					Channels.Add(UnitChatChan);
+				}
+			}
+
+			BlobSender.Start(InCommand.BlobId, InCommand.Blob.ToSharedRef(), Channels);
+		}
+		break;
+
+	case FMinimalClientNetCommand::EType::PauseBlob:
+		BlobSender.Pause(InCommand.BlobId);
+		break;
+
+	case FMinimalClientNetCommand::EType::ResumeBlob:
+		BlobSender.Resume(InCommand.BlobId);
+		break;
+
+	case FMinimalClientNetCommand::EType::CancelBlob:
+		BlobSender.Cancel(InCommand.BlobId);
+		break;
+	}
+}
+
+void UMinimalClient::TickNetDriver(float DeltaTime)
+{
+	if (UnitNetDriver && PingInterval > 0.f)
+	{
+		TimeSinceLastPing += DeltaTime;
+
+		if (TimeSinceLastPing >= PingInterval)
+		{
+			TimeSinceLastPing = 0.f;
+			SendPingImmediate();
+		}
+	}
+
+	if (UnitNetDriver && NumBatchedMessages > 0 && FPlatformTime::Seconds() - BatchStartTime >= BatchWindowSeconds)
+	{
+		FlushSendBatch();
+	}
+
 	if (UnitNetDriver)
 	{
-		UnitNetDriver->TickDispatch(DeltaTime);
-		UnitNetDriver->PostTickDispatch();
+		const FMinimalClientTickWork TickWork = TickScheduler.Advance(FPlatformTime::Seconds(), DeltaTime);
+		double DispatchSeconds = 0.0;
+		double FlushSeconds = 0.0;
+
+		if (TickWork.bDispatch)
+		{
+			const double DispatchStartTime = FPlatformTime::Seconds();
+
+			{
+				NETTESTER_TRACE_SCOPE(UMinimalClient_TickDispatch);
+				UnitNetDriver->TickDispatch(TickWork.DispatchDeltaTime);
+			}
+
+			{
+				NETTESTER_TRACE_SCOPE(UMinimalClient_PostTickDispatch);
+				UnitNetDriver->PostTickDispatch();
+			}
+
+			DispatchSeconds = FPlatformTime::Seconds() - DispatchStartTime;
+			TickScheduler.RecordDispatch(DispatchSeconds);
 
-		UnitNetDriver->TickFlush(DeltaTime);
-		UnitNetDriver->PostTickFlush();
+			// After acks have been processed, so flow control sees the freshest reliable buffer state
+			{
+				NETTESTER_TRACE_SCOPE(UMinimalClient_BlobSenderTick);
+				BlobSender.Tick();
+			}
+		}
+
+		if (TickWork.bFlush)
+		{
+			const double FlushStartTime = FPlatformTime::Seconds();
+
+			// Replicated in this flush, rather than waiting for the next one
+			ActorScenario.Tick(UnitNetDriver, FPlatformTime::Seconds());
+
+			{
+				NETTESTER_TRACE_SCOPE(UMinimalClient_TickFlush);
+				UnitNetDriver->TickFlush(TickWork.FlushDeltaTime);
+			}
+
+			{
+				NETTESTER_TRACE_SCOPE(UMinimalClient_PostTickFlush);
+				UnitNetDriver->PostTickFlush();
+			}
+
+			FlushSeconds = FPlatformTime::Seconds() - FlushStartTime;
+			TickScheduler.RecordFlush(FlushSeconds);
+		}
+
+		LastTickSeconds = DispatchSeconds + FlushSeconds;
+
+		StatsRecorder.Tick(UnitNetDriver, FPlatformTime::Seconds());
+
+		if (TickWork.bFlush)
+		{
+			FNetworkTesterTrace::UpdateConnectionCounters(UnitNetDriver);
+		}
+
+		if (LiveSampleInterval > 0.f && FPlatformTime::Seconds() >= NextLiveSampleTime)
+		{
+			const double CurTime = FPlatformTime::Seconds();
+			const int32 NumConnections = UnitNetDriver->ServerConnection ? 1 : UnitNetDriver->ClientConnections.Num();
+
+			NextLiveSampleTime = CurTime + LiveSampleInterval;
+			LiveSamplesScratch.SetNumUninitialized(NumConnections, false);
+
+			if (UnitNetDriver->ServerConnection)
+			{
+				FNetStatsRecorder::SampleConnection(UnitNetDriver->ServerConnection, CurTime, LiveSamplesScratch[0]);
+			}
+			else
+			{
+				for (int32 i = 0; i < NumConnections; i++)
+				{
+					FNetStatsRecorder::SampleConnection(UnitNetDriver->ClientConnections[i], CurTime, LiveSamplesScratch[i]);
+				}
+			}
+
+			FScopeLock ScopeLock(&LiveSamplesLock);
+
+			Swap(LiveSamples, LiveSamplesScratch);
+		}
+	}
+
+	// Detect connection failures which never reach NotifyControlMessage
+	if (UnitNetDriver && UnitNetDriver->ServerConnection && !bConnected && !bConnectFailed)
+	{
+		if (UnitNetDriver->ServerConnection->State == USOCK_Closed)
+		{
+			NotifyConnectFailure(ENetworkFailure::ConnectionLost, TEXT("Connection closed before the server answered hello."));
+		}
+		else if (FPlatformTime::Seconds() - ConnectStartTime > (double)Timeout)
+		{
+			NotifyConnectFailure(ENetworkFailure::ConnectionTimeout, TEXT("Timed out waiting for the server to answer hello."));
+		}
 	}
 }
 
@@ -50,25 +295,11 @@ bool UMinimalClient::Listen(const FString& InServerAddr, uint16 InPort)
 {
 	bool bSuccess = false;
 
-	UnitWorld = CreateWorld();
-	check(UnitWorld != NULL);
-
-	UnitNetDriver = CreateNetDriver();
-	check(UnitNetDriver != NULL);
-
-	if (!UnitNetDriver) {
+	if (!AcquireWorldAndNetDriver()) {
 		UE_LOG(LogNetworkTester, Warning, TEXT("Error to create an instance of the unit test net driver."));
 		return false;
 	}
 
-	// Hack: Replace the control and actor channels, with stripped down unit test channels
-	UnitNetDriver->ChannelDefinitionMap[NAME_Actor].ChannelClass = UMyActorChannel::StaticClass();
-	UnitNetDriver->ChannelDefinitionMap[NAME_Voice].ChannelClass = UMyChatChannel::StaticClass();
-	UnitNetDriver->ChannelDefinitionMap[NAME_Voice].bInitialServer = true;
-	UnitNetDriver->ChannelDefinitionMap[NAME_Voice].bServerOpen = true;
-	UnitNetDriver->ChannelDefinitionMap[NAME_Voice].bInitialClient = true;
-	UnitNetDriver->ChannelDefinitionMap[NAME_Voice].bClientOpen = true;
-
 	UnitNetDriver->InitialConnectTimeout = FMath::Max(UnitNetDriver->InitialConnectTimeout, (float)Timeout);
 	UnitNetDriver->ConnectionTimeout = FMath::Max(UnitNetDriver->ConnectionTimeout, (float)Timeout);
 
@@ -78,6 +309,12 @@ bool UMinimalClient::Listen(const FString& InServerAddr, uint16 InPort)
 	ServerURL.Port = InPort;
 
 	bSuccess = UnitNetDriver->InitListen(this, ServerURL, false, ListenError);
+
+	if (bSuccess && NetThread == nullptr && DefaultNetThreadRate > 0.f)
+	{
+		StartNetThread(DefaultNetThreadRate);
+	}
+
 	return bSuccess;
 }
 
@@ -85,27 +322,18 @@ bool UMinimalClient::Connect(const FString& InServerAddr, uint16 InPort)
 {
 	bool bSuccess = false;
 
-	UnitWorld = CreateWorld();
-	check(UnitWorld != NULL);
+	bConnected = false;
+	bConnectFailed = false;
+	ConnectSeconds = 0.0;
+	ConnectStartTime = FPlatformTime::Seconds();
 
-	UnitNetDriver = CreateNetDriver();
-	check(UnitNetDriver != NULL);
+	ActorFilter.SetSettings(ActorFilterSettings, ActorFilterClasses);
 
-	if (!UnitNetDriver) {
+	if (!AcquireWorldAndNetDriver()) {
 		UE_LOG(LogNetworkTester, Warning, TEXT("Error to create an instance of the unit test net driver."));
 		return false;
 	}
 
-	UnitNetDriver->SetWorld(UnitWorld);
-
-	// Hack: Replace the control and actor channels, with stripped down unit test channels
-	UnitNetDriver->ChannelDefinitionMap[NAME_Actor].ChannelClass = UMyActorChannel::StaticClass();
-	UnitNetDriver->ChannelDefinitionMap[NAME_Voice].ChannelClass = UMyChatChannel::StaticClass();
-	UnitNetDriver->ChannelDefinitionMap[NAME_Voice].bInitialServer = true;
-	UnitNetDriver->ChannelDefinitionMap[NAME_Voice].bServerOpen = true;
-	UnitNetDriver->ChannelDefinitionMap[NAME_Voice].bInitialClient = true;
-	UnitNetDriver->ChannelDefinitionMap[NAME_Voice].bClientOpen = true;
-
 	UnitNetDriver->InitialConnectTimeout = FMath::Max(UnitNetDriver->InitialConnectTimeout, (float)Timeout);
 	UnitNetDriver->ConnectionTimeout = FMath::Max(UnitNetDriver->ConnectionTimeout, (float)Timeout);
 
@@ -149,6 +377,17 @@ bool UMinimalClient::Connect(const FString& InServerAddr, uint16 InPort)
 
 		if (MyConnection) {
 			MyConnection->MinClient = this;
+			ApplyNetConditionProfile(MyConnection);
+
+			UMyNetDriver* MyNetDriver = Cast<UMyNetDriver>(UnitNetDriver);
+
+			// Wait for a loopback server to accept us, and link up with it
+			if (bLoopbackTransport && MyNetDriver != nullptr && MyNetDriver->GetLocalPort() != 0)
+			{
+				MyConnection->LoopbackEndpoint = MakeShared<FNetLoopbackEndpoint, ESPMode::ThreadSafe>();
+
+				FNetLoopbackTransport::RegisterClient(MyNetDriver->GetLocalPort(), InPort, MyConnection->LoopbackEndpoint);
+			}
 		}
 
 		check(UnitConn != nullptr);
@@ -182,8 +421,14 @@ bool UMinimalClient::Connect(const FString& InServerAddr, uint16 InPort)
 	{
 		UE_LOG(LogNetworkTester, Error, TEXT("Error to kickoff connect to IP '%s', error: %s"), *InServerAddr,
 			*ConnectionError);
+
+		NotifyConnectFailure(ENetworkFailure::PendingConnectionFailure, ConnectionError);
 	}
 
+	if (bSuccess && NetThread == nullptr && DefaultNetThreadRate > 0.f)
+	{
+		StartNetThread(DefaultNetThreadRate);
+	}
 
 	return bSuccess;
 }
@@ -216,6 +461,22 @@ void UMinimalClient::SendInitialJoin()
 
 void UMinimalClient::Cleanup()
 {
+	StopNetThread();
+	StopStatsRecording();
+
+	BlobSender.Reset();
+	ActorScenario.Reset();
+
+	{
+		FScopeLock ScopeLock(&ActorClassStatsLock);
+
+		ActorClassStats.Reset();
+	}
+
+	ResetPackageMapProfile();
+
+	const bool bHadAnything = UnitNetDriver != nullptr || UnitWorld != nullptr;
+
 	if (UnitNetDriver)
 	{
 		UnitNetDriver->SetWorld(NULL);
@@ -225,212 +486,2166 @@ void UMinimalClient::Cleanup()
 
 	if (UnitWorld)
 	{
-		CleanupWorld(UnitWorld);
+		if (bUsingSharedWorld)
+		{
+			// The shared world only goes away once shared world mode is off, and nobody is using it
+			NumSharedWorldUsers--;
+
+			if (!bSharedWorldMode && NumSharedWorldUsers == 0)
+			{
+				CleanupWorld(SharedWorld);
+				SharedWorld = nullptr;
+			}
+		}
+		else if (bPooledWorld)
+		{
+			UMinimalClientWorldPool::Get()->Return(UnitWorld);
+		}
+		else
+		{
+			CleanupWorld(UnitWorld);
+		}
+
 		UnitWorld = NULL;
+		bPooledWorld = false;
+		bUsingSharedWorld = false;
+	}
+
+	bConnected = false;
+
+	{
+		FScopeLock ScopeLock(&LiveSamplesLock);
+
+		LiveSamples.Reset();
 	}
 
-	// Immediately garbage collect remaining objects, to finish net driver cleanup
-	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS, true);
+	// The net driver is shut down (socket closed) and the world context is gone already, only their memory is left to reclaim
+	if (bHadAnything)
+	{
+		if (CleanupSettings.bImmediateGC)
+		{
+			CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS, true);
+		}
+		else if (++NumUncollectedCleanups >= CleanupSettings.GCBatchSize)
+		{
+			NumUncollectedCleanups = 0;
+			GEngine->ForceGarbageCollection(false);
+		}
+	}
 }
 
-void UMinimalClient::SendText(FString& InText)
+void UMinimalClient::SetCleanupSettings(const FMinimalClientCleanupSettings& InSettings)
 {
-	if (!UnitNetDriver)
+	CleanupSettings = InSettings;
+	CleanupSettings.GCBatchSize = FMath::Max(InSettings.GCBatchSize, 1);
+}
+
+void UMinimalClient::SetSharedWorldMode(bool bEnable)
+{
+	bSharedWorldMode = bEnable;
+
+	if (!bSharedWorldMode && NumSharedWorldUsers == 0 && IsValid(SharedWorld))
 	{
-		return;
+		CleanupWorld(SharedWorld);
+		SharedWorld = nullptr;
 	}
+}
 
-	int ChannelIndex = UnitNetDriver->ChannelDefinitionMap[NAME_Voice].StaticChannelIndex;
+void UMinimalClient::SetActorFilter(const FMinimalClientActorFilterSettings& InSettings)
+{
+	ActorFilterSettings = InSettings;
+	ActorFilterClasses = FMinimalClientActorFilterClasses::Build(ActorFilterSettings);
 
-	if (UnitNetDriver->ServerConnection)
+	for (TObjectIterator<UMinimalClient> It; It; ++It)
 	{
-		UNetConnection* UnitConn = UnitNetDriver->ServerConnection;
-		UMyChatChannel* UnitChatChan = CastChecked<UMyChatChannel>(UnitConn->Channels[ChannelIndex]);
-		FOutBunch OutBunch(UnitChatChan, false);
+		// The net thread consults the filter while ticking, so keep it from running while the filter is swapped
+		FScopeLock ScopeLock(&It->NetTickLock);
 
-		OutBunch.bReliable = 1;
-		OutBunch << InText;
-		UnitChatChan->SendBunch(&OutBunch, false);
+		It->ActorFilter.SetSettings(ActorFilterSettings, ActorFilterClasses);
 	}
-	else
-	{
-		for (auto UnitConn : UnitNetDriver->ClientConnections)
-		{
-			UMyChatChannel* UnitChatChan = CastChecked<UMyChatChannel>(UnitConn->Channels[ChannelIndex]);
-			FOutBunch OutBunch(UnitChatChan, false);
 
-			OutBunch.bReliable = 1;
-			OutBunch << InText;
-			UnitChatChan->SendBunch(&OutBunch, false);
+	const bool bActive = ActorFilterSettings.Mode != EMinimalClientActorFilterMode::Disabled;
 
-			UnitConn->FlushNet();
-		}
+	if (bActive && !ActorFilterGCHandle.IsValid())
+	{
+		ActorFilterGCHandle = FCoreUObjectDelegates::GetPostGarbageCollect().AddStatic(&UMinimalClient::PruneActorFilterClasses);
+	}
+	else if (!bActive && ActorFilterGCHandle.IsValid())
+	{
+		FCoreUObjectDelegates::GetPostGarbageCollect().Remove(ActorFilterGCHandle);
+		ActorFilterGCHandle.Reset();
 	}
 }
 
-void UMinimalClient::NotifyAcceptedConnection(UNetConnection* Connection)
+void UMinimalClient::PruneActorFilterClasses()
 {
-	UMyConnection* MyConnection = Cast<UMyConnection>(Connection);
-	if (MyConnection)
+	TSharedPtr<const FMinimalClientActorFilterClasses, ESPMode::ThreadSafe> PrunedClasses =
+		ActorFilterClasses.IsValid() ? ActorFilterClasses->Prune() : nullptr;
+
+	// Filters still holding the old shared classes may be in use on net threads, so a pruned copy replaces them in each filter
+	if (PrunedClasses.IsValid())
 	{
-		MyConnection->MinClient = this;
+		ActorFilterClasses = PrunedClasses;
+	}
+
+	for (TObjectIterator<UMinimalClient> It; It; ++It)
+	{
+		FScopeLock ScopeLock(&It->NetTickLock);
+
+		It->ActorFilter.PruneFreedClasses(ActorFilterClasses);
 	}
 }
 
-void UMinimalClient::ResetConnTimeout(float Duration)
+void UMinimalClient::SendText(FString& InText, bool bReliable)
 {
+	NETTESTER_TRACE_SCOPE(UMinimalClient_SendText);
+
+	if (NetThread != nullptr)
+	{
+		FMinimalClientNetCommand NewCommand;
+
+		NewCommand.Type = FMinimalClientNetCommand::EType::SendText;
+		NewCommand.Text = InText;
+		NewCommand.bReliable = bReliable;
 
+		NetCommands.Enqueue(MoveTemp(NewCommand));
+	}
+	else
+	{
+		SendTextImmediate(InText, bReliable);
+	}
 }
 
-UWorld* UMinimalClient::CreateWorld()
+void UMinimalClient::SendTextImmediate(const FString& InText, bool bReliable)
 {
-	UWorld* ReturnVal = NULL;
+	NETTESTER_TRACE_SCOPE(UMinimalClient_SendTextImmediate);
 
-	ReturnVal = UWorld::CreateWorld(EWorldType::None, false);
+	if (!UnitNetDriver)
+	{
+		return;
+	}
 
-	// Hack-mark the world as having begun play (when it has not)
-	ReturnVal->bBegunPlay = true;
+	// Batches are sent reliably, unreliable text goes out on its own so each message keeps its own sequence number
+	if (bBatchSends && bReliable)
+	{
+		QueueBatchedText(InText);
+	}
+	else if (UnitNetDriver->ServerConnection)
+	{
+		FBitWriter& Payload = ResetPayloadWriter();
 
-	// Hack-mark the world as having initialized actors (to allow RPC hooks)
-	ReturnVal->bActorsInitialized = true;
+		WriteTextMessage(Payload, InText);
 
-	// Create a blank world context, to prevent crashes
-	FWorldContext& CurContext = GEngine->CreateNewWorldContext(EWorldType::None);
-	CurContext.SetCurrentWorld(ReturnVal);
+		const int32 NumSent = SendPayload(Payload, bReliable, 0);
 
-	return ReturnVal;
+		SendBatchStats[0].NumMessages += NumSent;
+		SendBatchStats[0].NumBunches += NumSent;
+		SendBatchStats[0].PayloadBits += Payload.GetNumBits() * NumSent;
+	}
+	else
+	{
+		BroadcastText(InText, bReliable);
+	}
 }
 
-void UMinimalClient::CleanupWorld(UWorld* InWorld)
+int32 UMinimalClient::SendPayload(FBitWriter& Payload, bool bReliable, int32 SendBatchMode)
 {
-	// Iterate all ActorComponents in this world, and unmark them as having begun play - to prevent a crash during GC
-	for (TActorIterator<AActor> ActorIt(InWorld); ActorIt; ++ActorIt)
+	NETTESTER_TRACE_SCOPE(UMinimalClient_SendPayload);
+
+	int32 ReturnVal = 0;
+	int ChannelIndex = UnitNetDriver->ChannelDefinitionMap[NAME_Voice].StaticChannelIndex;
+
+	// Compressed once, however many connections it goes to
+	const bool bCompressed = FChatCompression::Compress(CompressionSettings, Payload, CompressedPayload, CompressionScratch,
+		CompressionStats);
+	const FBitWriter& WirePayload = bCompressed ? CompressedPayload : Payload;
+
+	for (UNetConnection* UnitConn : GetConnections())
 	{
-		for (UActorComponent* CurComp : ActorIt->GetComponents())
+		UMyChatChannel* UnitChatChan = Cast<UMyChatChannel>(UnitConn->Channels[ChannelIndex]);
+
+		if (UnitChatChan != nullptr)
 		{
-			if (CurComp->HasBegunPlay())
+			if (UnitChatChan->SendMessage(WirePayload, bReliable))
 			{
-				// Big hack - call only the parent class UActorComponent::EndPlay function, such that only bHasBegunPlay is unset
-				bool bBeginDestroyed = CurComp->HasAnyFlags(RF_BeginDestroyed);
+				ReturnVal++;
 
-				CurComp->SetFlags(RF_BeginDestroyed);
+				// The packet carrying this bunch is counted in the send batching stats, when the connection sends it
+				UMyConnection* MyConnection = Cast<UMyConnection>(UnitConn);
 
-				CurComp->UActorComponent::EndPlay(EEndPlayReason::Quit);
+				if (MyConnection != nullptr && SendBatchMode != INDEX_NONE)
+				{
+					MyConnection->PendingSendBatchMode = SendBatchMode;
+				}
 
-				if (!bBeginDestroyed)
+				if (bCompressed)
 				{
-					CurComp->ClearFlags(RF_BeginDestroyed);
+					UnitChatChan->CompressionStats.NumCompressed++;
+					UnitChatChan->CompressionStats.UncompressedBytes += Payload.GetNumBytes();
+					UnitChatChan->CompressionStats.CompressedBytes += WirePayload.GetNumBytes();
 				}
 			}
+			else
+			{
+				UE_LOG(LogNetworkTester, Warning, TEXT("SendPayload: payload of %lld bits does not fit in a bunch"),
+					WirePayload.GetNumBits());
+			}
+
+			// A server ticking every frame pushes sends out immediately - any other schedule leaves flushing to TickFlush,
+			// so that the tick rate under test also paces the server's packets
+			if (UnitNetDriver->ServerConnection == nullptr && TickScheduler.FlushesEveryTick())
+			{
+				UnitConn->FlushNet();
+			}
 		}
-	} // end for 
+	}
 
-	GEngine->DestroyWorldContext(InWorld);
-	InWorld->DestroyWorld(false);
-}
+	TRACE_COUNTER_ADD(NetTester_SentPayloads, ReturnVal);
+	TRACE_COUNTER_ADD(NetTester_SentPayloadBytes, (int64)WirePayload.GetNumBytes() * ReturnVal);
 
-static int UnitTestNetDriverCount = 0;
+	return ReturnVal;
+}
 
-UNetDriver* UMinimalClient::CreateNetDriver()
+void UMinimalClient::BroadcastText(const FString& InText, bool bReliable)
 {
-	UNetDriver* ReturnVal = NULL;
+	NETTESTER_TRACE_SCOPE(UMinimalClient_BroadcastText);
 
-	const FString DriverClassName = TEXT("/Script/OnlineSubsystemUtils.IpNetDriver");
-	UEngine* Engine = GEngine;
-	if (Engine != nullptr && UnitWorld != nullptr)
+	if (!UnitNetDriver || UnitNetDriver->ServerConnection || UnitNetDriver->ClientConnections.Num() == 0)
 	{
-		// Setup a new driver name entry
-		bool bFoundDef = false;
-		
-		int32 ClassLoc = DriverClassName.Find(TEXT("."));
-		FName UnitDefName = *(FString(TEXT("NetworkingTester_")) + DriverClassName.Mid(ClassLoc + 1));
+		return;
+	}
 
-		for (int32 i = 0; i < Engine->NetDriverDefinitions.Num(); i++)
-		{
-			if (Engine->NetDriverDefinitions[i].DefName == UnitDefName)
-			{
-				bFoundDef = true;
-				break;
-			}
-		} // end for i
+	// Serialize the payload once, and copy the bits into every connection's bunch
+	const uint64 SerializeStartCycles = FPlatformTime::Cycles64();
+	FBitWriter& Payload = ResetPayloadWriter();
 
-		if (!bFoundDef)
-		{
-			FNetDriverDefinition NewDriverEntry;
+	WriteTextMessage(Payload, InText);
 
-			NewDriverEntry.DefName = UnitDefName;
-			NewDriverEntry.DriverClassName = FName(*DriverClassName);
-			// Don't allow fallbacks for the MinimalClient
-			NewDriverEntry.DriverClassNameFallback = NewDriverEntry.DriverClassName;
+	const double SerializeSeconds = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - SerializeStartCycles);
+	const int32 NumSent = SendPayload(Payload, bReliable, 0);
+	const int32 NumAvoided = FMath::Max(NumSent - 1, 0);
 
-			Engine->NetDriverDefinitions.Add(NewDriverEntry);
-		}
+	BroadcastStats.NumBroadcasts++;
+	BroadcastStats.NumBunchesSent += NumSent;
+	BroadcastStats.SerializeSeconds += SerializeSeconds;
+	BroadcastStats.AvoidedSerializations += NumAvoided;
+	BroadcastStats.EstimatedSavedSeconds += SerializeSeconds * NumAvoided;
 
+	// Serializing ANSI text of this length is expected to go through a heap allocated conversion buffer, every time
+	if (ChatWireFormat == EChatWireFormat::Legacy && InText.Len() >= FBroadcastStats::ConversionInlineChars)
+	{
+		BroadcastStats.EstimatedAvoidedAllocations += NumAvoided;
+	}
 
-		FName NewDriverName = *FString::Printf(TEXT("NetworkingTester_NetDriver_%i"), UnitTestNetDriverCount++);
+	SendBatchStats[0].NumMessages += NumSent;
+	SendBatchStats[0].NumBunches += NumSent;
+	SendBatchStats[0].PayloadBits += Payload.GetNumBits() * NumSent;
+}
 
-		// Now create a reference to the driver
-		if (Engine->CreateNamedNetDriver(UnitWorld, NewDriverName, UnitDefName))
+void UMinimalClient::SetSendBatching(bool bEnable, float WindowSeconds, int32 ByteBudget)
+{
+	FScopeLock ScopeLock(&NetTickLock);
+
+	if (!bEnable)
+	{
+		FlushSendBatch();
+	}
+
+	// A batch is sent as one bunch, which has to fit the largest bunch every connection can send
+	const int32 MaxByteBudget = GetMaxSendBatchBytes();
+
+	if (ByteBudget > MaxByteBudget)
+	{
+		UE_LOG(LogNetworkTester, Warning, TEXT("SetSendBatching: byte budget %d does not fit in a bunch, clamped to %d"),
+			ByteBudget, MaxByteBudget);
+	}
+
+	bBatchSends = bEnable;
+	BatchWindowSeconds = FMath::Max(WindowSeconds, 0.f);
+	BatchByteBudget = FMath::Clamp(ByteBudget, 1, MaxByteBudget);
+}
+
+int32 UMinimalClient::GetMaxSendBatchBytes() const
+{
+	// Before connecting, assume a packet of the default size
+	int32 MaxBunchBits = MAX_PACKET_SIZE * 8 - MAX_BUNCH_HEADER_BITS - MAX_PACKET_TRAILER_BITS - MAX_PACKET_HEADER_BITS;
+
+	for (UNetConnection* UnitConn : GetConnections())
+	{
+		MaxBunchBits = FMath::Min(MaxBunchBits, UnitConn->GetMaxSingleBunchSizeBits());
+	}
+
+	// The batch header is the message type and a packed count
+	return FMath::Max(MaxBunchBits / 8 - FSendBatchStats::BatchHeaderBytes, 1);
+}
+
+void UMinimalClient::QueueBatchedText(const FString& InText)
+{
+	if (NumBatchedMessages == 0)
+	{
+		BatchStartTime = FPlatformTime::Seconds();
+	}
+
+	WriteTextBody(PendingBatch, InText);
+	NumBatchedMessages++;
+
+	if (PendingBatch.GetNumBytes() >= BatchByteBudget)
+	{
+		FlushSendBatch();
+	}
+}
+
+void UMinimalClient::FlushSendBatch()
+{
+	if (NumBatchedMessages == 0 || !UnitNetDriver)
+	{
+		return;
+	}
+
+	uint8 MessageType = (uint8)(ChatWireFormat == EChatWireFormat::Compact ? EChatMessageType::CompactBatch : EChatMessageType::Batch);
+	uint32 Count = NumBatchedMessages;
+	FBitWriter& Payload = ResetPayloadWriter();
+
+	Payload << MessageType;
+	Payload.SerializeIntPacked(Count);
+	Payload.SerializeBits(PendingBatch.GetData(), PendingBatch.GetNumBits());
+
+	const int32 NumSent = SendPayload(Payload, true, 1);
+
+	SendBatchStats[1].NumMessages += (uint64)NumBatchedMessages * NumSent;
+	SendBatchStats[1].NumBunches += NumSent;
+	SendBatchStats[1].PayloadBits += Payload.GetNumBits() * NumSent;
+
+	PendingBatch.Reset();
+	NumBatchedMessages = 0;
+}
+
+FBitWriter& UMinimalClient::ResetPayloadWriter()
+{
+	PayloadWriter.Reset();
+
+	return PayloadWriter;
+}
+
+void UMinimalClient::WriteTextMessage(FBitWriter& Ar, const FString& InText)
+{
+	uint8 MessageType = (uint8)(ChatWireFormat == EChatWireFormat::Compact ? EChatMessageType::CompactText : EChatMessageType::Text);
+
+	Ar << MessageType;
+
+	WriteTextBody(Ar, InText);
+}
+
+void UMinimalClient::WriteTextBody(FBitWriter& Ar, const FString& InText)
+{
+	const int64 StartBits = Ar.GetNumBits();
+
+	if (ChatWireFormat == EChatWireFormat::Compact)
+	{
+		FChatMessageCodec::WriteText(Ar, InText);
+	}
+	else
+	{
+		// Saving never modifies the string, so it is serialized in place rather than copied
+		Ar << const_cast<FString&>(InText);
+	}
+
+	// Measured off the writer, so only the format actually sent is sized
+	ChatWireStats.NumTextMessages[(int32)ChatWireFormat]++;
+	ChatWireStats.TextBytes[(int32)ChatWireFormat] += (uint64)(Ar.GetNumBits() - StartBits) / 8;
+}
+
+void UMinimalClient::SetChatWireFormat(EChatWireFormat InFormat)
+{
+	FScopeLock ScopeLock(&NetTickLock);
+
+	if (InFormat != ChatWireFormat)
+	{
+		// Batches hold a single format
+		FlushSendBatch();
+
+		ChatWireFormat = InFormat;
+	}
+}
+
+void UMinimalClient::SendRecord(const FChatRecord& InRecord, bool bReliable)
+{
+	if (NetThread != nullptr)
+	{
+		FMinimalClientNetCommand NewCommand;
+
+		NewCommand.Type = FMinimalClientNetCommand::EType::SendRecord;
+		NewCommand.Record = InRecord;
+		NewCommand.bReliable = bReliable;
+
+		NetCommands.Enqueue(MoveTemp(NewCommand));
+	}
+	else
+	{
+		SendRecordImmediate(InRecord, bReliable);
+	}
+}
+
+void UMinimalClient::SendRecordImmediate(const FChatRecord& InRecord, bool bReliable)
+{
+	if (!UnitNetDriver)
+	{
+		return;
+	}
+
+	uint8 MessageType = (uint8)EChatMessageType::Record;
+	FBitWriter& Payload = ResetPayloadWriter();
+
+	Payload << MessageType;
+	FChatMessageCodec::WriteRecord(Payload, InRecord);
+
+	SendPayload(Payload, bReliable);
+
+	ChatWireStats.NumRecords++;
+}
+
+void UMinimalClient::LogChatWireReport() const
+{
+	FScopeLock ScopeLock(&NetTickLock);
+
+	static const TCHAR* FormatNames[] = { TEXT("legacy"), TEXT("compact") };
+
+	// Compare the formats by sending the same traffic with each (NetTester.Protocol)
+	for (int32 i = 0; i < 2; i++)
+	{
+		if (ChatWireStats.NumTextMessages[i] > 0)
 		{
-			ReturnVal = Engine->FindNamedNetDriver(UnitWorld, NewDriverName);
+			UE_LOG(LogNetworkTester, Log, TEXT("Chat wire %s: %llu texts, %.1f bytes/msg"), FormatNames[i],
+				ChatWireStats.NumTextMessages[i], (double)ChatWireStats.TextBytes[i] / ChatWireStats.NumTextMessages[i]);
 		}
+	}
 
+	UE_LOG(LogNetworkTester, Log, TEXT("Chat wire: %llu records sent, %llu received, %d bytes/record"),
+		ChatWireStats.NumRecords, ChatWireStats.NumReceivedRecords, FChatRecord::WireBytes);
+}
 
-		if (ReturnVal != nullptr)
-		{
-			ReturnVal->SetWorld(UnitWorld);
-			UnitWorld->SetNetDriver(ReturnVal);
+void UMinimalClient::SetChatCompression(const FChatCompressionSettings& InSettings)
+{
+	// The net thread compresses while ticking, so keep it from running while the settings change
+	FScopeLock ScopeLock(&NetTickLock);
 
-			ReturnVal->InitConnectionClass();
-			ReturnVal->NetConnectionClass = UMyConnection::StaticClass();
+	CompressionSettings = InSettings;
+	CompressionSettings.bEnabled = InSettings.bEnabled && InSettings.Codec != NAME_None;
+	CompressionSettings.ThresholdBytes = FMath::Max(InSettings.ThresholdBytes, 0);
+}
 
-			FLevelCollection* Collection = (FLevelCollection*)UnitWorld->GetActiveLevelCollection();
+void UMinimalClient::LogCompressionReport() const
+{
+	FScopeLock ScopeLock(&NetTickLock);
 
-			// Hack-set the net driver in the worlds level collection
-			if (Collection != nullptr)
-			{
-				Collection->SetNetDriver(ReturnVal);
-			}
-			else
+	UE_LOG(LogNetworkTester, Log,
+		TEXT("Compression %s: %llu compressed, %llu below threshold, %llu incompressible, ratio %.3f, compress %.2f us/KB, %llu -> %llu bytes"),
+		CompressionSettings.bEnabled ? *CompressionSettings.Codec.ToString() : TEXT("off"), CompressionStats.NumCompressed,
+		CompressionStats.NumBelowThreshold, CompressionStats.NumIncompressible, CompressionStats.GetRatio(),
+		CompressionStats.GetCompressMicrosPerKB(), CompressionStats.UncompressedBytes, CompressionStats.CompressedBytes);
+
+	if (UnitNetDriver)
+	{
+		int ChannelIndex = UnitNetDriver->ChannelDefinitionMap[NAME_Voice].StaticChannelIndex;
+
+		for (UNetConnection* UnitConn : GetConnections())
+		{
+			UMyChatChannel* UnitChatChan = Cast<UMyChatChannel>(UnitConn->Channels[ChannelIndex]);
+
+			if (UnitChatChan != nullptr)
 			{
-				UE_LOG(LogNetworkTester, Warning, TEXT("CreateNetDriver: No LevelCollection found for created world, may block replication."));
-			}
+				const FChatCompressionStats& ChanStats = UnitChatChan->CompressionStats;
 
-			UE_LOG(LogNetworkTester, Warning, TEXT("CreateNetDriver: Created named net driver: %s, NetDriverName: %s, for World: %s"),
-				*ReturnVal->GetFullName(), *ReturnVal->NetDriverName.ToString(), *UnitWorld->GetFullName());
+				UE_LOG(LogNetworkTester, Log,
+					TEXT("Compression %s: sent %llu compressed, saved %lld bytes, received %llu compressed, decompress %.2f us/KB"),
+					*UnitConn->LowLevelGetRemoteAddress(true), ChanStats.NumCompressed,
+					(int64)ChanStats.UncompressedBytes - (int64)ChanStats.CompressedBytes, ChanStats.NumDecompressed,
+					ChanStats.GetDecompressMicrosPerKB());
+			}
 		}
-		else
+	}
+}
+
+uint32 UMinimalClient::SendBlob(TArray<uint8>&& Data)
+{
+	FMinimalClientNetCommand NewCommand;
+
+	NewCommand.Type = FMinimalClientNetCommand::EType::SendBlob;
+	NewCommand.BlobId = NextBlobId++;
+	NewCommand.Blob = MakeShared<const TArray<uint8>, ESPMode::ThreadSafe>(MoveTemp(Data));
+
+	const uint32 ReturnVal = NewCommand.BlobId;
+
+	if (NetThread != nullptr)
+	{
+		NetCommands.Enqueue(MoveTemp(NewCommand));
+	}
+	else
+	{
+		ExecuteNetCommand(NewCommand);
+	}
+
+	return ReturnVal;
+}
+
+void UMinimalClient::PauseBlob(uint32 BlobId)
+{
+	FMinimalClientNetCommand NewCommand;
+
+	NewCommand.Type = FMinimalClientNetCommand::EType::PauseBlob;
+	NewCommand.BlobId = BlobId;
+
+	if (NetThread != nullptr)
+	{
+		NetCommands.Enqueue(MoveTemp(NewCommand));
+	}
+	else
+	{
+		ExecuteNetCommand(NewCommand);
+	}
+}
+
+void UMinimalClient::ResumeBlob(uint32 BlobId)
+{
+	FMinimalClientNetCommand NewCommand;
+
+	NewCommand.Type = FMinimalClientNetCommand::EType::ResumeBlob;
+	NewCommand.BlobId = BlobId;
+
+	if (NetThread != nullptr)
+	{
+		NetCommands.Enqueue(MoveTemp(NewCommand));
+	}
+	else
+	{
+		ExecuteNetCommand(NewCommand);
+	}
+}
+
+void UMinimalClient::CancelBlob(uint32 BlobId)
+{
+	FMinimalClientNetCommand NewCommand;
+
+	NewCommand.Type = FMinimalClientNetCommand::EType::CancelBlob;
+	NewCommand.BlobId = BlobId;
+
+	if (NetThread != nullptr)
+	{
+		NetCommands.Enqueue(MoveTemp(NewCommand));
+	}
+	else
+	{
+		ExecuteNetCommand(NewCommand);
+	}
+}
+
+void UMinimalClient::SetBlobFlowSettings(const FBlobFlowSettings& InSettings)
+{
+	// The net thread reads the settings while pumping blobs
+	FScopeLock ScopeLock(&NetTickLock);
+
+	BlobSender.SetFlowSettings(InSettings);
+}
+
+void UMinimalClient::LogBlobReport() const
+{
+	FScopeLock ScopeLock(&NetTickLock);
+
+	BlobSender.LogReport();
+
+	if (UnitNetDriver)
+	{
+		int ChannelIndex = UnitNetDriver->ChannelDefinitionMap[NAME_Voice].StaticChannelIndex;
+
+		for (UNetConnection* UnitConn : GetConnections())
 		{
-			UE_LOG(LogNetworkTester, Warning, TEXT("CreateNetDriver: CreateNamedNetDriver failed"));
+			UMyChatChannel* UnitChatChan = Cast<UMyChatChannel>(UnitConn->Channels[ChannelIndex]);
+
+			if (UnitChatChan != nullptr && UnitChatChan->NumReceivedBlobs > 0)
+			{
+				UE_LOG(LogNetworkTester, Log, TEXT("Blobs from %s: %u received, %llu bytes, %.2f MB/s"),
+					*UnitConn->LowLevelGetRemoteAddress(true), UnitChatChan->NumReceivedBlobs, UnitChatChan->ReceivedBlobBytes,
+					UnitChatChan->ReceivedBlobSeconds > 0.0 ? UnitChatChan->ReceivedBlobBytes / (1024.0 * 1024.0) / UnitChatChan->ReceivedBlobSeconds : 0.0);
+			}
 		}
 	}
-	else if (Engine == nullptr)
+}
+
+void UMinimalClient::SetTickSchedule(const FMinimalClientTickSettings& InSettings)
+{
+	// The net thread reads the schedule every tick, so keep it from running while the settings change
+	FScopeLock ScopeLock(&NetTickLock);
+
+	TickScheduler.SetSettings(InSettings);
+}
+
+void UMinimalClient::StepTick()
+{
+	if (TickScheduler.GetSettings().Mode == EMinimalClientTickMode::Step)
 	{
-		UE_LOG(LogNetworkTester, Warning, TEXT("CreateNetDriver: Engine is nullptr"));
+		TickScheduler.RequestStep();
+	}
+}
+
+void UMinimalClient::LogTickReport() const
+{
+	FScopeLock ScopeLock(&NetTickLock);
+
+	UE_LOG(LogNetworkTester, Log, TEXT("%s tick: %s"), *GetName(), *TickScheduler.ToString());
+}
+
+int32 UMinimalClient::SpawnSyntheticActors(const FSyntheticActorGroupSettings& InSettings)
+{
+	// The net thread replicates the actors while ticking, so keep it from running while they are spawned
+	FScopeLock ScopeLock(&NetTickLock);
+
+	const int32 NumSpawned = ActorScenario.Spawn(UnitWorld, UnitNetDriver, InSettings);
+
+	return NumSpawned;
+}
+
+void UMinimalClient::ClearSyntheticActors()
+{
+	FScopeLock ScopeLock(&NetTickLock);
+
+	ActorScenario.Reset();
+}
+
+void UMinimalClient::NotifyActorBunch(FName ActorClassName, int64 NumBits, double Seconds, bool bOpened, bool bBlocked)
+{
+	const double CurTime = FPlatformTime::Seconds();
+	FScopeLock ScopeLock(&ActorClassStatsLock);
+	FActorClassNetStats& Stats = ActorClassStats.FindOrAdd(ActorClassName);
+
+	if (bBlocked)
+	{
+		Stats.BlockedBunches++;
+		Stats.BlockedBits += (uint64)NumBits;
+		Stats.BlockedSeconds += Seconds;
+
+		return;
 	}
-	else //if (UnitWorld == nullptr)
+
+	if (Stats.NumBunches == 0)
 	{
-		UE_LOG(LogNetworkTester, Warning, TEXT("CreateNetDriver: UnitWorld is nullptr"));
+		Stats.FirstTime = CurTime;
 	}
 
-	return ReturnVal;
+	Stats.NumBunches++;
+	Stats.Bits += (uint64)NumBits;
+	Stats.ReceiveSeconds += Seconds;
+	Stats.LastTime = CurTime;
+
+	if (bOpened)
+	{
+		Stats.NumOpened++;
+		Stats.OpenBits += (uint64)NumBits;
+		Stats.OpenSeconds += Seconds;
+	}
 }
 
-void UMinimalClient::CleanupNetDriver(UNetDriver* InDriver)
+void UMinimalClient::LogActorReport(float BudgetKBps) const
 {
-	if (UnitWorld != nullptr && InDriver != nullptr)
 	{
-		GEngine->DestroyNamedNetDriver(UnitWorld, InDriver->NetDriverName);
+		// The scenario's stats are written by whichever thread ticks the net driver
+		FScopeLock ScopeLock(&NetTickLock);
+
+		if (ActorScenario.GetNumActors() > 0)
+		{
+			ActorScenario.LogReport();
+		}
+	}
+
+	FScopeLock ScopeLock(&ActorClassStatsLock);
+
+	for (const TPair<FName, FActorClassNetStats>& CurPair : ActorClassStats)
+	{
+		const FActorClassNetStats& Stats = CurPair.Value;
+		const double Elapsed = FMath::Max(Stats.LastTime - Stats.FirstTime, 0.001);
+
+		// Classes which were only ever blocked are listed by LogActorFilterReport
+		if (Stats.NumBunches == 0)
+		{
+			continue;
+		}
+
+		// Steady state cost, excluding the bunches which opened the channels
+		const double SteadyBytesPerSecond = (Stats.Bits - Stats.OpenBits) / 8.0 / Elapsed;
+		const double BytesPerSecondPerActor = Stats.NumOpened > 0 ? SteadyBytesPerSecond / Stats.NumOpened : 0.0;
+		const double ActorsInBudget = BytesPerSecondPerActor > 0.0 ? BudgetKBps * 1024.0 / BytesPerSecondPerActor : 0.0;
+
+		UE_LOG(LogNetworkTester, Log, TEXT("Actors %s: %llu opened (%.1f bytes, %.3f ms avg open), %llu bunches, %.1f KB, ")
+			TEXT("%.3f ms receive total, steady %.1f bytes/s per actor -> %.0f actors per connection in %.0f KB/s"),
+			CurPair.Key.IsNone() ? TEXT("(no actor)") : *CurPair.Key.ToString(), Stats.NumOpened,
+			Stats.NumOpened > 0 ? Stats.OpenBits / 8.0 / Stats.NumOpened : 0.0,
+			Stats.NumOpened > 0 ? Stats.OpenSeconds * 1000.0 / Stats.NumOpened : 0.0, Stats.NumBunches, Stats.Bits / 8192.0,
+			Stats.ReceiveSeconds * 1000.0, BytesPerSecondPerActor, ActorsInBudget, BudgetKBps);
 	}
 }
 
-bool UMinimalClient::NotifyAcceptingChannel(UChannel* Channel)
+bool UMinimalClient::ShouldBlockActorSpawn(UClass* ActorClass)
 {
-	bool bAccepted = true;
+	bool bBlockActor = ActorFilter.ShouldBlock(ActorClass);
 
-	if (Channel->ChName == NAME_Actor)
+	RepActorSpawnDel.ExecuteIfBound(ActorClass, true, bBlockActor);
+
+	if (bBlockActor && ActorClass != nullptr)
 	{
+		FScopeLock ScopeLock(&ActorClassStatsLock);
+		FActorClassNetStats& Stats = ActorClassStats.FindOrAdd(ActorClass->GetFName());
+
+		if (Stats.NumBlocked == 0)
+		{
+			Stats.EstimatedActorBytes = FMinimalClientActorFilter::EstimateActorBytes(ActorClass);
+		}
+
+		Stats.NumBlocked++;
 	}
 
-	return bAccepted;
+	return bBlockActor;
 }
+
+FActorFilterSavings UMinimalClient::GetActorFilterSavings() const
+{
+	FActorFilterSavings ReturnVal;
+	FScopeLock ScopeLock(&ActorClassStatsLock);
+
+	// The average cost of the spawned actors, for estimating blocked classes which were never spawned
+	uint64 TotalOpened = 0;
+	uint64 TotalSteadyBunches = 0;
+	double TotalOpenSeconds = 0.0;
+	double TotalSteadySeconds = 0.0;
+
+	for (const TPair<FName, FActorClassNetStats>& CurPair : ActorClassStats)
+	{
+		TotalOpened += CurPair.Value.NumOpened;
+		TotalSteadyBunches += CurPair.Value.NumBunches - CurPair.Value.NumOpened;
+		TotalOpenSeconds += CurPair.Value.OpenSeconds;
+		TotalSteadySeconds += CurPair.Value.ReceiveSeconds - CurPair.Value.OpenSeconds;
+	}
+
+	for (const TPair<FName, FActorClassNetStats>& CurPair : ActorClassStats)
+	{
+		const FActorClassNetStats& Stats = CurPair.Value;
+
+		if (Stats.NumBlocked == 0)
+		{
+			continue;
+		}
+
+		const bool bSpawned = Stats.NumOpened > 0;
+		const uint64 NumOpened = bSpawned ? Stats.NumOpened : TotalOpened;
+		const uint64 NumSteadyBunches = bSpawned ? Stats.NumBunches - Stats.NumOpened : TotalSteadyBunches;
+		const double AvgOpenSeconds = NumOpened > 0 ? (bSpawned ? Stats.OpenSeconds : TotalOpenSeconds) / NumOpened : 0.0;
+		const double AvgSteadySeconds = NumSteadyBunches > 0 ?
+			(bSpawned ? Stats.ReceiveSeconds - Stats.OpenSeconds : TotalSteadySeconds) / NumSteadyBunches : 0.0;
+		const double WouldBeSeconds = Stats.NumBlocked * AvgOpenSeconds +
+			(Stats.BlockedBunches - FMath::Min(Stats.BlockedBunches, Stats.NumBlocked)) * AvgSteadySeconds;
+
+		ReturnVal.NumBlockedActors += Stats.NumBlocked;
+		ReturnVal.Bytes += Stats.NumBlocked * Stats.EstimatedActorBytes;
+		ReturnVal.Seconds += FMath::Max(WouldBeSeconds - Stats.BlockedSeconds, 0.0);
+	}
+
+	return ReturnVal;
+}
+
+void UMinimalClient::LogActorFilterReport() const
+{
+	const FActorFilterSavings Savings = GetActorFilterSavings();
+
+	UE_LOG(LogNetworkTester, Log, TEXT("%s ActorFilter %s: %llu actors blocked, est. saved %.1f KB memory, %.3f ms CPU"), *GetName(),
+		*ActorFilter.GetSettings().ToString(), Savings.NumBlockedActors, Savings.Bytes / 1024.0, Savings.Seconds * 1000.0);
+
+	FScopeLock ScopeLock(&ActorClassStatsLock);
+
+	for (const TPair<FName, FActorClassNetStats>& CurPair : ActorClassStats)
+	{
+		const FActorClassNetStats& Stats = CurPair.Value;
+
+		if (Stats.NumBlocked > 0)
+		{
+			UE_LOG(LogNetworkTester, Log, TEXT("    %-48s %8llu blocked (%llu bytes each), %llu bunches dropped, %.1f KB"),
+				*CurPair.Key.ToString(), Stats.NumBlocked, Stats.EstimatedActorBytes, Stats.BlockedBunches, Stats.BlockedBits / 8192.0);
+		}
+	}
+}
+
+void UMinimalClient::NotifyPackageMapSerialize(EPackageMapProfileCategory Category, FName Key, int64 NumBits, double Seconds,
+	bool bSaving)
+{
+	FScopeLock ScopeLock(&PackageMapProfilerLock);
+
+	PackageMapProfiler.Record(Category, Key, NumBits, Seconds, bSaving);
+}
+
+void UMinimalClient::LogPackageMapReport(int32 TopN, const FString& CsvFilename) const
+{
+	FScopeLock ScopeLock(&PackageMapProfilerLock);
+
+	PackageMapProfiler.LogTop(GetName(), TopN);
+
+	if (!CsvFilename.IsEmpty() && !PackageMapProfiler.ExportCsv(CsvFilename, GetName(), TopN))
+	{
+		UE_LOG(LogNetworkTester, Warning, TEXT("LogPackageMapReport: failed to write '%s'"), *CsvFilename);
+	}
+}
+
+void UMinimalClient::ResetPackageMapProfile()
+{
+	FScopeLock ScopeLock(&PackageMapProfilerLock);
+
+	PackageMapProfiler.Reset();
+}
+
+void UMinimalClient::LogUnreliableReport() const
+{
+	FScopeLock ScopeLock(&NetTickLock);
+
+	if (!UnitNetDriver)
+	{
+		return;
+	}
+
+	int ChannelIndex = UnitNetDriver->ChannelDefinitionMap[NAME_Voice].StaticChannelIndex;
+
+	for (UNetConnection* UnitConn : GetConnections())
+	{
+		UMyChatChannel* UnitChatChan = Cast<UMyChatChannel>(UnitConn->Channels[ChannelIndex]);
+
+		if (UnitChatChan != nullptr)
+		{
+			const FNetSequenceTracker& Sequences = UnitChatChan->UnreliableSequences;
+
+			const FString RemoteAddr = UnitConn->LowLevelGetRemoteAddress(true);
+
+			// Delivery of what we send is only known to the peer, so it shows up in the peer's 'in' line
+			UE_LOG(LogNetworkTester, Log, TEXT("Unreliable %s out: sent %u"), *RemoteAddr, UnitChatChan->NextUnreliableSequence);
+
+			UE_LOG(LogNetworkTester, Log,
+				TEXT("Unreliable %s in: received %llu of %llu sent (%.2f%% delivered), lost %llu, reordered %llu, duplicates %llu, too late %llu"),
+				*RemoteAddr, Sequences.NumReceived, Sequences.GetNumExpected(), Sequences.GetDeliveryPercent(), Sequences.NumLost,
+				Sequences.NumReordered, Sequences.NumDuplicates, Sequences.NumTooLate);
+
+			if (UnitChatChan->UnreliableLatency.GetCount() > 0)
+			{
+				UE_LOG(LogNetworkTester, Log, TEXT("Unreliable %s latency (same-machine clocks only): %s"),
+					*RemoteAddr, *UnitChatChan->UnreliableLatency.ToString());
+			}
+		}
+	}
+}
+
+void UMinimalClient::NotifySendBatchPacket(int32 SendBatchMode, int32 NumBytes)
+{
+	FSendBatchStats& CurStats = SendBatchStats[SendBatchMode];
+
+	CurStats.WireBytes += NumBytes;
+	CurStats.WirePackets++;
+}
+
+void UMinimalClient::LogSendBatchReport() const
+{
+	FScopeLock ScopeLock(&NetTickLock);
+
+	static const TCHAR* ModeNames[] = { TEXT("unbatched"), TEXT("batched") };
+
+	for (int32 i = 0; i < 2; i++)
+	{
+		const FSendBatchStats& CurStats = SendBatchStats[i];
+
+		if (CurStats.NumMessages > 0)
+		{
+			const double Messages = (double)CurStats.NumMessages;
+			const double OverheadBytes = FMath::Max((double)CurStats.WireBytes - CurStats.PayloadBits / 8.0, 0.0);
+
+			UE_LOG(LogNetworkTester, Log,
+				TEXT("Send %s: %llu messages, %.3f bunches/msg, %.3f packets/msg, %.1f payload bytes/msg, %.1f overhead bytes/msg"),
+				ModeNames[i], CurStats.NumMessages, CurStats.NumBunches / Messages, CurStats.WirePackets / Messages,
+				CurStats.PayloadBits / 8.0 / Messages, OverheadBytes / Messages);
+		}
+	}
+}
+
+void UMinimalClient::LogBroadcastReport() const
+{
+	FScopeLock ScopeLock(&NetTickLock);
+
+	UE_LOG(LogNetworkTester, Log, TEXT("Broadcast: %llu broadcasts, %llu bunches, serialize %.3f ms total"),
+		BroadcastStats.NumBroadcasts, BroadcastStats.NumBunchesSent, BroadcastStats.SerializeSeconds * 1000.0);
+
+	UE_LOG(LogNetworkTester, Log,
+		TEXT("Broadcast: saved %llu serializations, ~%.3f ms, ~%llu allocations (estimated, from text >= %d chars)"),
+		BroadcastStats.AvoidedSerializations, BroadcastStats.EstimatedSavedSeconds * 1000.0,
+		BroadcastStats.EstimatedAvoidedAllocations, FBroadcastStats::ConversionInlineChars);
+}
+
+void UMinimalClient::SendPing()
+{
+	if (NetThread != nullptr)
+	{
+		NetCommands.Enqueue({FMinimalClientNetCommand::EType::SendPing, FString()});
+	}
+	else
+	{
+		SendPingImmediate();
+	}
+}
+
+void UMinimalClient::SendPingImmediate()
+{
+	if (!UnitNetDriver)
+	{
+		return;
+	}
+
+	int ChannelIndex = UnitNetDriver->ChannelDefinitionMap[NAME_Voice].StaticChannelIndex;
+
+	for (UNetConnection* UnitConn : GetConnections())
+	{
+		UMyChatChannel* UnitChatChan = Cast<UMyChatChannel>(UnitConn->Channels[ChannelIndex]);
+
+		if (UnitChatChan != nullptr)
+		{
+			UnitChatChan->SendPing();
+			UnitConn->FlushNet();
+		}
+	}
+}
+
+FNetLatencyHistogram UMinimalClient::GetAggregateRttHistogram() const
+{
+	FScopeLock ScopeLock(&NetTickLock);
+
+	FNetLatencyHistogram ReturnVal;
+
+	if (UnitNetDriver)
+	{
+		int ChannelIndex = UnitNetDriver->ChannelDefinitionMap[NAME_Voice].StaticChannelIndex;
+
+		for (UNetConnection* UnitConn : GetConnections())
+		{
+			UMyChatChannel* UnitChatChan = Cast<UMyChatChannel>(UnitConn->Channels[ChannelIndex]);
+
+			if (UnitChatChan != nullptr)
+			{
+				ReturnVal.Merge(UnitChatChan->RttHistogram);
+			}
+		}
+	}
+
+	return ReturnVal;
+}
+
+void UMinimalClient::LogLatencyReport() const
+{
+	FScopeLock ScopeLock(&NetTickLock);
+
+	if (!UnitNetDriver)
+	{
+		return;
+	}
+
+	int ChannelIndex = UnitNetDriver->ChannelDefinitionMap[NAME_Voice].StaticChannelIndex;
+
+	for (UNetConnection* UnitConn : GetConnections())
+	{
+		UMyChatChannel* UnitChatChan = Cast<UMyChatChannel>(UnitConn->Channels[ChannelIndex]);
+
+		if (UnitChatChan != nullptr)
+		{
+			UE_LOG(LogNetworkTester, Log, TEXT("RTT %s: %s"), *UnitConn->LowLevelGetRemoteAddress(true),
+				*UnitChatChan->RttHistogram.ToString());
+		}
+	}
+
+	UE_LOG(LogNetworkTester, Log, TEXT("RTT aggregate: %s"), *GetAggregateRttHistogram().ToString());
+}
+
+TArray<UNetConnection*> UMinimalClient::GetConnections() const
+{
+	FScopeLock ScopeLock(&NetTickLock);
+
+	TArray<UNetConnection*> ReturnVal;
+
+	if (UnitNetDriver)
+	{
+		if (UnitNetDriver->ServerConnection)
+		{
+			ReturnVal.Add(UnitNetDriver->ServerConnection);
+		}
+		else
+		{
+			ReturnVal.Append(UnitNetDriver->ClientConnections);
+		}
+	}
+
+	return ReturnVal;
+}
+
+void UMinimalClient::NotifyAcceptedConnection(UNetConnection* Connection)
+{
+	UMyConnection* MyConnection = Cast<UMyConnection>(Connection);
+	if (MyConnection)
+	{
+		MyConnection->MinClient = this;
+		ApplyNetConditionProfile(MyConnection);
+	}
+
+	// Client connections are created with the default package map, swap in ours (nothing has been exported yet)
+	if (Connection->PackageMap != nullptr && !Connection->PackageMap->IsA<UMyPackageMapClient>())
+	{
+		UMyPackageMapClient* PackageMap = NewObject<UMyPackageMapClient>(Connection);
+
+		PackageMap->Initialize(Connection, Connection->Driver->GuidCache);
+		PackageMap->MinClient = this;
+
+		Connection->PackageMap = PackageMap;
+	}
+
+	UMyNetDriver* MyNetDriver = Cast<UMyNetDriver>(Connection->Driver);
+
+	if (bLoopbackTransport && MyConnection != nullptr && MyNetDriver != nullptr && Connection->RemoteAddr.IsValid())
+	{
+		TSharedPtr<FNetLoopbackEndpoint, ESPMode::ThreadSafe> ClientEndpoint =
+			FNetLoopbackTransport::ClaimClient(Connection->RemoteAddr->GetPort(), MyNetDriver->GetLocalPort());
+
+		if (ClientEndpoint.IsValid())
+		{
+			MyConnection->LoopbackEndpoint = MakeShared<FNetLoopbackEndpoint, ESPMode::ThreadSafe>();
+
+			FNetLoopbackEndpoint::Link(MyConnection->LoopbackEndpoint, ClientEndpoint);
+
+			UE_LOG(LogNetworkTester, Log, TEXT("%s: linked %s through the loopback transport"), *GetName(),
+				*Connection->RemoteAddr->ToString(true));
+		}
+	}
+}
+
+bool UMinimalClient::SetNetConditionProfile(FName ProfileName)
+{
+	const FNetConditionProfile* Profile = FNetConditionSimulator::FindProfile(ProfileName);
+
+	if (Profile != nullptr)
+	{
+		// The net thread applies the profile to accepted connections, and runs the simulators
+		FScopeLock ScopeLock(&NetTickLock);
+
+		NetConditionProfile = ProfileName;
+
+		for (UNetConnection* UnitConn : GetConnections())
+		{
+			ApplyNetConditionProfile(Cast<UMyConnection>(UnitConn));
+		}
+	}
+	else
+	{
+		UE_LOG(LogNetworkTester, Warning, TEXT("SetNetConditionProfile: unknown profile '%s'"), *ProfileName.ToString());
+	}
+
+	return Profile != nullptr;
+}
+
+void UMinimalClient::ApplyNetConditionProfile(UMyConnection* Connection)
+{
+	const FNetConditionProfile* Profile = FNetConditionSimulator::FindProfile(NetConditionProfile);
+
+	if (Connection != nullptr && Profile != nullptr)
+	{
+		Connection->SetNetConditionProfile(*Profile);
+	}
+}
+
+bool UMinimalClient::StartStatsRecording(const FString& Filename, ENetStatsFormat Format, float IntervalSeconds)
+{
+	// The net thread samples while ticking, so keep it from running while the recorder is reset
+	FScopeLock ScopeLock(&NetTickLock);
+
+	const bool bSuccess = StatsRecorder.Start(Filename, Format, IntervalSeconds, GetConnections().Num());
+
+	return bSuccess;
+}
+
+void UMinimalClient::CopyLiveSamples(TArray<FNetConnectionSample>& OutSamples) const
+{
+	FScopeLock ScopeLock(&LiveSamplesLock);
+
+	OutSamples = LiveSamples;
+}
+
+void UMinimalClient::StopStatsRecording()
+{
+	FScopeLock ScopeLock(&NetTickLock);
+
+	StatsRecorder.Stop();
+}
+
+void UMinimalClient::LogNetConditionReport() const
+{
+	FScopeLock ScopeLock(&NetTickLock);
+
+	for (UNetConnection* UnitConn : GetConnections())
+	{
+		UMyConnection* MyConnection = Cast<UMyConnection>(UnitConn);
+
+		if (MyConnection != nullptr)
+		{
+			const FNetConditionSimulator::FStats& OutStats = MyConnection->OutgoingSimulator.GetStats();
+			const FNetConditionSimulator::FStats& InStats = MyConnection->IncomingSimulator.GetStats();
+
+			UE_LOG(LogNetworkTester, Log,
+				TEXT("NetSim %s [%s]: out %llu pkts (%llu dropped, %llu dup, %llu reordered), in %llu pkts (%llu dropped, %llu dup, %llu reordered), lost out/in %i/%i, avg lag %.1f ms"),
+				*UnitConn->LowLevelGetRemoteAddress(true), *NetConditionProfile.ToString(),
+				OutStats.NumPackets, OutStats.NumDropped, OutStats.NumDuplicated, OutStats.NumReordered,
+				InStats.NumPackets, InStats.NumDropped, InStats.NumDuplicated, InStats.NumReordered,
+				UnitConn->OutTotalPacketsLost, UnitConn->InTotalPacketsLost, UnitConn->AvgLag * 1000.f);
+		}
+	}
+}
+
+void UMinimalClient::LogLoopbackReport() const
+{
+	FScopeLock ScopeLock(&NetTickLock);
+
+	for (UNetConnection* UnitConn : GetConnections())
+	{
+		UMyConnection* MyConnection = Cast<UMyConnection>(UnitConn);
+
+		if (MyConnection != nullptr && MyConnection->LoopbackEndpoint.IsValid())
+		{
+			const FNetLoopbackEndpoint& Endpoint = *MyConnection->LoopbackEndpoint;
+
+			UE_LOG(LogNetworkTester, Log, TEXT("Loopback %s: %s, sent %llu pkts, received %llu pkts"),
+				*UnitConn->LowLevelGetRemoteAddress(true), Endpoint.IsLinked() ? TEXT("linked") : TEXT("waiting for the server"),
+				Endpoint.GetNumSent(), Endpoint.GetNumReceived());
+		}
+	}
+}
+
+void UMinimalClient::NotifyControlMessage(UNetConnection* Connection, uint8 MessageType, FInBunch& Bunch)
+{
+	if (UnitNetDriver == nullptr)
+	{
+		return;
+	}
+
+	if (Connection != UnitNetDriver->ServerConnection)
+	{
+		// Server side: answer the hello, so that clients can measure how long the handshake took
+		if (MessageType == NMT_Hello)
+		{
+			uint8 IsLittleEndian = 0;
+			uint32 RemoteNetworkVersion = 0;
+			FString EncryptionToken;
+
+			if (FNetControlMessage<NMT_Hello>::Receive(Bunch, IsLittleEndian, RemoteNetworkVersion, EncryptionToken))
+			{
+				Connection->Challenge = FString::Printf(TEXT("%08X"), FPlatformTime::Cycles());
+				FNetControlMessage<NMT_Challenge>::Send(Connection, Connection->Challenge);
+				Connection->FlushNet();
+			}
+		}
+	}
+	else if (MessageType == NMT_Challenge)
+	{
+		if (!bConnected && !bConnectFailed)
+		{
+			bConnected = true;
+			ConnectSeconds = FPlatformTime::Seconds() - ConnectStartTime;
+
+			UE_LOG(LogNetworkTester, Log, TEXT("Server answered hello after %.3f ms"), ConnectSeconds * 1000.0);
+
+			DispatchNetEvent({FMinimalClientNetEvent::EType::Connected, FString(), Connection});
+		}
+	}
+	else if (MessageType == NMT_Failure)
+	{
+		FString ErrorMsg;
+
+		FNetControlMessage<NMT_Failure>::Receive(Bunch, ErrorMsg);
+		NotifyConnectFailure(ENetworkFailure::FailureReceived, ErrorMsg);
+	}
+}
+
+void UMinimalClient::NotifyConnectFailure(ENetworkFailure::Type FailureType, const FString& ErrorString)
+{
+	if (!bConnectFailed)
+	{
+		bConnectFailed = true;
+
+		UE_LOG(LogNetworkTester, Warning, TEXT("Minimal client connection failure: %s (%s)"),
+			ENetworkFailure::ToString(FailureType), *ErrorString);
+
+		DispatchNetEvent({FMinimalClientNetEvent::EType::NetworkFailure, ErrorString, nullptr, FailureType});
+	}
+}
+
+void UMinimalClient::NotifyReceivedText(const FString& InText, UNetConnection* Connection)
+{
+	// The decoded text is only copied when it has to be queued for the game thread
+	if (NetThread != nullptr)
+	{
+		NetEvents.Enqueue({FMinimalClientNetEvent::EType::ReceivedText, InText, Connection});
+	}
+	else
+	{
+		ReceiveMessageDel.Broadcast(InText, Connection);
+	}
+}
+
+void UMinimalClient::NotifyReceivedRecord(const FChatRecord& InRecord, UNetConnection* Connection)
+{
+	FMinimalClientNetEvent NewEvent;
+
+	NewEvent.Type = FMinimalClientNetEvent::EType::ReceivedRecord;
+	NewEvent.Connection = Connection;
+	NewEvent.Record = InRecord;
+
+	ChatWireStats.NumReceivedRecords++;
+
+	DispatchNetEvent(MoveTemp(NewEvent));
+}
+
+void UMinimalClient::NotifyReceivedBlob(uint32 BlobId, TArray<uint8>&& Data, UNetConnection* Connection)
+{
+	FMinimalClientNetEvent NewEvent;
+
+	NewEvent.Type = FMinimalClientNetEvent::EType::ReceivedBlob;
+	NewEvent.Connection = Connection;
+	NewEvent.BlobId = BlobId;
+	NewEvent.Blob = MakeShared<const TArray<uint8>, ESPMode::ThreadSafe>(MoveTemp(Data));
+
+	DispatchNetEvent(MoveTemp(NewEvent));
+}
+
+void UMinimalClient::DispatchNetEvent(FMinimalClientNetEvent&& InEvent)
+{
+	if (NetThread != nullptr)
+	{
+		NetEvents.Enqueue(MoveTemp(InEvent));
+	}
+	else
+	{
+		HandleNetEvent(InEvent);
+	}
+}
+
+void UMinimalClient::HandleNetEvent(const FMinimalClientNetEvent& InEvent)
+{
+	switch (InEvent.Type)
+	{
+	case FMinimalClientNetEvent::EType::ReceivedText:
+		ReceiveMessageDel.Broadcast(InEvent.Text, InEvent.Connection);
+		break;
+
+	case FMinimalClientNetEvent::EType::ReceivedRecord:
+		ReceiveRecordDel.Broadcast(InEvent.Record, InEvent.Connection);
+		break;
+
+	case FMinimalClientNetEvent::EType::ReceivedBlob:
+		ReceiveBlobDel.Broadcast(InEvent.BlobId, *InEvent.Blob, InEvent.Connection);
+		break;
+
+	case FMinimalClientNetEvent::EType::Connected:
+		ConnectedDel.ExecuteIfBound();
+		break;
+
+	case FMinimalClientNetEvent::EType::NetworkFailure:
+		NetworkFailureDel.ExecuteIfBound(InEvent.FailureType, InEvent.Text);
+		break;
+	}
+}
+
+void UMinimalClient::StartNetThread(float TickRate)
+{
+	StopNetThread();
+
+	if (TickRate > 0.f)
+	{
+		NetThreadRate = TickRate;
+		NetThread = new FMinimalClientNetThread(this, TickRate);
+	}
+}
+
+void UMinimalClient::StopNetThread()
+{
+	if (NetThread != nullptr)
+	{
+		delete NetThread;
+		NetThread = nullptr;
+
+		// Hand over anything the net thread left behind
+		FMinimalClientNetCommand CurCommand;
+
+		while (NetCommands.Dequeue(CurCommand))
+		{
+			ExecuteNetCommand(CurCommand);
+		}
+
+		FMinimalClientNetEvent CurEvent;
+
+		while (NetEvents.Dequeue(CurEvent))
+		{
+			HandleNetEvent(CurEvent);
+		}
+	}
+}
+
+void UMinimalClient::ResetConnTimeout(float Duration)
+{
+
+}
+
+UWorld* UMinimalClient::CreateWorld()
+{
+	UWorld* ReturnVal = NULL;
+
+	ReturnVal = UWorld::CreateWorld(EWorldType::None, false);
+
+	// Hack-mark the world as having begun play (when it has not)
+	ReturnVal->bBegunPlay = true;
+
+	// Hack-mark the world as having initialized actors (to allow RPC hooks)
+	ReturnVal->bActorsInitialized = true;
+
+	// Create a blank world context, to prevent crashes
+	FWorldContext& CurContext = GEngine->CreateNewWorldContext(EWorldType::None);
+	CurContext.SetCurrentWorld(ReturnVal);
+
+	return ReturnVal;
+}
+
+void UMinimalClient::CleanupWorld(UWorld* InWorld)
+{
+	// Iterate all ActorComponents in this world, and unmark them as having begun play - to prevent a crash during GC
+	for (TActorIterator<AActor> ActorIt(InWorld); ActorIt; ++ActorIt)
+	{
+		for (UActorComponent* CurComp : ActorIt->GetComponents())
+		{
+			if (CurComp->HasBegunPlay())
+			{
+				// Big hack - call only the parent class UActorComponent::EndPlay function, such that only bHasBegunPlay is unset
+				bool bBeginDestroyed = CurComp->HasAnyFlags(RF_BeginDestroyed);
+
+				CurComp->SetFlags(RF_BeginDestroyed);
+
+				CurComp->UActorComponent::EndPlay(EEndPlayReason::Quit);
+
+				if (!bBeginDestroyed)
+				{
+					CurComp->ClearFlags(RF_BeginDestroyed);
+				}
+			}
+		}
+	} // end for 
+
+	GEngine->DestroyWorldContext(InWorld);
+	InWorld->DestroyWorld(false);
+}
+
+static int UnitTestNetDriverCount = 0;
+
+bool UMinimalClient::AcquireWorldAndNetDriver()
+{
+	UMinimalClientWorldPool* Pool = UMinimalClientWorldPool::IsEnabled() ? UMinimalClientWorldPool::Get() : nullptr;
+
+	bPooledWorld = false;
+	bUsingSharedWorld = bSharedWorldMode;
+
+	if (bUsingSharedWorld)
+	{
+		if (!IsValid(SharedWorld))
+		{
+			SharedWorld = CreateWorld();
+			check(SharedWorld != NULL);
+		}
+
+		NumSharedWorldUsers++;
+
+		UnitWorld = SharedWorld;
+		UnitNetDriver = CreateNetDriver(UnitWorld, false);
+	}
+	else if (Pool != nullptr && Pool->Checkout(UnitWorld, UnitNetDriver))
+	{
+		bPooledWorld = true;
+	}
+	else
+	{
+		UnitWorld = CreateWorld();
+		check(UnitWorld != NULL);
+
+		UnitNetDriver = CreateNetDriver(UnitWorld);
+	}
+
+	return UnitNetDriver != nullptr;
+}
+
+UNetDriver* UMinimalClient::CreateNetDriver(UWorld* InWorld, bool bWorldNetDriver)
+{
+	UNetDriver* ReturnVal = NULL;
+
+	// An IpNetDriver, which can also bypass its socket through the loopback transport
+	const FString DriverClassName = UMyNetDriver::StaticClass()->GetPathName();
+	UEngine* Engine = GEngine;
+	if (Engine != nullptr && InWorld != nullptr)
+	{
+		// Setup a new driver name entry
+		bool bFoundDef = false;
+		
+		int32 ClassLoc = DriverClassName.Find(TEXT("."));
+		FName UnitDefName = *(FString(TEXT("NetworkingTester_")) + DriverClassName.Mid(ClassLoc + 1));
+
+		for (int32 i = 0; i < Engine->NetDriverDefinitions.Num(); i++)
+		{
+			if (Engine->NetDriverDefinitions[i].DefName == UnitDefName)
+			{
+				bFoundDef = true;
+				break;
+			}
+		} // end for i
+
+		if (!bFoundDef)
+		{
+			FNetDriverDefinition NewDriverEntry;
+
+			NewDriverEntry.DefName = UnitDefName;
+			NewDriverEntry.DriverClassName = FName(*DriverClassName);
+			// Don't allow fallbacks for the MinimalClient
+			NewDriverEntry.DriverClassNameFallback = NewDriverEntry.DriverClassName;
+
+			Engine->NetDriverDefinitions.Add(NewDriverEntry);
+		}
+
+
+		FName NewDriverName = *FString::Printf(TEXT("NetworkingTester_NetDriver_%i"), UnitTestNetDriverCount++);
+
+		// Now create a reference to the driver
+		if (Engine->CreateNamedNetDriver(InWorld, NewDriverName, UnitDefName))
+		{
+			ReturnVal = Engine->FindNamedNetDriver(InWorld, NewDriverName);
+		}
+
+
+		if (ReturnVal != nullptr)
+		{
+			ReturnVal->SetWorld(InWorld);
+
+			ReturnVal->InitConnectionClass();
+			ReturnVal->NetConnectionClass = UMyConnection::StaticClass();
+
+			// Hack: Replace the control and actor channels, with stripped down unit test channels
+			ReturnVal->ChannelDefinitionMap[NAME_Actor].ChannelClass = UMyActorChannel::StaticClass();
+			ReturnVal->ChannelDefinitionMap[NAME_Voice].ChannelClass = UMyChatChannel::StaticClass();
+			ReturnVal->ChannelDefinitionMap[NAME_Voice].bInitialServer = true;
+			ReturnVal->ChannelDefinitionMap[NAME_Voice].bServerOpen = true;
+			ReturnVal->ChannelDefinitionMap[NAME_Voice].bInitialClient = true;
+			ReturnVal->ChannelDefinitionMap[NAME_Voice].bClientOpen = true;
+
+			// A shared world is used by many net drivers, none of which is its own
+			if (bWorldNetDriver)
+			{
+				InWorld->SetNetDriver(ReturnVal);
+
+				FLevelCollection* Collection = (FLevelCollection*)InWorld->GetActiveLevelCollection();
+
+				// Hack-set the net driver in the worlds level collection
+				if (Collection != nullptr)
+				{
+					Collection->SetNetDriver(ReturnVal);
+				}
+				else
+				{
+					UE_LOG(LogNetworkTester, Warning, TEXT("CreateNetDriver: No LevelCollection found for created world, may block replication."));
+				}
+			}
+
+			UE_LOG(LogNetworkTester, Warning, TEXT("CreateNetDriver: Created named net driver: %s, NetDriverName: %s, for World: %s"),
+				*ReturnVal->GetFullName(), *ReturnVal->NetDriverName.ToString(), *InWorld->GetFullName());
+		}
+		else
+		{
+			UE_LOG(LogNetworkTester, Warning, TEXT("CreateNetDriver: CreateNamedNetDriver failed"));
+		}
+	}
+	else if (Engine == nullptr)
+	{
+		UE_LOG(LogNetworkTester, Warning, TEXT("CreateNetDriver: Engine is nullptr"));
+	}
+	else //if (InWorld == nullptr)
+	{
+		UE_LOG(LogNetworkTester, Warning, TEXT("CreateNetDriver: InWorld is nullptr"));
+	}
+
+	return ReturnVal;
+}
+
+void UMinimalClient::CleanupNetDriver(UNetDriver* InDriver)
+{
+	if (UnitWorld != nullptr && InDriver != nullptr)
+	{
+		GEngine->DestroyNamedNetDriver(UnitWorld, InDriver->NetDriverName);
+	}
+}
+
+bool UMinimalClient::NotifyAcceptingChannel(UChannel* Channel)
+{
+	bool bAccepted = true;
+
+	if (Channel->ChName == NAME_Actor)
+	{
+		UMyActorChannel* ActorChannel = Cast<UMyActorChannel>(Channel);
+
+		if (ActorChannel != nullptr)
+		{
+			ActorChannel->MinClient = this;
+		}
+	}
+
+	return bAccepted;
+}
+
+
+static FAutoConsoleCommand PingIntervalCommand(
+	TEXT("NetTester.Ping.Interval"),
+	TEXT("Sets the automatic ping interval (in seconds, 0 disables) of every minimal client. Usage: NetTester.Ping.Interval <Seconds>"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const float Interval = Args.Num() > 0 ? FCString::Atof(*Args[0]) : 0.f;
+
+		for (TObjectIterator<UMinimalClient> It; It; ++It)
+		{
+			It->SetPingInterval(Interval);
+		}
+	}));
+
+static FAutoConsoleCommand LatencyReportCommand(
+	TEXT("NetTester.Latency.Report"),
+	TEXT("Logs the round trip time percentiles of every minimal client, and of all of them merged."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		FNetLatencyHistogram Aggregate;
+
+		for (TObjectIterator<UMinimalClient> It; It; ++It)
+		{
+			if (It->GetConnections().Num() > 0)
+			{
+				It->LogLatencyReport();
+				Aggregate.Merge(It->GetAggregateRttHistogram());
+			}
+		}
+
+		UE_LOG(LogNetworkTester, Log, TEXT("RTT all minimal clients: %s"), *Aggregate.ToString());
+	}));
+
+static FAutoConsoleCommand NetThreadCommand(
+	TEXT("NetTester.NetThread"),
+	TEXT("Ticks the net driver of every current and future minimal client on its own thread (0 returns to the game thread tick). Usage: NetTester.NetThread <TicksPerSecond>"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const float TickRate = Args.Num() > 0 ? FCString::Atof(*Args[0]) : 0.f;
+
+		UMinimalClient::DefaultNetThreadRate = FMath::Max(TickRate, 0.f);
+
+		for (TObjectIterator<UMinimalClient> It; It; ++It)
+		{
+			if (TickRate > 0.f)
+			{
+				It->StartNetThread(TickRate);
+			}
+			else
+			{
+				It->StopNetThread();
+			}
+		}
+	}));
+
+static FAutoConsoleCommand BroadcastReportCommand(
+	TEXT("NetTester.Broadcast.Report"),
+	TEXT("Logs how much serialization work serialize-once broadcasting saved, for every listening minimal client."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		for (TObjectIterator<UMinimalClient> It; It; ++It)
+		{
+			if (It->IsListening())
+			{
+				It->LogBroadcastReport();
+			}
+		}
+	}));
+
+static FAutoConsoleCommand SendBatchCommand(
+	TEXT("NetTester.Batch"),
+	TEXT("Enables/disables send batching on every minimal client. Usage: NetTester.Batch <0/1> [WindowSeconds] [ByteBudget]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const bool bEnable = Args.Num() > 0 && FCString::Atoi(*Args[0]) != 0;
+		const float WindowSeconds = Args.Num() > 1 ? FCString::Atof(*Args[1]) : 0.f;
+		const int32 ByteBudget = Args.Num() > 2 ? FCString::Atoi(*Args[2]) : 1000;
+
+		for (TObjectIterator<UMinimalClient> It; It; ++It)
+		{
+			It->SetSendBatching(bEnable, WindowSeconds, ByteBudget);
+		}
+	}));
+
+static FAutoConsoleCommand SendBatchReportCommand(
+	TEXT("NetTester.Batch.Report"),
+	TEXT("Logs bunch/packet counts and header overhead per message, with and without send batching."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		for (TObjectIterator<UMinimalClient> It; It; ++It)
+		{
+			It->LogSendBatchReport();
+		}
+	}));
+
+static FAutoConsoleCommand NetConditionCommand(
+	TEXT("NetTester.NetSim"),
+	TEXT("Applies a network condition profile to every minimal client (Off, LAN, Transatlantic, Mobile3G, LossyWifi). Usage: NetTester.NetSim <Profile>"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const FName ProfileName = Args.Num() > 0 ? FName(*Args[0]) : FName(TEXT("Off"));
+
+		for (TObjectIterator<UMinimalClient> It; It; ++It)
+		{
+			It->SetNetConditionProfile(ProfileName);
+		}
+	}));
+
+static FAutoConsoleCommand NetConditionReportCommand(
+	TEXT("NetTester.NetSim.Report"),
+	TEXT("Logs what the network condition simulator did to every minimal client connection, with the resulting loss and lag."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		for (TObjectIterator<UMinimalClient> It; It; ++It)
+		{
+			It->LogNetConditionReport();
+		}
+	}));
+
+static FAutoConsoleCommand StatsStartCommand(
+	TEXT("NetTester.Stats.Start"),
+	TEXT("Records per-connection stats of every minimal client to Saved/NetworkTester. Usage: NetTester.Stats.Start [csv|json] [IntervalMs]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const bool bJson = Args.Num() > 0 && Args[0] == TEXT("json");
+		const float IntervalSeconds = Args.Num() > 1 ? FCString::Atof(*Args[1]) / 1000.f : 1.f;
+		const FString Timestamp = FDateTime::Now().ToString();
+
+		for (TObjectIterator<UMinimalClient> It; It; ++It)
+		{
+			if (It->GetNetDriver() != nullptr)
+			{
+				const FString Filename = FPaths::ProjectSavedDir() / TEXT("NetworkTester") /
+					FString::Printf(TEXT("Stats_%s_%s.%s"), *It->GetName(), *Timestamp, bJson ? TEXT("jsonl") : TEXT("csv"));
+
+				It->StartStatsRecording(Filename, bJson ? ENetStatsFormat::JsonLines : ENetStatsFormat::Csv, IntervalSeconds);
+			}
+		}
+	}));
+
+static FAutoConsoleCommand StatsStopCommand(
+	TEXT("NetTester.Stats.Stop"),
+	TEXT("Stops recording per-connection stats, and closes the files."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		for (TObjectIterator<UMinimalClient> It; It; ++It)
+		{
+			It->StopStatsRecording();
+		}
+	}));
+
+static FAutoConsoleCommand ChatWireFormatCommand(
+	TEXT("NetTester.Protocol"),
+	TEXT("Sets the wire format of chat text sent by every minimal client. Usage: NetTester.Protocol <legacy|compact>"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const EChatWireFormat Format = Args.Num() > 0 && Args[0] == TEXT("compact") ? EChatWireFormat::Compact : EChatWireFormat::Legacy;
+
+		for (TObjectIterator<UMinimalClient> It; It; ++It)
+		{
+			It->SetChatWireFormat(Format);
+		}
+	}));
+
+static FAutoConsoleCommand ChatWireReportCommand(
+	TEXT("NetTester.Protocol.Report"),
+	TEXT("Logs the bytes per message of the chat text sent by every minimal client, in both wire formats."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		for (TObjectIterator<UMinimalClient> It; It; ++It)
+		{
+			if (It->GetNetDriver() != nullptr)
+			{
+				It->LogChatWireReport();
+			}
+		}
+	}));
+
+static FAutoConsoleCommand ChatRecordsCommand(
+	TEXT("NetTester.Protocol.Records"),
+	TEXT("Sends a burst of binary records from every minimal client. Usage: NetTester.Protocol.Records [Count] [Tag]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const int32 Count = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 100;
+		const uint8 Tag = Args.Num() > 1 ? (uint8)FCString::Atoi(*Args[1]) : 0;
+
+		for (TObjectIterator<UMinimalClient> It; It; ++It)
+		{
+			if (It->GetNetDriver() != nullptr)
+			{
+				FChatRecord Record;
+
+				Record.Tag = Tag;
+
+				for (int32 i = 0; i < Count; i++)
+				{
+					Record.Sequence = (uint32)i;
+					Record.Values[0] = (float)FPlatformTime::Seconds();
+
+					It->SendRecord(Record);
+				}
+			}
+		}
+	}));
+
+static FAutoConsoleCommand CompressionCommand(
+	TEXT("NetTester.Compress"),
+	TEXT("Sets chat payload compression on every minimal client. Usage: NetTester.Compress <off|zlib|gzip|lz4|oodle> [fast|default|size] [ThresholdBytes]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		FChatCompressionSettings Settings;
+
+		Settings.Codec = Args.Num() > 0 ? FChatCompression::FindCodec(Args[0]) : NAME_None;
+		Settings.bEnabled = Settings.Codec != NAME_None;
+
+		if (Args.Num() > 1)
+		{
+			Settings.Level = Args[1] == TEXT("fast") ? EChatCompressionLevel::Fast :
+				(Args[1] == TEXT("size") ? EChatCompressionLevel::Size : EChatCompressionLevel::Default);
+		}
+
+		if (Args.Num() > 2)
+		{
+			Settings.ThresholdBytes = FCString::Atoi(*Args[2]);
+		}
+
+		for (TObjectIterator<UMinimalClient> It; It; ++It)
+		{
+			It->SetChatCompression(Settings);
+		}
+	}));
+
+static FAutoConsoleCommand CompressionReportCommand(
+	TEXT("NetTester.Compress.Report"),
+	TEXT("Logs the compression ratio, CPU cost per KB, and the bytes saved per connection, of every minimal client."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		for (TObjectIterator<UMinimalClient> It; It; ++It)
+		{
+			if (It->GetNetDriver() != nullptr)
+			{
+				It->LogCompressionReport();
+			}
+		}
+	}));
+
+static FAutoConsoleCommand BlobSendCommand(
+	TEXT("NetTester.Blob.Send"),
+	TEXT("Streams a blob from every connected minimal client. Usage: NetTester.Blob.Send [SizeMB] [random|repeat]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const int32 NumBytes = FMath::Max(1, (int32)((Args.Num() > 0 ? FCString::Atof(*Args[0]) : 4.f) * 1024.f * 1024.f));
+		const bool bRandom = Args.Num() < 2 || Args[1] != TEXT("repeat");
+
+		for (TObjectIterator<UMinimalClient> It; It; ++It)
+		{
+			if (It->GetConnections().Num() > 0)
+			{
+				TArray<uint8> Data;
+
+				Data.SetNumUninitialized(NumBytes);
+
+				for (int32 i = 0; i < NumBytes; i++)
+				{
+					Data[i] = bRandom ? (uint8)FMath::Rand() : (uint8)(i % 251);
+				}
+
+				const uint32 BlobId = It->SendBlob(MoveTemp(Data));
+
+				UE_LOG(LogNetworkTester, Log, TEXT("%s: started blob %u"), *It->GetName(), BlobId);
+			}
+		}
+	}));
+
+static FAutoConsoleCommand BlobControlCommand(
+	TEXT("NetTester.Blob.Control"),
+	TEXT("Pauses, resumes or cancels a blob on every minimal client. Usage: NetTester.Blob.Control <pause|resume|cancel> <BlobId>"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		if (Args.Num() < 2)
+		{
+			return;
+		}
+
+		const uint32 BlobId = (uint32)FCString::Atoi(*Args[1]);
+
+		for (TObjectIterator<UMinimalClient> It; It; ++It)
+		{
+			if (Args[0] == TEXT("pause"))
+			{
+				It->PauseBlob(BlobId);
+			}
+			else if (Args[0] == TEXT("resume"))
+			{
+				It->ResumeBlob(BlobId);
+			}
+			else if (Args[0] == TEXT("cancel"))
+			{
+				It->CancelBlob(BlobId);
+			}
+		}
+	}));
+
+static FAutoConsoleCommand BlobFlowCommand(
+	TEXT("NetTester.Blob.Flow"),
+	TEXT("Sets blob streaming flow control on every minimal client. Usage: NetTester.Blob.Flow <ChunkBytes> [ReliableBufferFraction]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		FBlobFlowSettings Settings;
+
+		Settings.ChunkBytes = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : Settings.ChunkBytes;
+		Settings.ReliableBufferFraction = Args.Num() > 1 ? FCString::Atof(*Args[1]) : Settings.ReliableBufferFraction;
+
+		for (TObjectIterator<UMinimalClient> It; It; ++It)
+		{
+			It->SetBlobFlowSettings(Settings);
+		}
+	}));
+
+static FAutoConsoleCommand BlobReportCommand(
+	TEXT("NetTester.Blob.Report"),
+	TEXT("Logs the progress of active blobs, and the throughput and time to completion of finished blobs, of every minimal client."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		for (TObjectIterator<UMinimalClient> It; It; ++It)
+		{
+			if (It->GetNetDriver() != nullptr)
+			{
+				It->LogBlobReport();
+			}
+		}
+	}));
+
+static FAutoConsoleCommand UnreliableBurstCommand(
+	TEXT("NetTester.Unreliable.Burst"),
+	TEXT("Sends a burst of unreliable records from every minimal client, for measuring delivery. Usage: NetTester.Unreliable.Burst [Count]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const int32 Count = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 1000;
+
+		for (TObjectIterator<UMinimalClient> It; It; ++It)
+		{
+			if (It->GetNetDriver() != nullptr)
+			{
+				FChatRecord Record;
+
+				for (int32 i = 0; i < Count; i++)
+				{
+					Record.Sequence = (uint32)i;
+
+					It->SendRecord(Record, false);
+				}
+			}
+		}
+	}));
+
+static FAutoConsoleCommand UnreliableReportCommand(
+	TEXT("NetTester.Unreliable.Report"),
+	TEXT("Logs the delivery rate, loss, reordering, duplicates and latency of the unreliable messages received by every minimal client."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		for (TObjectIterator<UMinimalClient> It; It; ++It)
+		{
+			It->LogUnreliableReport();
+		}
+	}));
+
+static FAutoConsoleCommand TickScheduleCommand(
+	TEXT("NetTester.Tick"),
+	TEXT("Sets how every minimal client ticks its net driver. Usage: NetTester.Tick <auto|step|split> [DispatchHz] [FlushHz] (0 Hz ticks every frame)"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		FMinimalClientTickSettings Settings;
+		const FString ModeStr = Args.Num() > 0 ? Args[0] : TEXT("auto");
+
+		if (ModeStr == TEXT("step"))
+		{
+			Settings.Mode = EMinimalClientTickMode::Step;
+		}
+		else if (ModeStr == TEXT("split"))
+		{
+			Settings.Mode = EMinimalClientTickMode::Split;
+		}
+		else if (ModeStr != TEXT("auto"))
+		{
+			UE_LOG(LogNetworkTester, Warning, TEXT("NetTester.Tick: unknown mode '%s'"), *ModeStr);
+			return;
+		}
+
+		Settings.DispatchRate = Args.Num() > 1 ? FCString::Atof(*Args[1]) : 0.f;
+		Settings.FlushRate = Args.Num() > 2 ? FCString::Atof(*Args[2]) : Settings.DispatchRate;
+
+		for (TObjectIterator<UMinimalClient> It; It; ++It)
+		{
+			It->SetTickSchedule(Settings);
+		}
+	}));
+
+static FAutoConsoleCommand TickStepCommand(
+	TEXT("NetTester.Tick.Step"),
+	TEXT("Dispatches and flushes the net driver of every minimal client in step mode once. Usage: NetTester.Tick.Step [Count]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const int32 Count = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 1;
+
+		for (TObjectIterator<UMinimalClient> It; It; ++It)
+		{
+			for (int32 i = 0; i < Count; i++)
+			{
+				It->StepTick();
+			}
+		}
+	}));
+
+static FAutoConsoleCommand TickReportCommand(
+	TEXT("NetTester.Tick.Report"),
+	TEXT("Logs the achieved dispatch/flush rates, and the distribution of their durations, of every minimal client."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		for (TObjectIterator<UMinimalClient> It; It; ++It)
+		{
+			if (It->GetNetDriver() != nullptr)
+			{
+				It->LogTickReport();
+			}
+		}
+	}));
+
+static FAutoConsoleCommand CleanupGCCommand(
+	TEXT("NetTester.Cleanup.GC"),
+	TEXT("Sets how minimal client Cleanup reclaims net drivers/worlds. Usage: NetTester.Cleanup.GC <immediate|deferred> [BatchSize]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		FMinimalClientCleanupSettings Settings = UMinimalClient::GetCleanupSettings();
+
+		Settings.bImmediateGC = Args.Num() > 0 && Args[0] == TEXT("immediate");
+
+		if (Args.Num() > 1)
+		{
+			Settings.GCBatchSize = FCString::Atoi(*Args[1]);
+		}
+
+		UMinimalClient::SetCleanupSettings(Settings);
+
+		UE_LOG(LogNetworkTester, Log, TEXT("Cleanup: %s GC"), Settings.bImmediateGC ? TEXT("immediate full purge") :
+			*FString::Printf(TEXT("GC requested every %i cleanups"), UMinimalClient::GetCleanupSettings().GCBatchSize));
+	}));
+
+static FAutoConsoleCommand SharedWorldCommand(
+	TEXT("NetTester.SharedWorld"),
+	TEXT("Sets whether minimal clients which Listen/Connect from now on share one world, each owning only a net driver. Usage: NetTester.SharedWorld <0|1>"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		UMinimalClient::SetSharedWorldMode(Args.Num() > 0 && FCString::Atoi(*Args[0]) != 0);
+
+		UE_LOG(LogNetworkTester, Log, TEXT("SharedWorld: %s (%i clients using the shared world)"),
+			UMinimalClient::IsSharedWorldMode() ? TEXT("on") : TEXT("off"), UMinimalClient::GetNumSharedWorldUsers());
+	}));
+
+static FAutoConsoleCommand ActorsSpawnCommand(
+	TEXT("NetTester.Actors.Spawn"),
+	TEXT("Spawns synthetic replicated actors on every listening minimal client. ")
+	TEXT("Usage: NetTester.Actors.Spawn <Count> [UpdateHz] [NumFloats] [NumInts] [PayloadBytes] [ActorClassPath]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		FSyntheticActorGroupSettings Settings;
+
+		Settings.NumActors = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : Settings.NumActors;
+		Settings.UpdateRate = Args.Num() > 1 ? FCString::Atof(*Args[1]) : Settings.UpdateRate;
+		Settings.NumFloats = Args.Num() > 2 ? FCString::Atoi(*Args[2]) : Settings.NumFloats;
+		Settings.NumInts = Args.Num() > 3 ? FCString::Atoi(*Args[3]) : Settings.NumInts;
+		Settings.PayloadBytes = Args.Num() > 4 ? FCString::Atoi(*Args[4]) : Settings.PayloadBytes;
+
+		if (Args.Num() > 5)
+		{
+			Settings.ActorClass = LoadClass<AActor>(nullptr, *Args[5]);
+
+			if (Settings.ActorClass == nullptr)
+			{
+				UE_LOG(LogNetworkTester, Warning, TEXT("NetTester.Actors.Spawn: unknown actor class '%s'"), *Args[5]);
+				return;
+			}
+		}
+
+		for (TObjectIterator<UMinimalClient> It; It; ++It)
+		{
+			if (It->IsListening())
+			{
+				const int32 NumSpawned = It->SpawnSyntheticActors(Settings);
+
+				UE_LOG(LogNetworkTester, Log, TEXT("%s: spawned %i synthetic actors"), *It->GetName(), NumSpawned);
+			}
+		}
+	}));
+
+static FAutoConsoleCommand ActorsClearCommand(
+	TEXT("NetTester.Actors.Clear"),
+	TEXT("Destroys the synthetic replicated actors of every minimal client."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		for (TObjectIterator<UMinimalClient> It; It; ++It)
+		{
+			It->ClearSyntheticActors();
+		}
+	}));
+
+static FAutoConsoleCommand ActorsReportCommand(
+	TEXT("NetTester.Actors.Report"),
+	TEXT("Logs the synthetic actor traffic sent, and the actor traffic received per class, of every minimal client. Usage: NetTester.Actors.Report [BudgetKBps]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const float BudgetKBps = Args.Num() > 0 ? FCString::Atof(*Args[0]) : 10.f;
+
+		for (TObjectIterator<UMinimalClient> It; It; ++It)
+		{
+			if (It->GetNetDriver() != nullptr)
+			{
+				It->LogActorReport(BudgetKBps);
+			}
+		}
+	}));
+
+static FAutoConsoleCommand ActorFilterCommand(
+	TEXT("NetTester.ActorFilter"),
+	TEXT("Sets which replicated actors minimal clients spawn (subclasses of the listed classes match too). ")
+	TEXT("Usage: NetTester.ActorFilter <Off|Allow|Deny> [ClassPath...]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		FMinimalClientActorFilterSettings Settings;
+		const FString ModeStr = Args.Num() > 0 ? Args[0] : TEXT("Off");
+
+		Settings.Mode = ModeStr == TEXT("Allow") ? EMinimalClientActorFilterMode::Allow :
+			(ModeStr == TEXT("Deny") ? EMinimalClientActorFilterMode::Deny : EMinimalClientActorFilterMode::Disabled);
+
+		for (int32 ArgIdx = 1; ArgIdx < Args.Num(); ArgIdx++)
+		{
+			UClass* CurClass = LoadClass<AActor>(nullptr, *Args[ArgIdx]);
+
+			if (CurClass == nullptr)
+			{
+				UE_LOG(LogNetworkTester, Warning, TEXT("NetTester.ActorFilter: unknown actor class '%s'"), *Args[ArgIdx]);
+				return;
+			}
+
+			Settings.Classes.Add(CurClass);
+		}
+
+		UMinimalClient::SetActorFilter(Settings);
+
+		UE_LOG(LogNetworkTester, Log, TEXT("ActorFilter: %s"), *Settings.ToString());
+	}));
+
+static FAutoConsoleCommand ActorFilterReportCommand(
+	TEXT("NetTester.ActorFilter.Report"),
+	TEXT("Logs the actors blocked by the actor filter, and the memory and CPU saved, of every connected minimal client, and per bot."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		FActorFilterSavings Total;
+		int32 NumClients = 0;
+
+		for (TObjectIterator<UMinimalClient> It; It; ++It)
+		{
+			if (It->GetNetDriver() != nullptr && !It->IsListening())
+			{
+				const FActorFilterSavings Savings = It->GetActorFilterSavings();
+
+				It->LogActorFilterReport();
+
+				Total.NumBlockedActors += Savings.NumBlockedActors;
+				Total.Bytes += Savings.Bytes;
+				Total.Seconds += Savings.Seconds;
+				NumClients++;
+			}
+		}
+
+		if (NumClients > 0)
+		{
+			UE_LOG(LogNetworkTester, Log, TEXT("ActorFilter: %i clients, per bot %.1f actors blocked, est. saved %.1f KB memory, %.3f ms CPU"),
+				NumClients, (double)Total.NumBlockedActors / NumClients, Total.Bytes / 1024.0 / NumClients,
+				Total.Seconds * 1000.0 / NumClients);
+		}
+	}));
+
+static FAutoConsoleCommand LoopbackCommand(
+	TEXT("NetTester.Loopback"),
+	TEXT("Sets whether minimal clients link up with each other through in-process queues rather than sockets, from their next Listen/Connect. Usage: NetTester.Loopback <0|1>"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		UMinimalClient::bDefaultLoopbackTransport = Args.Num() > 0 && FCString::Atoi(*Args[0]) != 0;
+
+		for (TObjectIterator<UMinimalClient> It; It; ++It)
+		{
+			It->bLoopbackTransport = UMinimalClient::bDefaultLoopbackTransport;
+		}
+
+		UE_LOG(LogNetworkTester, Log, TEXT("Loopback transport: %s"), UMinimalClient::bDefaultLoopbackTransport ? TEXT("on") : TEXT("off"));
+	}));
+
+static FAutoConsoleCommand LoopbackReportCommand(
+	TEXT("NetTester.Loopback.Report"),
+	TEXT("Logs the packets every minimal client connection sent and received through the loopback transport."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		for (TObjectIterator<UMinimalClient> It; It; ++It)
+		{
+			It->LogLoopbackReport();
+		}
+	}));
+
+static FAutoConsoleCommand PackageMapProfileCommand(
+	TEXT("NetTester.PackageMap.Profile"),
+	TEXT("Enables/disables profiling of NetGUID/name serialization, per class and name, in every minimal client package map (enabling clears the profile). Usage: NetTester.PackageMap.Profile <0|1>"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const bool bEnable = Args.Num() > 0 ? FCString::Atoi(*Args[0]) != 0 : !FPackageMapProfiler::IsEnabled();
+
+		if (bEnable && !FPackageMapProfiler::IsEnabled())
+		{
+			for (TObjectIterator<UMinimalClient> It; It; ++It)
+			{
+				It->ResetPackageMapProfile();
+			}
+		}
+
+		FPackageMapProfiler::SetEnabled(bEnable);
+
+		UE_LOG(LogNetworkTester, Log, TEXT("PackageMap profiling %s"), bEnable ? TEXT("enabled") : TEXT("disabled"));
+	}));
+
+static FAutoConsoleCommand PackageMapReportCommand(
+	TEXT("NetTester.PackageMap.Report"),
+	TEXT("Logs the costliest NetGUID/name serializations of every minimal client, optionally appending them to a CSV file. Usage: NetTester.PackageMap.Report [TopN] [CsvFilename]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const int32 TopN = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 20;
+		const FString CsvFilename = Args.Num() > 1 ? Args[1] : TEXT("");
+
+		for (TObjectIterator<UMinimalClient> It; It; ++It)
+		{
+			if (It->GetNetDriver() != nullptr)
+			{
+				It->LogPackageMapReport(TopN, CsvFilename);
+			}
+		}
+	}));
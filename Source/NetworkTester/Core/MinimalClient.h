@@ -6,10 +6,23 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Containers/Queue.h"
+#include "HAL/CriticalSection.h"
+#include <atomic>
 
 #include "Engine/NetConnection.h"
 #include "Engine/PendingNetGame.h"
 
+#include "NetLatencyHistogram.h"
+#include "NetStatsRecorder.h"
+#include "ChatMessageCodec.h"
+#include "ChatCompression.h"
+#include "BlobTransfer.h"
+#include "MinimalClientTickScheduler.h"
+#include "SyntheticActorScenario.h"
+#include "PackageMapProfiler.h"
+#include "MinimalClientActorFilter.h"
+
 #include "MinimalClient.generated.h"
 
 
@@ -51,7 +64,7 @@ DECLARE_DELEGATE_TwoParams(FOnMinClientReceivedRawPacket, void* /*Data*/, int32&
  *
  * @param ActorClass	The class of the actor being replicated
  * @param bActorChannel	Whether or not this actor creation is from an actor channel
- * @param bBlockActor	Whether or not to block creation of the actor (defaults to true)
+ * @param bBlockActor	Whether or not to block creation of the actor (defaults to the actor filter's verdict)
  */
 DECLARE_DELEGATE_ThreeParams(FOnMinClientRepActorSpawn, UClass* /*ActorClass*/, bool /*bActorChannel*/, bool& /*bBlockActor*/);
 
@@ -79,11 +92,203 @@ DECLARE_DELEGATE(FOnRPCFailure);
 /* on message delegate */
 DECLARE_MULTICAST_DELEGATE_TwoParams(FOnReceiveMessage, const FString &InText, UNetConnection* /*Connection*/);
 
+/* on blob delegate */
+DECLARE_MULTICAST_DELEGATE_ThreeParams(FOnReceiveBlob, uint32 /*BlobId*/, const TArray<uint8>& /*Data*/, UNetConnection* /*Connection*/);
+
+/* on binary record delegate */
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnReceiveRecord, const FChatRecord& /*Record*/, UNetConnection* /*Connection*/);
+
+
+class FMinimalClientNetThread;
+class UMyConnection;
+
+
+/** A request from the game thread, for the net thread to execute */
+struct FMinimalClientNetCommand
+{
+	enum class EType : uint8
+	{
+		SendText,
+		SendPing,
+		SendRecord,
+		SendBlob,
+		PauseBlob,
+		ResumeBlob,
+		CancelBlob
+	};
+
+	EType Type;
+
+	FString Text;
+
+	FChatRecord Record;
+
+	uint32 BlobId = 0;
+
+	TSharedPtr<const TArray<uint8>, ESPMode::ThreadSafe> Blob;
+
+	/** Whether SendText/SendRecord deliver reliably */
+	bool bReliable = true;
+};
+
+/** A notification raised while ticking the net driver, handed over to the game thread when ticking on the net thread */
+struct FMinimalClientNetEvent
+{
+	enum class EType : uint8
+	{
+		ReceivedText,
+		ReceivedRecord,
+		ReceivedBlob,
+		Connected,
+		NetworkFailure
+	};
+
+	EType Type;
+
+	FString Text;
+
+	UNetConnection* Connection = nullptr;
+
+	ENetworkFailure::Type FailureType = ENetworkFailure::ConnectionLost;
+
+	FChatRecord Record;
+
+	uint32 BlobId = 0;
+
+	TSharedPtr<const TArray<uint8>, ESPMode::ThreadSafe> Blob;
+};
+
+
+/** Savings from serializing broadcast payloads once, rather than once per connection */
+struct FBroadcastStats
+{
+	/** Text shorter than this is converted to ANSI on the stack when serialized, longer text allocates */
+	static constexpr int32 ConversionInlineChars = 128;
+
+	/** The number of BroadcastText calls */
+	uint64 NumBroadcasts = 0;
+
+	/** The number of bunches sent by BroadcastText */
+	uint64 NumBunchesSent = 0;
+
+	/** Time (in seconds) spent serializing payloads */
+	double SerializeSeconds = 0.0;
+
+	/** The number of payload serializations skipped, compared to serializing per connection */
+	uint64 AvoidedSerializations = 0;
+
+	/** Estimated time (in seconds) the skipped serializations would have taken */
+	double EstimatedSavedSeconds = 0.0;
+
+	/**
+	 * Estimated conversion buffer allocations skipped: one per skipped serialization of legacy text at least
+	 * ConversionInlineChars long, assuming StringCast's inline buffer - not measured
+	 */
+	uint64 EstimatedAvoidedAllocations = 0;
+};
+
+
+/** Send counters, kept separately with and without send batching, for comparing header overhead */
+struct FSendBatchStats
+{
+	/** The number of messages sent (counted once per destination connection) */
+	uint64 NumMessages = 0;
+
+	/** The number of chat bunches sent */
+	uint64 NumBunches = 0;
+
+	/** Chat payload bits sent, excluding bunch/packet headers */
+	uint64 PayloadBits = 0;
+
+	/** Bytes of the packets carrying these chat bunches, including all headers (and anything else sharing the packets) */
+	uint64 WireBytes = 0;
+
+	/** Packets carrying these chat bunches */
+	uint64 WirePackets = 0;
+
+	/** The most bytes a batch adds in front of its messages (message type, and packed message count) */
+	static constexpr int32 BatchHeaderBytes = 6;
+};
+
+
+/** Per-message size of the chat traffic sent, in both wire formats */
+struct FChatWireStats
+{
+	/** The number of text messages sent in each format (counted once, regardless of the number of destination connections) */
+	uint64 NumTextMessages[2] = {};
+
+	/** The bytes the text took in each format, as written */
+	uint64 TextBytes[2] = {};
+
+	/** The number of records sent */
+	uint64 NumRecords = 0;
+
+	/** The number of records received */
+	uint64 NumReceivedRecords = 0;
+};
+
+
+/** How Cleanup reclaims the net driver and world it destroyed, shared by every minimal client */
+struct FMinimalClientCleanupSettings
+{
+	/** Whether to force a full purge on every Cleanup (slow when churning many connections), rather than batching them up */
+	bool bImmediateGC = false;
+
+	/** The number of Cleanups after which a (non-purging) GC is requested from the engine, when not immediate */
+	int32 GCBatchSize = 64;
+};
+
+
+/** Actor channel traffic received for one actor class */
+struct FActorClassNetStats
+{
+	/** The number of actor channels opened (actors received) */
+	uint64 NumOpened = 0;
+
+	uint64 NumBunches = 0;
+	uint64 Bits = 0;
+
+	/** Bits and time (in seconds) of the bunches which opened the channels, and spawned the actors */
+	uint64 OpenBits = 0;
+	double OpenSeconds = 0.0;
+
+	/** Time (in seconds) spent processing every bunch */
+	double ReceiveSeconds = 0.0;
+
+	/** The time (FPlatformTime::Seconds) of the first and last bunch */
+	double FirstTime = 0.0;
+	double LastTime = 0.0;
+
+	/** The number of actors blocked by the actor filter, and the bunches dropped for them (not counted above) */
+	uint64 NumBlocked = 0;
+	uint64 BlockedBunches = 0;
+	uint64 BlockedBits = 0;
+	double BlockedSeconds = 0.0;
+
+	/** FMinimalClientActorFilter::EstimateActorBytes of the class, once an actor was blocked */
+	uint64 EstimatedActorBytes = 0;
+};
+
+
+/** What the actor filter of a minimal client saved */
+struct FActorFilterSavings
+{
+	uint64 NumBlockedActors = 0;
+
+	/** Estimated memory (in bytes) the blocked actors would have taken */
+	uint64 Bytes = 0;
+
+	/** Estimated time (in seconds) the dropped bunches would have taken to process, had their actors been spawned */
+	double Seconds = 0.0;
+};
+
 
 // base class for implementing a bare bones/stripped-down game client or listened server.
 UCLASS()
 class NETWORKTESTER_API UMinimalClient : public UObject, public FNetworkNotify, public FTickableGameObject
 {
+	friend FMinimalClientNetThread;
+
 	GENERATED_UCLASS_BODY()
 
 public:
@@ -95,6 +300,8 @@ public:
 		return true;
 	}
 
+	virtual void BeginDestroy() override;
+
 	// Listen as a server
 	bool Listen(const FString& InServerAddr, uint16 InPort);
 
@@ -104,6 +311,53 @@ public:
 	// Disconnects and cleans up the minmal client.
 	void Cleanup();
 
+	/**
+	 * Sets how every minimal client's Cleanup reclaims the net driver and world it destroyed
+	 *
+	 * @param InSettings	The cleanup settings
+	 */
+	static void SetCleanupSettings(const FMinimalClientCleanupSettings& InSettings);
+
+	static const FMinimalClientCleanupSettings& GetCleanupSettings()
+	{
+		return CleanupSettings;
+	}
+
+	/**
+	 * Sets whether minimal clients which Listen/Connect from now on share one world, each owning only a net driver,
+	 * rather than creating a world (and world context) each
+	 *
+	 * @param bEnable	Whether or not to share a world
+	 */
+	static void SetSharedWorldMode(bool bEnable);
+
+	static bool IsSharedWorldMode()
+	{
+		return bSharedWorldMode;
+	}
+
+	/**
+	 * Sets which replicated actors every minimal client spawns, now and on later Connects.
+	 * Blocked actors' channels stay open, and their bunches are dropped (while the packets carrying them are still acked).
+	 *
+	 * @param InSettings	The class allow/deny list
+	 */
+	static void SetActorFilter(const FMinimalClientActorFilterSettings& InSettings);
+
+	/** Drops the garbage collected classes from the shared and per-client actor filter classes */
+	static void PruneActorFilterClasses();
+
+	static const FMinimalClientActorFilterSettings& GetActorFilterSettings()
+	{
+		return ActorFilterSettings;
+	}
+
+	/** @return The number of minimal clients currently using the shared world */
+	static int32 GetNumSharedWorldUsers()
+	{
+		return NumSharedWorldUsers;
+	}
+
 	/**
 	* Resets the net connection timeout
 	*
@@ -113,18 +367,436 @@ public:
 
 	void SendInitialJoin();
 
-	void SendText(FString& InText);
+	/**
+	 * Sends text to the server, or to every client connection when listening
+	 *
+	 * @param InText	The text to send
+	 * @param bReliable	Whether to send reliably, or unreliably with a sequence number (unreliable text is never batched)
+	 */
+	void SendText(FString& InText, bool bReliable = true);
+
+	/**
+	 * Sends text to every client connection (server only), serializing the payload once and reusing its bits for every bunch
+	 *
+	 * @param InText	The text to send
+	 * @param bReliable	Whether to send reliably, or unreliably with a sequence number
+	 */
+	void BroadcastText(const FString& InText, bool bReliable = true);
+
+	const FBroadcastStats& GetBroadcastStats() const
+	{
+		return BroadcastStats;
+	}
+
+	// Writes the broadcast savings to the log
+	void LogBroadcastReport() const;
+
+	/**
+	 * Enables coalescing of sent text, so that many messages share one bunch/packet
+	 *
+	 * @param bEnable		Whether or not to batch sends (disabling flushes any pending batch)
+	 * @param WindowSeconds	The longest time a message waits for others to share its bunch (0 batches per tick)
+	 * @param ByteBudget	The batch is sent as soon as it reaches this many bytes (clamped, with a warning, to what fits in a bunch)
+	 */
+	void SetSendBatching(bool bEnable, float WindowSeconds, int32 ByteBudget);
+
+	// Sends any pending batched text now
+	void FlushSendBatch();
+
+	// Writes bunch/packet counts and header overhead per message to the log, with and without batching
+	void LogSendBatchReport() const;
+
+	/**
+	 * Sets the format text is sent in (any pending batch is flushed first). Both formats are always understood when receiving.
+	 *
+	 * @param InFormat	The new wire format
+	 */
+	void SetChatWireFormat(EChatWireFormat InFormat);
+
+	EChatWireFormat GetChatWireFormat() const
+	{
+		return ChatWireFormat;
+	}
+
+	/**
+	 * Sends a fixed-layout binary record to every connection
+	 *
+	 * @param InRecord	The record to send
+	 * @param bReliable	Whether to send reliably, or unreliably with a sequence number
+	 */
+	void SendRecord(const FChatRecord& InRecord, bool bReliable = true);
+
+	// Writes the unreliable messages sent, and the delivery rate, loss, reordering, duplicates and latency of those received, per connection, to the log
+	void LogUnreliableReport() const;
+
+	// Writes the bytes per message of the text sent in each wire format used, and the record counts, to the log
+	void LogChatWireReport() const;
+
+	/**
+	 * Sets how chat payloads are compressed, on every connection
+	 *
+	 * @param InSettings	The compression settings (an unsupported codec disables compression)
+	 */
+	void SetChatCompression(const FChatCompressionSettings& InSettings);
+
+	/** @return Compression counters of everything this client sent (decompression is counted per connection, on the chat channels) */
+	const FChatCompressionStats& GetChatCompressionStats() const
+	{
+		return CompressionStats;
+	}
+
+	// Writes the compression ratio, CPU cost per KB, and the bytes saved per connection, to the log
+	void LogCompressionReport() const;
+
+	/**
+	 * Streams a blob of any size to every connection, as a flow controlled sequence of chunks (see FBlobSender)
+	 *
+	 * @param Data	The blob
+	 * @return		The id of the blob, for pausing/resuming/cancelling it
+	 */
+	uint32 SendBlob(TArray<uint8>&& Data);
+
+	// Pauses streaming a blob, keeping its position
+	void PauseBlob(uint32 BlobId);
+
+	// Resumes streaming a paused blob, from where it stopped
+	void ResumeBlob(uint32 BlobId);
+
+	// Stops streaming a blob
+	void CancelBlob(uint32 BlobId);
+
+	/**
+	 * Sets the chunk size and reliable buffer limit of blob streaming
+	 *
+	 * @param InSettings	The flow control settings
+	 */
+	void SetBlobFlowSettings(const FBlobFlowSettings& InSettings);
+
+	// Writes the progress of active blobs, and the throughput and time to completion of finished blobs, to the log
+	void LogBlobReport() const;
+
+	/**
+	 * Sets how the net driver is ticked, on either the game thread or the net thread
+	 *
+	 * @param InSettings	The tick mode, and the dispatch/flush rates
+	 */
+	void SetTickSchedule(const FMinimalClientTickSettings& InSettings);
+
+	const FMinimalClientTickSettings& GetTickSchedule() const
+	{
+		return TickScheduler.GetSettings();
+	}
+
+	// Dispatches and flushes the net driver once, at its next tick (Step mode only)
+	void StepTick();
+
+	/** @return The time (in seconds) the last TickDispatch/TickFlush took */
+	double GetLastDispatchSeconds() const
+	{
+		return TickScheduler.GetLastDispatchSeconds();
+	}
+
+	double GetLastFlushSeconds() const
+	{
+		return TickScheduler.GetLastFlushSeconds();
+	}
+
+	// Writes the achieved dispatch/flush rates, and the distribution of their durations, to the log
+	void LogTickReport() const;
+
+	/**
+	 * Spawns a group of synthetic replicated actors, replicated to every client connection (listen server only)
+	 *
+	 * @param InSettings	The class, count, property set and update rate of the group
+	 * @return				The number of actors spawned
+	 */
+	int32 SpawnSyntheticActors(const FSyntheticActorGroupSettings& InSettings);
+
+	// Destroys every synthetic actor
+	void ClearSyntheticActors();
+
+	/**
+	 * Writes the sent synthetic actor traffic (server), and the received actor traffic per class (client), to the log
+	 *
+	 * @param BudgetKBps	The per-connection bandwidth budget, used to estimate how many actors of each class fit in it
+	 */
+	void LogActorReport(float BudgetKBps) const;
+
+	/** @return The actors blocked by the actor filter, and the memory and CPU this saved (estimated) */
+	FActorFilterSavings GetActorFilterSavings() const;
+
+	// Writes the actors blocked per class, and the memory and CPU saved, to the log
+	void LogActorFilterReport() const;
+
+	/**
+	 * Writes the costliest NetGUID/name serializations (by bits) of every package map to the log (needs profiling enabled)
+	 *
+	 * @param TopN			The number of entries listed per category and direction
+	 * @param CsvFilename	If set, the entries are also appended to this CSV file
+	 */
+	void LogPackageMapReport(int32 TopN, const FString& CsvFilename=TEXT("")) const;
+
+	// Clears the package map profile
+	void ResetPackageMapProfile();
+
+	// Sends a latency probe on every connection
+	void SendPing();
+
+	/**
+	 * Sets how often latency probes are sent automatically
+	 *
+	 * @param Seconds	The interval between pings, or 0 to disable automatic pings
+	 */
+	void SetPingInterval(float Seconds)
+	{
+		PingInterval = FMath::Max(Seconds, 0.f);
+	}
+
+	/** @return The round trip times of all connections, merged into one histogram */
+	FNetLatencyHistogram GetAggregateRttHistogram() const;
+
+	// Writes the per-connection and aggregate round trip time percentiles to the log
+	void LogLatencyReport() const;
+
+	/** @return The server connection when connected as a client, or all client connections when listening */
+	TArray<UNetConnection*> GetConnections() const;
+
+	/**
+	 * Moves ticking of the net driver off the game thread, onto a dedicated thread running at a fixed rate.
+	 * While enabled, sends are queued to the net thread, and received messages/notifications are queued back to the game thread.
+	 *
+	 * @param TickRate	The number of net driver ticks per second
+	 */
+	void StartNetThread(float TickRate);
+
+	// Stops the net thread (if running), returning net driver ticking to the game thread
+	void StopNetThread();
+
+	bool IsUsingNetThread() const
+	{
+		return NetThread != nullptr;
+	}
+
+	/**
+	 * Applies a named network condition profile (see FNetConditionSimulator) to every current and future connection
+	 *
+	 * @param ProfileName	The profile to apply ("Off" disables simulation)
+	 * @return				Whether or not the profile exists
+	 */
+	bool SetNetConditionProfile(FName ProfileName);
+
+	// Writes what the network condition simulator did to each connection, with the resulting loss and lag, to the log
+	void LogNetConditionReport() const;
+
+	// Writes the packets each connection sent and received through the loopback transport, to the log
+	void LogLoopbackReport() const;
+
+	/**
+	 * Starts sampling every connection at a fixed interval, into a CSV or JSON-lines file
+	 *
+	 * @param Filename			The file to write
+	 * @param Format			The file format
+	 * @param IntervalSeconds	The time between samples
+	 * @return					Whether or not recording started
+	 */
+	bool StartStatsRecording(const FString& Filename, ENetStatsFormat Format, float IntervalSeconds);
+
+	// Flushes and closes the stats file
+	void StopStatsRecording();
+
+	/**
+	 * Sets how often a snapshot of every connection's stats is taken, for live display
+	 *
+	 * @param Seconds	The interval between snapshots, or 0 to stop taking them
+	 */
+	void SetLiveSampleInterval(float Seconds)
+	{
+		LiveSampleInterval = FMath::Max(Seconds, 0.f);
+	}
+
+	/** Copies the latest live snapshot (safe to call while the net thread ticks). Sample times are FPlatformTime::Seconds */
+	void CopyLiveSamples(TArray<FNetConnectionSample>& OutSamples) const;
+
+	UNetDriver* GetNetDriver() const
+	{
+		return UnitNetDriver;
+	}
+
+	/** When set, connections discard everything they send (used when replaying captured traffic into this client) */
+	bool bDropOutgoingPackets;
+
+	/**
+	 * When set (before Listen/Connect), connections to/from other loopback minimal clients in this process are linked
+	 * through in-process queues once the handshake is done, bypassing the sockets (both sides must set it)
+	 */
+	bool bLoopbackTransport;
+
+	/** The bLoopbackTransport of minimal clients created from now on */
+	static bool bDefaultLoopbackTransport;
+
+	/** The net thread tick rate applied by Listen/Connect, when not already using the net thread (0 ticks on the game thread) */
+	static float DefaultNetThreadRate;
+
+	// Called by the chat channel, when a text message is received
+	void NotifyReceivedText(const FString& InText, UNetConnection* Connection);
+
+	// Called by the chat channel, when a binary record is received
+	void NotifyReceivedRecord(const FChatRecord& InRecord, UNetConnection* Connection);
+
+	// Called by the chat channel, when a blob has been fully received and verified
+	void NotifyReceivedBlob(uint32 BlobId, TArray<uint8>&& Data, UNetConnection* Connection);
+
+	/**
+	 * Called by the actor channels, after processing a bunch
+	 *
+	 * @param ActorClassName	The class of the channel's actor (NAME_None if no actor was spawned)
+	 * @param NumBits			The size of the bunch
+	 * @param Seconds			The time taken to process the bunch
+	 * @param bOpened			Whether or not this bunch spawned the channel's actor
+	 * @param bBlocked			Whether or not the channel's actor was blocked by the actor filter
+	 */
+	void NotifyActorBunch(FName ActorClassName, int64 NumBits, double Seconds, bool bOpened, bool bBlocked);
+
+	/**
+	 * Called by actor channels, before an open bunch spawns a replicated actor - consults the actor filter and RepActorSpawnDel
+	 *
+	 * @param ActorClass	The class of the actor about to be spawned
+	 * @return				Whether or not to block the actor from spawning
+	 */
+	bool ShouldBlockActorSpawn(UClass* ActorClass);
+
+	/**
+	 * Called by the package maps, after each profiled serialization
+	 *
+	 * @param Category	The hook which serialized
+	 * @param Key		The object/actor class, or the name
+	 * @param NumBits	The bits written or read
+	 * @param Seconds	The time taken
+	 * @param bSaving	Whether the bits were written or read
+	 */
+	void NotifyPackageMapSerialize(EPackageMapProfileCategory Category, FName Key, int64 NumBits, double Seconds, bool bSaving);
+
+	/**
+	 * Called by the connections, when sending a packet which carries chat bunches counted in the send batching stats
+	 *
+	 * @param SendBatchMode	Which SendBatchStats to count the packet in
+	 * @param NumBytes		The size of the packet
+	 */
+	void NotifySendBatchPacket(int32 SendBatchMode, int32 NumBytes);
+
+	/** Whether or not this minimal client is listening as a server */
+	bool IsListening() const
+	{
+		return UnitNetDriver != nullptr && UnitNetDriver->ServerConnection == nullptr;
+	}
+
+	/** Whether or not the server has answered our hello (client only) */
+	bool IsConnected() const
+	{
+		return bConnected;
+	}
+
+	/** @return The time (in seconds) between kicking off Connect and the server answering the hello */
+	double GetConnectSeconds() const
+	{
+		return ConnectSeconds;
+	}
+
+	/** @return The time (in seconds) the last Tick spent in the net driver */
+	double GetLastTickSeconds() const
+	{
+		return LastTickSeconds;
+	}
 
 	FOnReceiveMessage  ReceiveMessageDel;
+
+	/** Delegate for notifying of received binary records */
+	FOnReceiveRecord ReceiveRecordDel;
+
+	/** Delegate for notifying of fully received blobs */
+	FOnReceiveBlob ReceiveBlobDel;
+
+	/** Delegate for notifying when the server has answered our hello */
+	FOnMinClientConnected ConnectedDel;
+
+	/** Delegate for notifying of connection failure (including connect timeout) */
+	FOnMinClientNetworkFailure NetworkFailureDel;
+
+	/** Delegate for hooking every raw packet received by this client's connections (called on the thread ticking the net driver) */
+	FOnMinClientReceivedRawPacket ReceivedRawPacketDel;
+
+	/** Delegate for overriding whether a replicated actor is blocked from spawning (called on the thread ticking the net driver) */
+	FOnMinClientRepActorSpawn RepActorSpawnDel;
+
+	/** Delegate for notifying after an actor channel has spawned its actor (called on the thread ticking the net driver) */
+	FOnMinClientNetActor NetActorDel;
 protected:
-	// create world
-	UWorld* CreateWorld();
-	void CleanupWorld(UWorld *InWorld);
+	// Ticks the net driver, on either the game thread or the net thread
+	void TickNetDriver(float DeltaTime);
+
+	// Executes queued commands and ticks the net driver, on the net thread
+	void TickNetThread(float DeltaTime);
+
+	// Sends text to every connection, on the thread ticking the net driver
+	void SendTextImmediate(const FString& InText, bool bReliable);
+
+	// Sends a latency probe on every connection, on the thread ticking the net driver
+	void SendPingImmediate();
+
+	// Sends a binary record to every connection, on the thread ticking the net driver
+	void SendRecordImmediate(const FChatRecord& InRecord, bool bReliable);
 
-	// create net driver
-	UNetDriver* CreateNetDriver();
+	// Executes a command queued for the net thread
+	void ExecuteNetCommand(const FMinimalClientNetCommand& InCommand);
+
+	// Returns the reusable payload writer, emptied (its allocation is kept, so steady sends don't allocate)
+	FBitWriter& ResetPayloadWriter();
+
+	// Writes a text message (type and body) in the current wire format
+	void WriteTextMessage(FBitWriter& Ar, const FString& InText);
+
+	// Writes the body of a text message in the current wire format, and accounts for it in the wire stats
+	void WriteTextBody(FBitWriter& Ar, const FString& InText);
+
+	/**
+	 * Sends a prebuilt chat payload, as one bunch per connection
+	 *
+	 * @param Payload	The serialized message, starting with its EChatMessageType
+	 * @param bReliable		Whether to send reliably, or unreliably with a per-connection sequence number
+	 * @param SendBatchMode	The SendBatchStats the packets carrying the bunch are counted in (INDEX_NONE for none)
+	 * @return				The number of connections the bunch was sent to
+	 */
+	int32 SendPayload(FBitWriter& Payload, bool bReliable = true, int32 SendBatchMode = INDEX_NONE);
+
+	// Appends text to the pending batch, sending it if the byte budget is reached
+	void QueueBatchedText(const FString& InText);
+
+	// Returns the largest byte budget a batch can have, and still fit in a bunch on every connection
+	int32 GetMaxSendBatchBytes() const;
+
+	// Applies the current network condition profile to a connection
+	void ApplyNetConditionProfile(UMyConnection* Connection);
+
+	// Handles an event immediately, or queues it for the game thread when ticking on the net thread
+	void DispatchNetEvent(FMinimalClientNetEvent&& InEvent);
+
+	// Broadcasts a net event to the delegates, on the game thread
+	void HandleNetEvent(const FMinimalClientNetEvent& InEvent);
+
+	// Checks out a world and net driver from the pool when pooling, or creates them
+	bool AcquireWorldAndNetDriver();
+
+	// destroy net driver
 	void CleanupNetDriver(UNetDriver* InDriver);
 
+public:
+	// create world (also used to prewarm UMinimalClientWorldPool)
+	static UWorld* CreateWorld();
+	static void CleanupWorld(UWorld *InWorld);
+
+	// create net driver, with the minimal client channels patched in (only made the world's own net driver if bWorldNetDriver)
+	static UNetDriver* CreateNetDriver(UWorld* InWorld, bool bWorldNetDriver = true);
+
 	// FNetworkNotify
 protected:
 	virtual EAcceptConnection::Type NotifyAcceptingConnection() override
@@ -136,9 +808,10 @@ protected:
 
 	virtual bool NotifyAcceptingChannel(UChannel* Channel) override;
 
-	virtual void NotifyControlMessage(UNetConnection* Connection, uint8 MessageType, FInBunch& Bunch) override
-	{
-	}
+	virtual void NotifyControlMessage(UNetConnection* Connection, uint8 MessageType, FInBunch& Bunch) override;
+
+	/** Marks the connection as failed, and notifies NetworkFailureDel (only once per Connect) */
+	void NotifyConnectFailure(ENetworkFailure::Type FailureType, const FString& ErrorString);
 
 private:
 	/** The amount of time (in seconds) before the connection should timeout */
@@ -149,4 +822,161 @@ private:
 
 	/** Stores a reference to the created unit test net driver, for execution and later cleanup */
 	UNetDriver* UnitNetDriver;
+
+	/** Whether or not UnitWorld was checked out of UMinimalClientWorldPool, and goes back there on Cleanup */
+	bool bPooledWorld;
+
+	/** Whether or not UnitWorld is the shared world */
+	bool bUsingSharedWorld;
+
+	/** Whether or not the server has answered our hello (set after ConnectSeconds, on the thread ticking the net driver) */
+	std::atomic<bool> bConnected;
+
+	/** Whether or not a connection failure has already been reported */
+	bool bConnectFailed;
+
+	/** The time (FPlatformTime::Seconds) at which Connect was kicked off */
+	double ConnectStartTime;
+
+	/** The time (in seconds) taken for the server to answer our hello */
+	double ConnectSeconds;
+
+	/** The time (in seconds) the last Tick spent in the net driver (written by the thread ticking the net driver) */
+	std::atomic<double> LastTickSeconds;
+
+	/** Decides when the net driver dispatches and flushes, and times both */
+	FMinimalClientTickScheduler TickScheduler;
+
+	/** Synthetic replicated actors spawned on the listen server */
+	FSyntheticActorScenario ActorScenario;
+
+	/** Actor channel traffic received, per actor class name, guarded by ActorClassStatsLock */
+	TMap<FName, FActorClassNetStats> ActorClassStats;
+
+	mutable FCriticalSection ActorClassStatsLock;
+
+	/** Blocks replicated actors from spawning, set up from ActorFilterSettings */
+	FMinimalClientActorFilter ActorFilter;
+
+	/** NetGUID/name serialization cost of every package map, guarded by PackageMapProfilerLock */
+	FPackageMapProfiler PackageMapProfiler;
+
+	mutable FCriticalSection PackageMapProfilerLock;
+
+	/** The interval (in seconds) between automatic pings, or 0 if disabled */
+	float PingInterval;
+
+	/** The time (in seconds) since the last automatic ping */
+	float TimeSinceLastPing;
+
+	/** The thread ticking the net driver, or nullptr when ticking on the game thread */
+	FMinimalClientNetThread* NetThread;
+
+	/** The tick rate the net thread was last started with */
+	float NetThreadRate;
+
+	/**
+	 * Held by the net thread for the whole of each tick, and by the game thread while reading state the net driver
+	 * updates (connections, histograms, report counters) or changing settings the net thread reads, so that neither
+	 * side ever sees the other half done (recursive, and uncontended when ticking on the game thread)
+	 */
+	mutable FCriticalSection NetTickLock;
+
+	/** Commands queued by the game thread, for the net thread */
+	TQueue<FMinimalClientNetCommand, EQueueMode::Mpsc> NetCommands;
+
+	/** Events queued by the net thread, for the game thread */
+	TQueue<FMinimalClientNetEvent, EQueueMode::Spsc> NetEvents;
+
+	/** Savings from serialize-once broadcasting */
+	FBroadcastStats BroadcastStats;
+
+	/** Whether or not sent text is coalesced into batches */
+	bool bBatchSends;
+
+	/** The longest time (in seconds) batched text waits before being sent */
+	float BatchWindowSeconds;
+
+	/** The size (in bytes) at which a pending batch is sent immediately */
+	int32 BatchByteBudget;
+
+	/** Serialized text waiting to be sent as a batch */
+	FBitWriter PendingBatch;
+
+	/** The number of messages in PendingBatch */
+	int32 NumBatchedMessages;
+
+	/** The time (FPlatformTime::Seconds) at which the first message of PendingBatch was queued */
+	double BatchStartTime;
+
+	/** Send counters without [0] and with [1] batching */
+	FSendBatchStats SendBatchStats[2];
+
+	/** The format text is sent in */
+	EChatWireFormat ChatWireFormat;
+
+	/** Per-message size of the chat traffic, in both formats */
+	FChatWireStats ChatWireStats;
+
+	/** How chat payloads are compressed */
+	FChatCompressionSettings CompressionSettings;
+
+	/** Compression counters of every payload sent */
+	FChatCompressionStats CompressionStats;
+
+	/** Reusable writer of the chat payloads sent (see ResetPayloadWriter) */
+	FBitWriter PayloadWriter;
+
+	/** Reusable compressed payload and compression buffer */
+	FBitWriter CompressedPayload;
+	TArray<uint8> CompressionScratch;
+
+	/** Blobs being streamed, pumped on the thread ticking the net driver */
+	FBlobSender BlobSender;
+
+	/** The id of the next blob sent (assigned on the game thread) */
+	uint32 NextBlobId;
+
+	/** The network condition profile applied to every connection */
+	FName NetConditionProfile;
+
+	/** Time-series export of connection stats */
+	FNetStatsRecorder StatsRecorder;
+
+	/** The interval (in seconds) between live snapshots, or 0 if disabled */
+	float LiveSampleInterval;
+
+	/** The time (FPlatformTime::Seconds) the next live snapshot is due */
+	double NextLiveSampleTime;
+
+	/** The latest live snapshot, guarded by LiveSamplesLock */
+	TArray<FNetConnectionSample> LiveSamples;
+
+	/** The snapshot being filled, swapped with LiveSamples once complete */
+	TArray<FNetConnectionSample> LiveSamplesScratch;
+
+	mutable FCriticalSection LiveSamplesLock;
+
+	/** How Cleanup reclaims destroyed net drivers/worlds */
+	static FMinimalClientCleanupSettings CleanupSettings;
+
+	/** Cleanups since the last GC request, when batching */
+	static int32 NumUncollectedCleanups;
+
+	/** Whether or not new sessions use the shared world */
+	static bool bSharedWorldMode;
+
+	/** The world shared by minimal clients in shared world mode (kept alive by its world context) */
+	static UWorld* SharedWorld;
+
+	static int32 NumSharedWorldUsers;
+
+	/** The actor filter of every minimal client */
+	static FMinimalClientActorFilterSettings ActorFilterSettings;
+
+	/** The classes matched by ActorFilterSettings, built once and shared by every minimal client's ActorFilter */
+	static TSharedPtr<const FMinimalClientActorFilterClasses, ESPMode::ThreadSafe> ActorFilterClasses;
+
+	/** Prunes garbage collected classes from the actor filters, while a filter is set */
+	static FDelegateHandle ActorFilterGCHandle;
 };
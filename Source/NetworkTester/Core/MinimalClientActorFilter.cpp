@@ -0,0 +1,164 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+//
+
+#include "MinimalClientActorFilter.h"
+
+#include "GameFramework/Actor.h"
+#include "UObject/UObjectHash.h"
+
+
+FString FMinimalClientActorFilterSettings::ToString() const
+{
+	FString ReturnVal = Mode == EMinimalClientActorFilterMode::Allow ? TEXT("Allow") :
+		(Mode == EMinimalClientActorFilterMode::Deny ? TEXT("Deny") : TEXT("Off"));
+
+	for (int32 ClassIdx = 0; ClassIdx < Classes.Num() && Mode != EMinimalClientActorFilterMode::Disabled; ClassIdx++)
+	{
+		ReturnVal += ClassIdx == 0 ? TEXT(" ") : TEXT(", ");
+		ReturnVal += !Classes[ClassIdx].IsNull() ? Classes[ClassIdx].GetAssetName() : FString(TEXT("None"));
+	}
+
+	return ReturnVal;
+}
+
+TSharedRef<const FMinimalClientActorFilterClasses, ESPMode::ThreadSafe> FMinimalClientActorFilterClasses::Build(
+	const FMinimalClientActorFilterSettings& InSettings)
+{
+	TSharedRef<FMinimalClientActorFilterClasses, ESPMode::ThreadSafe> ReturnVal = MakeShared<FMinimalClientActorFilterClasses, ESPMode::ThreadSafe>();
+
+	if (InSettings.Mode != EMinimalClientActorFilterMode::Disabled)
+	{
+		TArray<UClass*> DerivedClasses;
+
+		for (const TSoftClassPtr<AActor>& CurSoftClass : InSettings.Classes)
+		{
+			UClass* CurClass = CurSoftClass.Get();
+
+			if (CurClass == nullptr)
+			{
+				continue;
+			}
+
+			ReturnVal->ListedClasses.Add(CurClass);
+			ReturnVal->MatchedClasses.Add(CurClass);
+
+			DerivedClasses.Reset();
+			GetDerivedClasses(CurClass, DerivedClasses, true);
+
+			for (UClass* CurDerived : DerivedClasses)
+			{
+				ReturnVal->MatchedClasses.Add(CurDerived);
+			}
+		}
+	}
+
+	return ReturnVal;
+}
+
+TSharedPtr<const FMinimalClientActorFilterClasses, ESPMode::ThreadSafe> FMinimalClientActorFilterClasses::Prune() const
+{
+	TSharedPtr<FMinimalClientActorFilterClasses, ESPMode::ThreadSafe> ReturnVal;
+
+	for (const TObjectKey<UClass>& CurKey : MatchedClasses)
+	{
+		if (CurKey.ResolveObjectPtr() == nullptr)
+		{
+			ReturnVal = MakeShared<FMinimalClientActorFilterClasses, ESPMode::ThreadSafe>(*this);
+			break;
+		}
+	}
+
+	if (ReturnVal.IsValid())
+	{
+		ReturnVal->ListedClasses.RemoveAll([](const TWeakObjectPtr<UClass>& CurClass) { return !CurClass.IsValid(); });
+
+		for (TSet<TObjectKey<UClass>>::TIterator It(ReturnVal->MatchedClasses); It; ++It)
+		{
+			if (It->ResolveObjectPtr() == nullptr)
+			{
+				It.RemoveCurrent();
+			}
+		}
+	}
+
+	return ReturnVal;
+}
+
+void FMinimalClientActorFilter::SetSettings(const FMinimalClientActorFilterSettings& InSettings,
+	const TSharedPtr<const FMinimalClientActorFilterClasses, ESPMode::ThreadSafe>& InClasses)
+{
+	Settings = InSettings;
+	Settings.Classes.RemoveAll([](const TSoftClassPtr<AActor>& CurClass) { return CurClass.IsNull(); });
+
+	Classes = InClasses;
+
+	LateMatchedClasses.Reset();
+	UnmatchedClasses.Reset();
+}
+
+void FMinimalClientActorFilter::PruneFreedClasses(const TSharedPtr<const FMinimalClientActorFilterClasses, ESPMode::ThreadSafe>& InClasses)
+{
+	Classes = InClasses;
+
+	for (TSet<TObjectKey<UClass>>* CurSet : { &LateMatchedClasses, &UnmatchedClasses })
+	{
+		for (TSet<TObjectKey<UClass>>::TIterator It(*CurSet); It; ++It)
+		{
+			if (It->ResolveObjectPtr() == nullptr)
+			{
+				It.RemoveCurrent();
+			}
+		}
+	}
+}
+
+bool FMinimalClientActorFilter::ShouldBlock(UClass* ActorClass)
+{
+	bool bReturnVal = false;
+
+	if (IsActive() && ActorClass != nullptr && Classes.IsValid())
+	{
+		const TObjectKey<UClass> ClassKey(ActorClass);
+		bool bMatched = Classes->MatchedClasses.Contains(ClassKey) || LateMatchedClasses.Contains(ClassKey);
+
+		if (!bMatched && !UnmatchedClasses.Contains(ClassKey))
+		{
+			for (const TWeakObjectPtr<UClass>& CurClass : Classes->ListedClasses)
+			{
+				if (CurClass.IsValid() && ActorClass->IsChildOf(CurClass.Get()))
+				{
+					bMatched = true;
+					break;
+				}
+			}
+
+			(bMatched ? LateMatchedClasses : UnmatchedClasses).Add(ClassKey);
+		}
+
+		bReturnVal = Settings.Mode == EMinimalClientActorFilterMode::Allow ? !bMatched : bMatched;
+	}
+
+	return bReturnVal;
+}
+
+uint64 FMinimalClientActorFilter::EstimateActorBytes(UClass* ActorClass)
+{
+	uint64 ReturnVal = 0;
+	AActor* DefaultActor = ActorClass != nullptr ? Cast<AActor>(ActorClass->GetDefaultObject()) : nullptr;
+
+	if (DefaultActor != nullptr)
+	{
+		TArray<UObject*> Subobjects;
+
+		DefaultActor->GetDefaultSubobjects(Subobjects);
+
+		ReturnVal = (uint64)ActorClass->GetStructureSize();
+
+		for (UObject* CurSubobject : Subobjects)
+		{
+			ReturnVal += (uint64)CurSubobject->GetClass()->GetStructureSize();
+		}
+	}
+
+	return ReturnVal;
+}
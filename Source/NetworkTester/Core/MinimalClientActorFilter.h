@@ -0,0 +1,113 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+#include "UObject/SoftObjectPtr.h"
+
+
+class AActor;
+
+
+/** Which replicated actors a minimal client spawns */
+enum class EMinimalClientActorFilterMode : uint8
+{
+	/** Every actor is spawned */
+	Disabled,
+
+	/** Only actors of the listed classes (or their subclasses) are spawned */
+	Allow,
+
+	/** Actors of the listed classes (or their subclasses) are blocked */
+	Deny
+};
+
+
+/** The actor spawn filter of a minimal client */
+struct FMinimalClientActorFilterSettings
+{
+	EMinimalClientActorFilterMode Mode = EMinimalClientActorFilterMode::Disabled;
+
+	/** The listed classes (soft, so that the settings never keep a class from being unloaded) */
+	TArray<TSoftClassPtr<AActor>> Classes;
+
+	/** @return The filter as "<Mode> <Class>, <Class>..." */
+	FString ToString() const;
+};
+
+
+/**
+ * The classes matching the listed classes of an actor filter: the listed classes and all their currently loaded subclasses.
+ * Built once per filter change and shared read-only by every minimal client, as walking the class tree per bot is costly.
+ * Classes are held weakly, so they are free to be garbage collected.
+ */
+struct NETWORKTESTER_API FMinimalClientActorFilterClasses
+{
+	/** The listed classes which are loaded */
+	TArray<TWeakObjectPtr<UClass>> ListedClasses;
+
+	/** The listed classes and their subclasses */
+	TSet<TObjectKey<UClass>> MatchedClasses;
+
+	/** @return The matched classes of the specified filter */
+	static TSharedRef<const FMinimalClientActorFilterClasses, ESPMode::ThreadSafe> Build(const FMinimalClientActorFilterSettings& InSettings);
+
+	/** @return A copy without the classes which were garbage collected, or nullptr if none were */
+	TSharedPtr<const FMinimalClientActorFilterClasses, ESPMode::ThreadSafe> Prune() const;
+};
+
+
+/**
+ * Decides which replicated actors a minimal client blocks from spawning.
+ *
+ * The shared precomputed set (see FMinimalClientActorFilterClasses) makes most lookups a single hash lookup; classes loaded
+ * later (e.g. blueprints, as their NetGUIDs are resolved) are matched against the listed classes once, and cached per filter.
+ * Only used by the thread ticking the net driver.
+ */
+class NETWORKTESTER_API FMinimalClientActorFilter
+{
+public:
+	/**
+	 * Sets up the filter
+	 *
+	 * @param InSettings	The filter settings
+	 * @param InClasses		The matched classes built from InSettings (FMinimalClientActorFilterClasses::Build)
+	 */
+	void SetSettings(const FMinimalClientActorFilterSettings& InSettings,
+		const TSharedPtr<const FMinimalClientActorFilterClasses, ESPMode::ThreadSafe>& InClasses);
+
+	/**
+	 * Drops the cached classes which were garbage collected
+	 *
+	 * @param InClasses		The pruned shared matched classes, replacing the current ones
+	 */
+	void PruneFreedClasses(const TSharedPtr<const FMinimalClientActorFilterClasses, ESPMode::ThreadSafe>& InClasses);
+
+	const FMinimalClientActorFilterSettings& GetSettings() const
+	{
+		return Settings;
+	}
+
+	bool IsActive() const
+	{
+		return Settings.Mode != EMinimalClientActorFilterMode::Disabled;
+	}
+
+	/** @return Whether or not an actor of the specified class should be blocked from spawning */
+	bool ShouldBlock(UClass* ActorClass);
+
+	/** @return A lower bound of the memory an actor of the specified class takes (the actor and its default subobjects) */
+	static uint64 EstimateActorBytes(UClass* ActorClass);
+
+private:
+	FMinimalClientActorFilterSettings Settings;
+
+	/** The matched classes shared by every minimal client */
+	TSharedPtr<const FMinimalClientActorFilterClasses, ESPMode::ThreadSafe> Classes;
+
+	/** Classes loaded after the shared set was built, found to match/not match the listed classes */
+	TSet<TObjectKey<UClass>> LateMatchedClasses;
+	TSet<TObjectKey<UClass>> UnmatchedClasses;
+};
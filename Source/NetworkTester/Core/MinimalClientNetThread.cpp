@@ -0,0 +1,79 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+//
+
+#include "MinimalClientNetThread.h"
+
+#include "HAL/RunnableThread.h"
+#include "UObject/GarbageCollection.h"
+#include "MinimalClient.h"
+
+
+FMinimalClientNetThread::FMinimalClientNetThread(UMinimalClient* InOwner, float InTickRate)
+	: Owner(InOwner)
+	, TickInterval(1.0 / FMath::Max(InTickRate, 1.f))
+	, bStopRequested(false)
+	, Thread(nullptr)
+{
+	Thread = FRunnableThread::Create(this, TEXT("MinimalClientNetThread"), 0, TPri_AboveNormal);
+}
+
+FMinimalClientNetThread::~FMinimalClientNetThread()
+{
+	if (Thread != nullptr)
+	{
+		Thread->Kill(true);
+		delete Thread;
+		Thread = nullptr;
+	}
+}
+
+uint32 FMinimalClientNetThread::Run()
+{
+	double LastTickTime = FPlatformTime::Seconds();
+	double NextTickTime = LastTickTime;
+
+	while (!bStopRequested)
+	{
+		const double CurTime = FPlatformTime::Seconds();
+
+		if (CurTime >= NextTickTime)
+		{
+			{
+				// Keep garbage collection from running on the game thread, while net objects are being touched here
+				FGCScopeGuard GCGuard;
+
+				Owner->TickNetThread((float)(CurTime - LastTickTime));
+			}
+
+			LastTickTime = CurTime;
+			NextTickTime += TickInterval;
+
+			// Don't try to catch up after a stall, just resume the fixed rate from now
+			if (NextTickTime < CurTime)
+			{
+				NextTickTime = CurTime + TickInterval;
+			}
+		}
+		else
+		{
+			const double Remaining = NextTickTime - CurTime;
+
+			// Sleep granularity is too coarse for sub-millisecond rates, so yield for the last millisecond
+			if (Remaining > 0.002)
+			{
+				FPlatformProcess::SleepNoStats((float)(Remaining - 0.001));
+			}
+			else
+			{
+				FPlatformProcess::YieldThread();
+			}
+		}
+	}
+
+	return 0;
+}
+
+void FMinimalClientNetThread::Stop()
+{
+	bStopRequested = true;
+}
@@ -0,0 +1,49 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "HAL/ThreadSafeBool.h"
+
+
+class FRunnableThread;
+class UMinimalClient;
+
+
+/**
+ * Ticks the net driver of a minimal client at a fixed rate, independent of the editor frame rate.
+ * Communication with the game thread goes through the minimal client's NetCommands/NetEvents queues.
+ */
+class FMinimalClientNetThread : public FRunnable
+{
+public:
+	/**
+	 * Starts the thread
+	 *
+	 * @param InOwner		The minimal client whose net driver is ticked
+	 * @param InTickRate	The number of ticks per second
+	 */
+	FMinimalClientNetThread(UMinimalClient* InOwner, float InTickRate);
+
+	/** Stops the thread, and waits for it to exit */
+	virtual ~FMinimalClientNetThread();
+
+	// FRunnable
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+private:
+	/** The minimal client being ticked */
+	UMinimalClient* Owner;
+
+	/** The time (in seconds) between ticks */
+	double TickInterval;
+
+	/** Whether or not the thread has been asked to exit */
+	FThreadSafeBool bStopRequested;
+
+	/** The running thread */
+	FRunnableThread* Thread;
+};
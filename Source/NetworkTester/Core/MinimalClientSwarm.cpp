@@ -0,0 +1,466 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+//
+
+#include "MinimalClientSwarm.h"
+
+#include "Engine/Engine.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformMemory.h"
+#include "UObject/UObjectArray.h"
+#include "UObject/UObjectGlobals.h"
+#include "UObject/UObjectIterator.h"
+#include "MinimalClient.h"
+
+
+UMinimalClientSwarm::UMinimalClientSwarm(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+	, bRunning(false)
+	, RampAccumulator(0.0)
+	, NumSucceeded(0)
+	, NumFailed(0)
+	, NumReconnects(0)
+	, NumReconnectFailures(0)
+	, NumServerTickSamples(0)
+	, TotalServerTickSeconds(0.0)
+	, MaxServerTickSeconds(0.0)
+	, LastBotsTickSeconds(0.0)
+	, bRecycling(false)
+	, NumSoakCycles(0)
+	, TotalCleanupSeconds(0.0)
+	, MaxCleanupSeconds(0.0)
+	, StartUsedPhysical(0)
+	, StartNumObjects(0)
+	, StartNumWorldContexts(0)
+	, SoakStartTime(0.0)
+	, SoakStartUsedPhysical(0)
+	, SoakStartNumObjects(0)
+	, NumGarbageCollections(0)
+{
+}
+
+void UMinimalClientSwarm::Start(const FMinimalClientSwarmConfig& InConfig)
+{
+	if (bRunning)
+	{
+		Stop();
+	}
+
+	Config = InConfig;
+	Config.NumBots = FMath::Max(Config.NumBots, 0);
+	Config.RampRate = FMath::Max(Config.RampRate, 0.001f);
+	Config.SoakHoldSeconds = FMath::Max(Config.SoakHoldSeconds, 0.f);
+
+	Bots.Reset(Config.NumBots);
+	ConnectTimes.Reset();
+	ReconnectTimes.Reset();
+	BotRecycleTimes.Reset(Config.NumBots);
+	BotsFirstAttemptDone.Empty(Config.NumBots);
+
+	RampAccumulator = 0.0;
+	NumSucceeded = 0;
+	NumFailed = 0;
+	NumReconnects = 0;
+	NumReconnectFailures = 0;
+	NumServerTickSamples = 0;
+	TotalServerTickSeconds = 0.0;
+	MaxServerTickSeconds = 0.0;
+	LastBotsTickSeconds = 0.0;
+	NumSoakCycles = 0;
+	TotalCleanupSeconds = 0.0;
+	MaxCleanupSeconds = 0.0;
+	NumGarbageCollections = 0;
+
+	// Baseline for the footprint report, taken before any bot exists
+	StartUsedPhysical = FPlatformMemory::GetStats().UsedPhysical;
+	StartNumObjects = GUObjectArray.GetObjectArrayNumMinusAvailable();
+	StartNumWorldContexts = GEngine != nullptr ? GEngine->GetWorldContexts().Num() : 0;
+
+	SoakStartTime = FPlatformTime::Seconds();
+	SoakStartUsedPhysical = StartUsedPhysical;
+	SoakStartNumObjects = StartNumObjects;
+
+	PostGarbageCollectHandle = FCoreUObjectDelegates::GetPostGarbageCollect().AddUObject(this, &UMinimalClientSwarm::OnPostGarbageCollect);
+
+	// If the target server lives in this process, measure its tick cost too
+	LocalServer = nullptr;
+
+	for (TObjectIterator<UMinimalClient> It; It; ++It)
+	{
+		if (It->IsListening())
+		{
+			LocalServer = *It;
+			break;
+		}
+	}
+
+	bRunning = true;
+
+	UE_LOG(LogNetworkTester, Log, TEXT("Swarm: starting %i bots against %s:%i at %.1f bots/sec"), Config.NumBots,
+		*Config.ServerAddr, Config.ServerPort, Config.RampRate);
+
+	if (Config.SoakHoldSeconds > 0.f)
+	{
+		UE_LOG(LogNetworkTester, Log, TEXT("Swarm: soaking, each bot reconnects every %.1f seconds"), Config.SoakHoldSeconds);
+	}
+}
+
+void UMinimalClientSwarm::Stop()
+{
+	for (UMinimalClient* CurBot : Bots)
+	{
+		if (CurBot != nullptr)
+		{
+			CurBot->ConnectedDel.Unbind();
+			CurBot->NetworkFailureDel.Unbind();
+			CurBot->Cleanup();
+		}
+	}
+
+	Bots.Empty();
+	BotRecycleTimes.Empty();
+	BotsFirstAttemptDone.Empty();
+	bRunning = false;
+
+	FCoreUObjectDelegates::GetPostGarbageCollect().Remove(PostGarbageCollectHandle);
+	PostGarbageCollectHandle.Reset();
+}
+
+void UMinimalClientSwarm::Tick(float DeltaTime)
+{
+	if (!bRunning)
+	{
+		return;
+	}
+
+	// Ramp up new bots
+	if (Bots.Num() < Config.NumBots)
+	{
+		RampAccumulator += (double)DeltaTime * Config.RampRate;
+
+		const int32 NumToSpawn = FMath::Min((int32)RampAccumulator, Config.NumBots - Bots.Num());
+
+		RampAccumulator -= NumToSpawn;
+
+		for (int32 i = 0; i < NumToSpawn; i++)
+		{
+			const int32 BotIndex = Bots.Num();
+			UMinimalClient* NewBot = NewObject<UMinimalClient>(this);
+
+			Bots.Add(NewBot);
+			BotRecycleTimes.Add(0.0);
+			BotsFirstAttemptDone.Add(false);
+
+			if (Config.NetConditionProfiles.Num() > 0)
+			{
+				NewBot->SetNetConditionProfile(Config.NetConditionProfiles[BotIndex % Config.NetConditionProfiles.Num()]);
+			}
+
+			NewBot->ConnectedDel.BindUObject(this, &UMinimalClientSwarm::OnBotConnected, BotIndex);
+			NewBot->NetworkFailureDel.BindUObject(this, &UMinimalClientSwarm::OnBotNetworkFailure, BotIndex);
+
+			if (!NewBot->Connect(Config.ServerAddr, Config.ServerPort))
+			{
+				OnBotConnectFailed(BotIndex, Config.SoakHoldSeconds);
+			}
+		}
+
+		// Soak growth and cycle rate are measured from the end of ramp-up, so they exclude the bots' own footprint
+		if (Bots.Num() == Config.NumBots)
+		{
+			SoakStartTime = FPlatformTime::Seconds();
+			SoakStartUsedPhysical = FPlatformMemory::GetStats().UsedPhysical;
+			SoakStartNumObjects = GUObjectArray.GetObjectArrayNumMinusAvailable();
+
+			NumSoakCycles = 0;
+			TotalCleanupSeconds = 0.0;
+			MaxCleanupSeconds = 0.0;
+			NumGarbageCollections = 0;
+		}
+	}
+
+	if (Config.SoakHoldSeconds > 0.f)
+	{
+		RecycleBots(FPlatformTime::Seconds());
+	}
+
+	LastBotsTickSeconds = 0.0;
+
+	for (const UMinimalClient* CurBot : Bots)
+	{
+		LastBotsTickSeconds += CurBot->GetLastTickSeconds();
+	}
+
+	// Only sample the server once every bot has been kicked off, to measure the steady state
+	if (Bots.Num() == Config.NumBots && LocalServer.IsValid())
+	{
+		const double ServerTickSeconds = LocalServer->GetLastTickSeconds();
+
+		NumServerTickSamples++;
+		TotalServerTickSeconds += ServerTickSeconds;
+		MaxServerTickSeconds = FMath::Max(MaxServerTickSeconds, ServerTickSeconds);
+	}
+}
+
+TStatId UMinimalClientSwarm::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UMinimalClientSwarm, STATGROUP_Tickables);
+}
+
+void UMinimalClientSwarm::OnBotConnected(int32 BotIndex)
+{
+	if (Bots.IsValidIndex(BotIndex))
+	{
+		const uint64 ConnectMicros = (uint64)(Bots[BotIndex]->GetConnectSeconds() * 1000000.0);
+
+		// Soak reconnects are kept apart, so they don't inflate the connection count or skew first-connect times
+		if (BotsFirstAttemptDone[BotIndex])
+		{
+			NumReconnects++;
+			ReconnectTimes.AddSample(ConnectMicros);
+		}
+		else
+		{
+			BotsFirstAttemptDone[BotIndex] = true;
+			NumSucceeded++;
+			ConnectTimes.AddSample(ConnectMicros);
+		}
+
+		ScheduleRecycle(BotIndex, Config.SoakHoldSeconds);
+	}
+}
+
+void UMinimalClientSwarm::OnBotNetworkFailure(ENetworkFailure::Type FailureType, const FString& ErrorString, int32 BotIndex)
+{
+	if (!bRecycling)
+	{
+		// Retry straight away - a reconnect storm is what soaking is meant to reproduce
+		OnBotConnectFailed(BotIndex, 0.0);
+	}
+}
+
+void UMinimalClientSwarm::OnBotConnectFailed(int32 BotIndex, double RetryDelay)
+{
+	if (Bots.IsValidIndex(BotIndex))
+	{
+		if (BotsFirstAttemptDone[BotIndex])
+		{
+			NumReconnectFailures++;
+		}
+		else
+		{
+			BotsFirstAttemptDone[BotIndex] = true;
+			NumFailed++;
+		}
+
+		ScheduleRecycle(BotIndex, RetryDelay);
+	}
+}
+
+void UMinimalClientSwarm::ScheduleRecycle(int32 BotIndex, double Delay)
+{
+	if (Config.SoakHoldSeconds > 0.f && BotRecycleTimes.IsValidIndex(BotIndex))
+	{
+		BotRecycleTimes[BotIndex] = FPlatformTime::Seconds() + Delay;
+	}
+}
+
+void UMinimalClientSwarm::RecycleBots(double CurTime)
+{
+	// Bots are only recycled from here, never from their own delegates, as those fire while the bot is ticking
+	TGuardValue<bool> RecyclingGuard(bRecycling, true);
+
+	for (int32 BotIndex = 0; BotIndex < Bots.Num(); BotIndex++)
+	{
+		UMinimalClient* CurBot = Bots[BotIndex];
+
+		if (CurBot != nullptr && BotRecycleTimes[BotIndex] > 0.0 && CurTime >= BotRecycleTimes[BotIndex])
+		{
+			BotRecycleTimes[BotIndex] = 0.0;
+
+			const double CleanupStartTime = FPlatformTime::Seconds();
+
+			CurBot->Cleanup();
+
+			const double CleanupSeconds = FPlatformTime::Seconds() - CleanupStartTime;
+
+			NumSoakCycles++;
+			TotalCleanupSeconds += CleanupSeconds;
+			MaxCleanupSeconds = FMath::Max(MaxCleanupSeconds, CleanupSeconds);
+
+			// A bot which can't even start connecting raises no failure, so retry it after another hold, rather than losing it
+			if (!CurBot->Connect(Config.ServerAddr, Config.ServerPort))
+			{
+				OnBotConnectFailed(BotIndex, Config.SoakHoldSeconds);
+			}
+		}
+	}
+}
+
+void UMinimalClientSwarm::OnPostGarbageCollect()
+{
+	NumGarbageCollections++;
+}
+
+void UMinimalClientSwarm::LogReport() const
+{
+	UE_LOG(LogNetworkTester, Log, TEXT("Swarm: %i/%i bots kicked off, %i connected, %i failed, %i pending"), Bots.Num(),
+		Config.NumBots, NumSucceeded, NumFailed, Bots.Num() - NumSucceeded - NumFailed);
+
+	UE_LOG(LogNetworkTester, Log, TEXT("Swarm: connect time %s"), *ConnectTimes.ToString());
+
+	UE_LOG(LogNetworkTester, Log, TEXT("Swarm: bots net driver tick: %.3f ms/frame"), LastBotsTickSeconds * 1000.0);
+
+	FNetLatencyHistogram RttHistogram;
+
+	for (const UMinimalClient* CurBot : Bots)
+	{
+		RttHistogram.Merge(CurBot->GetAggregateRttHistogram());
+	}
+
+	UE_LOG(LogNetworkTester, Log, TEXT("Swarm: RTT %s"), *RttHistogram.ToString());
+
+	if (NumServerTickSamples > 0)
+	{
+		UE_LOG(LogNetworkTester, Log, TEXT("Swarm: steady-state server tick ms avg: %.3f max: %.3f (%i samples)"),
+			TotalServerTickSeconds / NumServerTickSamples * 1000.0, MaxServerTickSeconds * 1000.0, NumServerTickSamples);
+	}
+	else
+	{
+		UE_LOG(LogNetworkTester, Log, TEXT("Swarm: no in-process listen server, or ramp-up not finished - server tick cost not sampled"));
+	}
+
+	const uint64 UsedPhysical = FPlatformMemory::GetStats().UsedPhysical;
+	const int32 NumObjects = GUObjectArray.GetObjectArrayNumMinusAvailable();
+
+	if (Bots.Num() > 0)
+	{
+		const double MemoryGrowthMB = ((double)UsedPhysical - (double)StartUsedPhysical) / (1024.0 * 1024.0);
+		const int32 ObjectGrowth = NumObjects - StartNumObjects;
+		const int32 WorldContextGrowth = (GEngine != nullptr ? GEngine->GetWorldContexts().Num() : 0) - StartNumWorldContexts;
+
+		UE_LOG(LogNetworkTester, Log, TEXT("Swarm: per-bot footprint (%s): %.1f KB used physical, %.1f UObjects, %i world contexts for %i bots"),
+			UMinimalClient::IsSharedWorldMode() ? TEXT("shared world") : TEXT("world per bot"), MemoryGrowthMB * 1024.0 / Bots.Num(),
+			(double)ObjectGrowth / Bots.Num(), WorldContextGrowth, Bots.Num());
+	}
+
+	if (Config.SoakHoldSeconds > 0.f)
+	{
+		const double Elapsed = FMath::Max(FPlatformTime::Seconds() - SoakStartTime, 0.001);
+		const double MemoryGrowthMB = ((double)UsedPhysical - (double)SoakStartUsedPhysical) / (1024.0 * 1024.0);
+		const int32 ObjectGrowth = NumObjects - SoakStartNumObjects;
+
+		UE_LOG(LogNetworkTester, Log, TEXT("Swarm: soak %i reconnect cycles in %.1fs (%.1f/sec), cleanup ms avg: %.3f max: %.3f, %i GCs (%s)"),
+			NumSoakCycles, Elapsed, NumSoakCycles / Elapsed, NumSoakCycles > 0 ? TotalCleanupSeconds / NumSoakCycles * 1000.0 : 0.0,
+			MaxCleanupSeconds * 1000.0, NumGarbageCollections,
+			UMinimalClient::GetCleanupSettings().bImmediateGC ? TEXT("full purge per cleanup") : TEXT("batched"));
+
+		UE_LOG(LogNetworkTester, Log, TEXT("Swarm: soak %i reconnects, %i reconnect failures, reconnect time %s"), NumReconnects,
+			NumReconnectFailures, *ReconnectTimes.ToString());
+
+		UE_LOG(LogNetworkTester, Log, TEXT("Swarm: soak growth %+.2f MB used physical (%+.2f KB/cycle), %+i UObjects (%+.2f/cycle)"),
+			MemoryGrowthMB, NumSoakCycles > 0 ? MemoryGrowthMB * 1024.0 / NumSoakCycles : 0.0, ObjectGrowth,
+			NumSoakCycles > 0 ? (double)ObjectGrowth / NumSoakCycles : 0.0);
+	}
+}
+
+
+// Console commands
+
+static UMinimalClientSwarm* GSwarm = nullptr;
+
+/** Parses the <Addr> <Port> <NumBots> <BotsPerSecond> arguments shared by the swarm start commands */
+static FMinimalClientSwarmConfig ParseSwarmConfig(const TArray<FString>& Args)
+{
+	FMinimalClientSwarmConfig ReturnVal;
+
+	if (Args.Num() > 0)
+	{
+		ReturnVal.ServerAddr = Args[0];
+	}
+
+	if (Args.Num() > 1)
+	{
+		ReturnVal.ServerPort = (uint16)FCString::Atoi(*Args[1]);
+	}
+
+	if (Args.Num() > 2)
+	{
+		ReturnVal.NumBots = FCString::Atoi(*Args[2]);
+	}
+
+	if (Args.Num() > 3)
+	{
+		ReturnVal.RampRate = FCString::Atof(*Args[3]);
+	}
+
+	return ReturnVal;
+}
+
+static void StartSwarm(const FMinimalClientSwarmConfig& Config)
+{
+	if (GSwarm == nullptr)
+	{
+		GSwarm = NewObject<UMinimalClientSwarm>();
+		GSwarm->AddToRoot();
+	}
+
+	GSwarm->Start(Config);
+}
+
+static FAutoConsoleCommand SwarmStartCommand(
+	TEXT("NetTester.Swarm.Start"),
+	TEXT("Starts a minimal client swarm. Usage: NetTester.Swarm.Start <Addr> <Port> <NumBots> <BotsPerSecond> [Profile1,Profile2,...]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		FMinimalClientSwarmConfig Config = ParseSwarmConfig(Args);
+
+		if (Args.Num() > 4)
+		{
+			TArray<FString> ProfileNames;
+
+			Args[4].ParseIntoArray(ProfileNames, TEXT(","));
+
+			for (const FString& CurName : ProfileNames)
+			{
+				Config.NetConditionProfiles.Add(FName(*CurName));
+			}
+		}
+
+		StartSwarm(Config);
+	}));
+
+static FAutoConsoleCommand SwarmSoakCommand(
+	TEXT("NetTester.Swarm.Soak"),
+	TEXT("Starts a minimal client swarm whose bots keep disconnecting and reconnecting, reporting per-cycle cost and memory growth. ")
+	TEXT("Usage: NetTester.Swarm.Soak <Addr> <Port> <NumBots> <BotsPerSecond> [HoldSeconds]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		FMinimalClientSwarmConfig Config = ParseSwarmConfig(Args);
+
+		Config.SoakHoldSeconds = Args.Num() > 4 ? FCString::Atof(*Args[4]) : 5.f;
+
+		StartSwarm(Config);
+	}));
+
+static FAutoConsoleCommand SwarmStopCommand(
+	TEXT("NetTester.Swarm.Stop"),
+	TEXT("Stops the minimal client swarm, and logs the final report."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		if (GSwarm != nullptr)
+		{
+			GSwarm->LogReport();
+			GSwarm->Stop();
+		}
+	}));
+
+static FAutoConsoleCommand SwarmReportCommand(
+	TEXT("NetTester.Swarm.Report"),
+	TEXT("Logs the current minimal client swarm report."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		if (GSwarm != nullptr)
+		{
+			GSwarm->LogReport();
+		}
+	}));
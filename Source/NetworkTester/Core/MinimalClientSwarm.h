@@ -0,0 +1,169 @@
+//
+// Headless swarm of minimal clients, for finding the connection ceiling of a server.
+//
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tickable.h"
+#include "NetLatencyHistogram.h"
+
+#include "MinimalClientSwarm.generated.h"
+
+
+class UMinimalClient;
+
+
+/** Settings for a swarm run */
+struct FMinimalClientSwarmConfig
+{
+	/** The server address the bots connect to */
+	FString ServerAddr;
+
+	/** The server port the bots connect to */
+	uint16 ServerPort;
+
+	/** The total number of bots to spawn */
+	int32 NumBots;
+
+	/** The number of bots kicked off per second */
+	float RampRate;
+
+	/** Network condition profiles assigned to the bots round-robin (empty leaves conditions untouched) */
+	TArray<FName> NetConditionProfiles;
+
+	/** Soak mode: the time (in seconds) each bot stays connected before disconnecting and reconnecting (0 stays connected) */
+	float SoakHoldSeconds;
+
+	FMinimalClientSwarmConfig()
+		: ServerAddr(TEXT("127.0.0.1"))
+		, ServerPort(7777)
+		, NumBots(100)
+		, RampRate(50.f)
+		, SoakHoldSeconds(0.f)
+	{
+	}
+};
+
+
+// Spawns and drives many UMinimalClient bots from one process, and reports connection statistics.
+UCLASS(transient)
+class NETWORKTESTER_API UMinimalClientSwarm : public UObject, public FTickableGameObject
+{
+	GENERATED_UCLASS_BODY()
+
+public:
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	virtual bool IsTickableInEditor() const override
+	{
+		return true;
+	}
+
+	virtual bool IsTickable() const override
+	{
+		return bRunning;
+	}
+
+	// Starts ramping up bots against the configured server
+	void Start(const FMinimalClientSwarmConfig& InConfig);
+
+	// Disconnects and cleans up all bots
+	void Stop();
+
+	bool IsRunning() const
+	{
+		return bRunning;
+	}
+
+	// Writes the current results to the log
+	void LogReport() const;
+
+protected:
+	void OnBotConnected(int32 BotIndex);
+
+	/** Counts a failed connect attempt of a bot, and reschedules it in soak mode */
+	void OnBotConnectFailed(int32 BotIndex, double RetryDelay);
+
+	void OnBotNetworkFailure(ENetworkFailure::Type FailureType, const FString& ErrorString, int32 BotIndex);
+
+	/** Soak mode: schedules a bot to be disconnected and reconnected, once its hold time is up */
+	void ScheduleRecycle(int32 BotIndex, double Delay);
+
+	/** Soak mode: disconnects and reconnects every bot which is due */
+	void RecycleBots(double CurTime);
+
+	void OnPostGarbageCollect();
+
+private:
+	/** The settings for the current run */
+	FMinimalClientSwarmConfig Config;
+
+	/** The spawned bots, in kickoff order */
+	UPROPERTY()
+	TArray<UMinimalClient*> Bots;
+
+	/** Connect times (in microseconds) of each bot's first connection */
+	FNetLatencyHistogram ConnectTimes;
+
+	/** Soak mode: connect times (in microseconds) of the reconnects which followed */
+	FNetLatencyHistogram ReconnectTimes;
+
+	/** Whether or not the swarm is currently running */
+	bool bRunning;
+
+	/** Fractional bots carried over between ticks, when ramping */
+	double RampAccumulator;
+
+	/** The number of bots whose first connect attempt succeeded */
+	int32 NumSucceeded;
+
+	/** The number of bots whose first connect attempt failed */
+	int32 NumFailed;
+
+	/** Soak mode: connect attempts after each bot's first, which succeeded/failed */
+	int32 NumReconnects;
+	int32 NumReconnectFailures;
+
+	/** Whether or not each bot's first connect attempt has finished, successfully or not */
+	TBitArray<> BotsFirstAttemptDone;
+
+	/** The in-process listen server being measured, if any */
+	TWeakObjectPtr<UMinimalClient> LocalServer;
+
+	/** Steady-state (after ramp-up) server tick samples */
+	int32 NumServerTickSamples;
+	double TotalServerTickSeconds;
+	double MaxServerTickSeconds;
+
+	/** Time (in seconds) all bots spent in their net drivers, during the last swarm tick */
+	double LastBotsTickSeconds;
+
+	/** Soak mode: the time (FPlatformTime::Seconds) each bot is next recycled, or 0 if not scheduled */
+	TArray<double> BotRecycleTimes;
+
+	/** Whether or not a bot is currently being recycled (failures it raises are not rescheduled) */
+	bool bRecycling;
+
+	/** Soak mode: completed disconnect/reconnect cycles since ramp-up finished, and the cost of their Cleanup calls */
+	int32 NumSoakCycles;
+	double TotalCleanupSeconds;
+	double MaxCleanupSeconds;
+
+	/** Process state before the first bot was spawned, for measuring per-bot footprint */
+	uint64 StartUsedPhysical;
+	int32 StartNumObjects;
+	int32 StartNumWorldContexts;
+
+	/** Soak mode: the time (FPlatformTime::Seconds) and process state when ramp-up finished, for measuring growth */
+	double SoakStartTime;
+	uint64 SoakStartUsedPhysical;
+	int32 SoakStartNumObjects;
+
+	/** The number of garbage collections since the swarm started */
+	int32 NumGarbageCollections;
+
+	FDelegateHandle PostGarbageCollectHandle;
+};
@@ -0,0 +1,129 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+//
+
+#include "MinimalClientTickScheduler.h"
+
+
+FMinimalClientTickScheduler::FMinimalClientTickScheduler()
+	: NextDispatchTime(0.0)
+	, NextFlushTime(0.0)
+	, LastDispatchTime(0.0)
+	, LastFlushTime(0.0)
+	, LastDispatchSeconds(0.0)
+	, LastFlushSeconds(0.0)
+	, StatsStartTime(FPlatformTime::Seconds())
+{
+}
+
+void FMinimalClientTickScheduler::SetSettings(const FMinimalClientTickSettings& InSettings)
+{
+	Settings = InSettings;
+	Settings.DispatchRate = FMath::Max(InSettings.DispatchRate, 0.f);
+	Settings.FlushRate = FMath::Max(InSettings.FlushRate, 0.f);
+
+	NextDispatchTime = 0.0;
+	NextFlushTime = 0.0;
+	PendingSteps.Reset();
+
+	ResetStats();
+}
+
+FMinimalClientTickWork FMinimalClientTickScheduler::Advance(double CurTime, float DeltaTime)
+{
+	FMinimalClientTickWork ReturnVal;
+
+	switch (Settings.Mode)
+	{
+	case EMinimalClientTickMode::Auto:
+		ReturnVal.bDispatch = IsDue(CurTime, Settings.DispatchRate, NextDispatchTime);
+		ReturnVal.bFlush = ReturnVal.bDispatch;
+		break;
+
+	case EMinimalClientTickMode::Step:
+		// One step per tick, so queued steps play out at the tick rate, rather than all at once
+		if (PendingSteps.GetValue() > 0)
+		{
+			PendingSteps.Decrement();
+
+			ReturnVal.bDispatch = true;
+			ReturnVal.bFlush = true;
+		}
+		break;
+
+	case EMinimalClientTickMode::Split:
+		ReturnVal.bDispatch = IsDue(CurTime, Settings.DispatchRate, NextDispatchTime);
+		ReturnVal.bFlush = IsDue(CurTime, Settings.FlushRate, NextFlushTime);
+		break;
+	}
+
+	if (ReturnVal.bDispatch)
+	{
+		ReturnVal.DispatchDeltaTime = LastDispatchTime > 0.0 ? (float)(CurTime - LastDispatchTime) : DeltaTime;
+		LastDispatchTime = CurTime;
+	}
+
+	if (ReturnVal.bFlush)
+	{
+		ReturnVal.FlushDeltaTime = LastFlushTime > 0.0 ? (float)(CurTime - LastFlushTime) : DeltaTime;
+		LastFlushTime = CurTime;
+	}
+
+	return ReturnVal;
+}
+
+bool FMinimalClientTickScheduler::IsDue(double CurTime, float Rate, double& NextTime)
+{
+	bool bReturnVal = true;
+
+	if (Rate > 0.f)
+	{
+		bReturnVal = CurTime >= NextTime;
+
+		if (bReturnVal)
+		{
+			const double Interval = 1.0 / Rate;
+
+			NextTime += Interval;
+
+			if (NextTime <= CurTime)
+			{
+				NextTime = CurTime + Interval;
+			}
+		}
+	}
+
+	return bReturnVal;
+}
+
+void FMinimalClientTickScheduler::RecordDispatch(double Seconds)
+{
+	LastDispatchSeconds = Seconds;
+	DispatchMicros.AddSample((uint64)(Seconds * 1000000.0));
+}
+
+void FMinimalClientTickScheduler::RecordFlush(double Seconds)
+{
+	LastFlushSeconds = Seconds;
+	FlushMicros.AddSample((uint64)(Seconds * 1000000.0));
+}
+
+void FMinimalClientTickScheduler::ResetStats()
+{
+	DispatchMicros.Reset();
+	FlushMicros.Reset();
+
+	StatsStartTime = FPlatformTime::Seconds();
+}
+
+FString FMinimalClientTickScheduler::ToString() const
+{
+	static const TCHAR* ModeNames[] = { TEXT("auto"), TEXT("step"), TEXT("split") };
+
+	const double Elapsed = FMath::Max(FPlatformTime::Seconds() - StatsStartTime, 0.001);
+
+	return FString::Printf(TEXT("mode %s (dispatch %.1f Hz, flush %.1f Hz requested), achieved dispatch %.1f Hz, flush %.1f Hz\n")
+		TEXT("  dispatch: %s\n  flush: %s"),
+		ModeNames[(int32)Settings.Mode], Settings.DispatchRate,
+		Settings.Mode == EMinimalClientTickMode::Split ? Settings.FlushRate : Settings.DispatchRate,
+		DispatchMicros.GetCount() / Elapsed, FlushMicros.GetCount() / Elapsed, *DispatchMicros.ToString(), *FlushMicros.ToString());
+}
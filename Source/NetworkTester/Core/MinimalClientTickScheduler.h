@@ -0,0 +1,136 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "NetLatencyHistogram.h"
+
+
+/** How the net driver of a minimal client is ticked */
+enum class EMinimalClientTickMode : uint8
+{
+	/** Dispatch and flush together, at DispatchRate (0 ticks every time the client is ticked) */
+	Auto,
+
+	/** Dispatch and flush together, once per Step call */
+	Step,
+
+	/** Dispatch at DispatchRate and flush at FlushRate, independently */
+	Split
+};
+
+
+/** The tick cadence of a minimal client */
+struct FMinimalClientTickSettings
+{
+	EMinimalClientTickMode Mode = EMinimalClientTickMode::Auto;
+
+	/** TickDispatch calls per second (0 is unlimited) */
+	float DispatchRate = 0.f;
+
+	/** TickFlush calls per second in Split mode (0 is unlimited) */
+	float FlushRate = 0.f;
+};
+
+
+/** What the net driver should do this tick */
+struct FMinimalClientTickWork
+{
+	bool bDispatch = false;
+	bool bFlush = false;
+
+	/** The time since the last dispatch/flush, passed as their DeltaTime */
+	float DispatchDeltaTime = 0.f;
+	float FlushDeltaTime = 0.f;
+};
+
+
+/**
+ * Decides when a minimal client's net driver dispatches and flushes, and records how long each took.
+ * Rates are kept without catching up: a late tick pushes the schedule back, rather than bunching up ticks.
+ */
+class NETWORKTESTER_API FMinimalClientTickScheduler
+{
+public:
+	FMinimalClientTickScheduler();
+
+	void SetSettings(const FMinimalClientTickSettings& InSettings);
+
+	const FMinimalClientTickSettings& GetSettings() const
+	{
+		return Settings;
+	}
+
+	/** @return Whether or not the net driver is flushed every time the client is ticked (Auto mode, unlimited rate) */
+	bool FlushesEveryTick() const
+	{
+		return Settings.Mode == EMinimalClientTickMode::Auto && Settings.DispatchRate <= 0.f;
+	}
+
+	/** Requests a single dispatch and flush, in Step mode (safe to call from any thread) */
+	void RequestStep()
+	{
+		PendingSteps.Increment();
+	}
+
+	/**
+	 * Works out whether the net driver is due to dispatch and/or flush
+	 *
+	 * @param CurTime		The current time (FPlatformTime::Seconds)
+	 * @param DeltaTime		The time since the client was last ticked, used as the DeltaTime of a first dispatch/flush
+	 * @return				The work due
+	 */
+	FMinimalClientTickWork Advance(double CurTime, float DeltaTime);
+
+	/** Records how long a TickDispatch (plus PostTickDispatch) took */
+	void RecordDispatch(double Seconds);
+
+	/** Records how long a TickFlush (plus PostTickFlush) took */
+	void RecordFlush(double Seconds);
+
+	void ResetStats();
+
+	/** @return A summary of the tick rates and timings */
+	FString ToString() const;
+
+	/** @return The duration (in seconds) of the last dispatch/flush */
+	double GetLastDispatchSeconds() const
+	{
+		return LastDispatchSeconds;
+	}
+
+	double GetLastFlushSeconds() const
+	{
+		return LastFlushSeconds;
+	}
+
+private:
+	/** @return Whether or not a rate limited action is due, updating its schedule */
+	static bool IsDue(double CurTime, float Rate, double& NextTime);
+
+private:
+	FMinimalClientTickSettings Settings;
+
+	/** Steps requested, and not yet taken */
+	FThreadSafeCounter PendingSteps;
+
+	/** The time each action is next due */
+	double NextDispatchTime;
+	double NextFlushTime;
+
+	/** The time each action last ran, for DeltaTime */
+	double LastDispatchTime;
+	double LastFlushTime;
+
+	/** Durations (in microseconds) of every dispatch/flush */
+	FNetLatencyHistogram DispatchMicros;
+	FNetLatencyHistogram FlushMicros;
+
+	double LastDispatchSeconds;
+	double LastFlushSeconds;
+
+	/** When stats were last reset, for measuring the achieved rates */
+	double StatsStartTime;
+};
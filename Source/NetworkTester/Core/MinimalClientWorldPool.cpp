@@ -0,0 +1,271 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+//
+
+#include "MinimalClientWorldPool.h"
+
+#include "Engine/Engine.h"
+#include "Engine/Level.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "MinimalClient.h"
+
+
+UMinimalClientWorldPool* UMinimalClientWorldPool::Singleton = nullptr;
+
+
+/** @return The number of live actors in a world's persistent level */
+static int32 CountWorldActors(UWorld* InWorld)
+{
+	int32 ReturnVal = 0;
+
+	if (InWorld->PersistentLevel != nullptr)
+	{
+		for (AActor* CurActor : InWorld->PersistentLevel->Actors)
+		{
+			if (CurActor != nullptr)
+			{
+				ReturnVal++;
+			}
+		}
+	}
+
+	return ReturnVal;
+}
+
+
+UMinimalClientWorldPool::UMinimalClientWorldPool(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+	, TargetSize(0)
+	, MaxPrewarmPerTick(4)
+	, NumFreshWorldActors(-1)
+	, NumHits(0)
+	, NumMisses(0)
+	, NumReused(0)
+	, NumDiscarded(0)
+	, TotalCheckoutSeconds(0.0)
+	, NumCreated(0)
+	, TotalCreateSeconds(0.0)
+{
+}
+
+UMinimalClientWorldPool* UMinimalClientWorldPool::Get()
+{
+	if (Singleton == nullptr)
+	{
+		Singleton = NewObject<UMinimalClientWorldPool>();
+		Singleton->AddToRoot();
+	}
+
+	return Singleton;
+}
+
+void UMinimalClientWorldPool::Tick(float DeltaTime)
+{
+	int32 NumBudget = MaxPrewarmPerTick;
+
+	// Returned worlds are cheaper to make ready than new ones
+	while (NumBudget > 0 && ReturnedWorlds.Num() > 0 && ReadyWorlds.Num() < TargetSize)
+	{
+		UWorld* CurWorld = ReturnedWorlds.Pop(false);
+		UNetDriver* NewDriver = IsValid(CurWorld) ? UMinimalClient::CreateNetDriver(CurWorld) : nullptr;
+
+		if (NewDriver != nullptr)
+		{
+			ReadyWorlds.Add(CurWorld);
+			ReadyNetDrivers.Add(NewDriver);
+			NumReused++;
+		}
+		else if (IsValid(CurWorld))
+		{
+			UMinimalClient::CleanupWorld(CurWorld);
+		}
+
+		NumBudget--;
+	}
+
+	while (NumBudget > 0 && ReadyWorlds.Num() < TargetSize && CreateReadyWorld())
+	{
+		NumBudget--;
+	}
+}
+
+TStatId UMinimalClientWorldPool::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UMinimalClientWorldPool, STATGROUP_Tickables);
+}
+
+void UMinimalClientWorldPool::SetTargetSize(int32 InTargetSize)
+{
+	TargetSize = FMath::Max(InTargetSize, 0);
+
+	// Shrink straight away, growing happens over the following ticks
+	while (ReadyWorlds.Num() > TargetSize)
+	{
+		UWorld* CurWorld = ReadyWorlds.Pop(false);
+		UNetDriver* CurDriver = ReadyNetDrivers.Pop(false);
+
+		if (IsValid(CurWorld))
+		{
+			if (IsValid(CurDriver))
+			{
+				GEngine->DestroyNamedNetDriver(CurWorld, CurDriver->NetDriverName);
+			}
+
+			UMinimalClient::CleanupWorld(CurWorld);
+		}
+	}
+
+	if (TargetSize == 0)
+	{
+		for (UWorld* CurWorld : ReturnedWorlds)
+		{
+			if (IsValid(CurWorld))
+			{
+				UMinimalClient::CleanupWorld(CurWorld);
+			}
+		}
+
+		ReturnedWorlds.Empty();
+	}
+}
+
+void UMinimalClientWorldPool::Prewarm()
+{
+	const int32 PrevMaxPrewarmPerTick = MaxPrewarmPerTick;
+
+	MaxPrewarmPerTick = MAX_int32;
+	Tick(0.f);
+	MaxPrewarmPerTick = PrevMaxPrewarmPerTick;
+}
+
+bool UMinimalClientWorldPool::Checkout(UWorld*& OutWorld, UNetDriver*& OutNetDriver)
+{
+	bool bReturnVal = false;
+	const double StartTime = FPlatformTime::Seconds();
+
+	while (ReadyWorlds.Num() > 0 && !bReturnVal)
+	{
+		UWorld* CurWorld = ReadyWorlds.Pop(false);
+		UNetDriver* CurDriver = ReadyNetDrivers.Pop(false);
+
+		// Something outside the pool (e.g. an engine world cleanup) may have destroyed these
+		if (IsValid(CurWorld) && IsValid(CurDriver))
+		{
+			OutWorld = CurWorld;
+			OutNetDriver = CurDriver;
+			bReturnVal = true;
+		}
+	}
+
+	if (bReturnVal)
+	{
+		NumHits++;
+		TotalCheckoutSeconds += FPlatformTime::Seconds() - StartTime;
+	}
+	else
+	{
+		NumMisses++;
+	}
+
+	return bReturnVal;
+}
+
+void UMinimalClientWorldPool::Return(UWorld* InWorld)
+{
+	if (!IsValid(InWorld))
+	{
+		return;
+	}
+
+	// The destroyed net driver is still referenced by the world and its level collection
+	InWorld->SetNetDriver(nullptr);
+
+	FLevelCollection* Collection = (FLevelCollection*)InWorld->GetActiveLevelCollection();
+
+	if (Collection != nullptr)
+	{
+		Collection->SetNetDriver(nullptr);
+	}
+
+	const bool bDirty = CountWorldActors(InWorld) > NumFreshWorldActors;
+
+	if (TargetSize > 0 && !bDirty && ReadyWorlds.Num() + ReturnedWorlds.Num() < TargetSize)
+	{
+		ReturnedWorlds.Add(InWorld);
+	}
+	else
+	{
+		NumDiscarded += bDirty ? 1 : 0;
+
+		UMinimalClient::CleanupWorld(InWorld);
+	}
+}
+
+bool UMinimalClientWorldPool::CreateReadyWorld()
+{
+	const double StartTime = FPlatformTime::Seconds();
+	UWorld* NewWorld = UMinimalClient::CreateWorld();
+	UNetDriver* NewDriver = NewWorld != nullptr ? UMinimalClient::CreateNetDriver(NewWorld) : nullptr;
+
+	if (NewDriver != nullptr)
+	{
+		if (NumFreshWorldActors < 0)
+		{
+			NumFreshWorldActors = CountWorldActors(NewWorld);
+		}
+
+		ReadyWorlds.Add(NewWorld);
+		ReadyNetDrivers.Add(NewDriver);
+
+		NumCreated++;
+		TotalCreateSeconds += FPlatformTime::Seconds() - StartTime;
+	}
+	else if (NewWorld != nullptr)
+	{
+		UE_LOG(LogNetworkTester, Warning, TEXT("WorldPool: failed to create a net driver, stopping prewarm"));
+
+		UMinimalClient::CleanupWorld(NewWorld);
+		TargetSize = ReadyWorlds.Num();
+	}
+
+	return NewDriver != nullptr;
+}
+
+void UMinimalClientWorldPool::LogReport() const
+{
+	const uint64 NumCheckouts = NumHits + NumMisses;
+
+	UE_LOG(LogNetworkTester, Log, TEXT("WorldPool: target %i, %i ready, %i returned, %llu checkouts (%.1f%% hits)"), TargetSize,
+		ReadyWorlds.Num(), ReturnedWorlds.Num(), NumCheckouts, NumCheckouts > 0 ? 100.0 * NumHits / NumCheckouts : 0.0);
+
+	UE_LOG(LogNetworkTester, Log, TEXT("WorldPool: checkout %.3f ms avg, cold world+net driver creation %.3f ms avg (%llu created), ")
+		TEXT("%llu worlds reused, %llu discarded (had actors)"),
+		NumHits > 0 ? TotalCheckoutSeconds / NumHits * 1000.0 : 0.0, NumCreated > 0 ? TotalCreateSeconds / NumCreated * 1000.0 : 0.0,
+		NumCreated, NumReused, NumDiscarded);
+}
+
+
+static FAutoConsoleCommand WorldPoolSizeCommand(
+	TEXT("NetTester.Pool.Size"),
+	TEXT("Sets the number of prewarmed worlds/net drivers minimal clients check out on Listen/Connect (0 disables pooling). ")
+	TEXT("Usage: NetTester.Pool.Size <Count> [now]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		UMinimalClientWorldPool* Pool = UMinimalClientWorldPool::Get();
+
+		Pool->SetTargetSize(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 0);
+
+		if (Args.Num() > 1 && Args[1] == TEXT("now"))
+		{
+			Pool->Prewarm();
+		}
+	}));
+
+static FAutoConsoleCommand WorldPoolReportCommand(
+	TEXT("NetTester.Pool.Report"),
+	TEXT("Logs the world pool hit rate, and checkout vs. cold creation times."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		UMinimalClientWorldPool::Get()->LogReport();
+	}));
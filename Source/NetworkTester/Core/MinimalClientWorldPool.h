@@ -0,0 +1,123 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tickable.h"
+
+#include "MinimalClientWorldPool.generated.h"
+
+
+class UNetDriver;
+class UWorld;
+
+
+/**
+ * Pool of prewarmed worlds, each with a created (but not yet initialized) net driver, for minimal clients to check out
+ * on Listen/Connect and hand back on Cleanup. This takes world/world context creation, net driver definition lookup and
+ * channel map patching off the connect path.
+ *
+ * Net drivers are never reused once a connection has gone through them - a returned world gets a fresh net driver
+ * while the pool ticks, and worlds which had actors spawned in them are destroyed rather than pooled.
+ */
+UCLASS(transient)
+class NETWORKTESTER_API UMinimalClientWorldPool : public UObject, public FTickableGameObject
+{
+	GENERATED_UCLASS_BODY()
+
+public:
+	/** @return The pool shared by every minimal client (created on first use) */
+	static UMinimalClientWorldPool* Get();
+
+	/** @return Whether or not minimal clients check worlds out of the pool, rather than creating their own */
+	static bool IsEnabled()
+	{
+		return Singleton != nullptr && Singleton->TargetSize > 0;
+	}
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	virtual bool IsTickableInEditor() const override
+	{
+		return true;
+	}
+
+	virtual bool IsTickable() const override
+	{
+		return TargetSize > 0;
+	}
+
+	/**
+	 * Sets the number of ready worlds the pool keeps, creating them up to MaxPrewarmPerTick at a time (0 disables pooling,
+	 * and destroys every idle world)
+	 *
+	 * @param InTargetSize	The number of ready worlds to keep
+	 */
+	void SetTargetSize(int32 InTargetSize);
+
+	/** Creates every missing ready world now, rather than over the following ticks */
+	void Prewarm();
+
+	/**
+	 * Checks out a ready world and its net driver
+	 *
+	 * @param OutWorld		Receives the world
+	 * @param OutNetDriver	Receives the world's net driver, which has not been initialized yet
+	 * @return				Whether or not a ready world was available (if not, the caller should create its own)
+	 */
+	bool Checkout(UWorld*& OutWorld, UNetDriver*& OutNetDriver);
+
+	/**
+	 * Hands back a checked out world, after its net driver has been destroyed
+	 *
+	 * @param InWorld	The world
+	 */
+	void Return(UWorld* InWorld);
+
+	// Writes the hit rate, and checkout/cold creation times, to the log
+	void LogReport() const;
+
+private:
+	/** Adds a new world and net driver to the ready list */
+	bool CreateReadyWorld();
+
+private:
+	static UMinimalClientWorldPool* Singleton;
+
+	/** The number of ready worlds to keep */
+	int32 TargetSize;
+
+	/** The most worlds/net drivers created per tick, when refilling */
+	int32 MaxPrewarmPerTick;
+
+	/** Worlds ready to be checked out, with their net drivers */
+	UPROPERTY()
+	TArray<UWorld*> ReadyWorlds;
+
+	UPROPERTY()
+	TArray<UNetDriver*> ReadyNetDrivers;
+
+	/** Returned worlds, waiting for a fresh net driver */
+	UPROPERTY()
+	TArray<UWorld*> ReturnedWorlds;
+
+	/** The number of actors in a freshly created world, for spotting worlds that can't be reused */
+	int32 NumFreshWorldActors;
+
+	/** Checkouts served from the pool, and those which found it empty */
+	uint64 NumHits;
+	uint64 NumMisses;
+
+	/** Worlds reused after being returned, and those destroyed because they had actors spawned in them */
+	uint64 NumReused;
+	uint64 NumDiscarded;
+
+	/** Time (in seconds) spent in Checkout */
+	double TotalCheckoutSeconds;
+
+	/** Time (in seconds) spent creating worlds and net drivers from scratch, while prewarming */
+	uint64 NumCreated;
+	double TotalCreateSeconds;
+};
@@ -4,9 +4,13 @@
 #include "Engine/Engine.h"
 #include "Engine/LocalPlayer.h"
 #include "Engine/NetConnection.h"
+#include "Engine/PackageMapClient.h"
+#include "Net/DataBunch.h"
 #include "GameFramework/PlayerController.h"
 
 #include "MinimalClient.h"
+#include "MyConnection.h"
+#include "NetworkTesterTrace.h"
 
 
 /**
@@ -15,12 +19,117 @@
 UMyActorChannel::UMyActorChannel(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 	, MinClient(nullptr)
+	, bBlockedActor(false)
 {
 }
 
 void UMyActorChannel::ReceivedBunch(FInBunch& Bunch)
 {
+	NETTESTER_TRACE_SCOPE(UMyActorChannel_ReceivedBunch);
+	TRACE_COUNTER_INCREMENT(NetTester_ReceivedBunches);
+
+	UMyConnection* MyConnection = Cast<UMyConnection>(Connection);
+	if (MyConnection)
+	{
+		MyConnection->NumReceivedBunches++;
+	}
+
+	const bool bHadActor = Actor != nullptr;
+	const int64 NumBits = Bunch.GetNumBits();
+
+	// The actor was blocked from spawning, so there is nothing to apply the bunch to (the packet carrying it is still acked)
+	if (bBlockedActor)
+	{
+		if (MinClient != nullptr)
+		{
+			MinClient->NotifyActorBunch(ActorClassName, NumBits, 0.0, false, true);
+		}
+
+		return;
+	}
+
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+
+	// The actor filter is consulted before Super spawns anything, and a blocked open bunch is dropped whole: the channel stays
+	// open without an actor. Failing the spawn within SerializeNewActor instead would break the channel (logging errors), and
+	// send the server NMT_ActorChannelFailure.
+	if (Bunch.bOpen && Actor == nullptr && MinClient != nullptr)
+	{
+		UClass* SpawnedActorClass = PeekSpawnedActorClass(Bunch);
+
+		if (SpawnedActorClass != nullptr && MinClient->ShouldBlockActorSpawn(SpawnedActorClass))
+		{
+			bBlockedActor = true;
+			ActorClassName = SpawnedActorClass->GetFName();
+
+			MinClient->NotifyActorBunch(ActorClassName, NumBits, FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles),
+				false, true);
+
+			return;
+		}
+	}
+
 	Super::ReceivedBunch(Bunch);
+
+	const double Seconds = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles);
+
+	if (Actor != nullptr && ActorClassName.IsNone())
+	{
+		ActorClassName = Actor->GetClass()->GetFName();
+	}
+
+	if (MinClient != nullptr)
+	{
+		MinClient->NotifyActorBunch(ActorClassName, NumBits, Seconds, !bHadActor && Actor != nullptr, bBlockedActor);
+	}
+}
+
+UClass* UMyActorChannel::PeekSpawnedActorClass(FInBunch& Bunch)
+{
+	UClass* ReturnVal = nullptr;
+	UPackageMapClient* PackageMapClient = Connection != nullptr ? Cast<UPackageMapClient>(Connection->PackageMap) : nullptr;
+
+	if (PackageMapClient != nullptr)
+	{
+		FInBunch PeekBunch(Bunch, true);
+
+		// Skip the NetGUIDs which must be loaded before the bunch is processed, as UActorChannel::ReceivedBunch does
+		if (PeekBunch.bHasMustBeMappedGUIDs)
+		{
+			uint16 NumMustBeMappedGUIDs = 0;
+
+			PeekBunch << NumMustBeMappedGUIDs;
+
+			for (int32 i = 0; i < NumMustBeMappedGUIDs && !PeekBunch.IsError(); i++)
+			{
+				FNetworkGUID NetGUID;
+
+				PeekBunch << NetGUID;
+			}
+		}
+
+		UObject* NewActor = nullptr;
+		FNetworkGUID ActorGUID;
+
+		// The base implementation is called directly, to keep the peek out of the package map serialization profile
+		PackageMapClient->UPackageMapClient::SerializeObject(PeekBunch, AActor::StaticClass(), NewActor, &ActorGUID);
+
+		// Only a dynamic actor which doesn't exist yet is spawned, from the archetype which follows it (an archetype which
+		// is still loading resolves to nullptr, and the actor is left to spawn)
+		if (!PeekBunch.IsError() && NewActor == nullptr && ActorGUID.IsDynamic())
+		{
+			UObject* Archetype = nullptr;
+
+			PackageMapClient->UPackageMapClient::SerializeObject(PeekBunch, UObject::StaticClass(), Archetype);
+
+			if (!PeekBunch.IsError() && Archetype != nullptr)
+			{
+				ReturnVal = Archetype->GetClass();
+			}
+		}
+	}
+
+	return ReturnVal;
 }
 
 void UMyActorChannel::Tick()
@@ -31,4 +140,9 @@ void UMyActorChannel::Tick()
 void UMyActorChannel::NotifyActorChannelOpen(AActor* InActor, FInBunch& InBunch)
 {
 	Super::NotifyActorChannelOpen(InActor, InBunch);
+
+	if (MinClient != nullptr)
+	{
+		MinClient->NetActorDel.ExecuteIfBound(this, InActor);
+	}
 }
@@ -32,9 +32,24 @@ public:
 
 	virtual void NotifyActorChannelOpen(AActor* InActor, FInBunch& InBunch) override;
 
+private:
+	/**
+	 * Reads the actor and archetype NetGUIDs of an open bunch (from a copy, leaving the bunch untouched), without spawning
+	 *
+	 * @param Bunch		The bunch opening the channel
+	 * @return			The class of the dynamic actor the bunch would spawn, or nullptr if it spawns none/can't be resolved yet
+	 */
+	UClass* PeekSpawnedActorClass(FInBunch& Bunch);
+
 private:
 	/** Cached referenced to the minimal client that owns this actor channel */
 	UMinimalClient* MinClient;
+
+	/** The class of the channel's actor, once spawned (kept after the actor goes away, for accounting the closing bunch) */
+	FName ActorClassName;
+
+	/** Whether or not the channel's actor was blocked from spawning by the actor filter (its bunches are dropped) */
+	bool bBlockedActor;
 };
 
 
@@ -5,11 +5,19 @@
 #include "Engine/NetConnection.h"
 #include "MyConnection.h"
 #include "MinimalClient.h"
+#include "Misc/Crc.h"
+#include "NetworkTesterTrace.h"
 
 
 UMyChatChannel::UMyChatChannel(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 	, bVerifyOpen(false)
+	, NextPingSequence(0)
+	, NumUnexpectedPongs(0)
+	, NextUnreliableSequence(0)
+	, NumReceivedBlobs(0)
+	, ReceivedBlobBytes(0)
+	, ReceivedBlobSeconds(0.0)
 {
 	ChName = NAME_Voice;
 }
@@ -21,16 +29,404 @@ void UMyChatChannel::Init(UNetConnection* InConnection, int32 InChIndex, EChanne
 
 void UMyChatChannel::ReceivedBunch(FInBunch& Bunch)
 {
-	FString Text;
+	NETTESTER_TRACE_SCOPE(UMyChatChannel_ReceivedBunch);
+	TRACE_COUNTER_INCREMENT(NetTester_ReceivedBunches);
 
-	Bunch << Text;
-	
-	UE_LOG(LogNet, Warning, TEXT("UMyChannel::ReceivedBunch: %s\n"), *Text);
+	UMyConnection* MyConnection = Cast<UMyConnection>(Connection);
+	if (MyConnection)
+	{
+		MyConnection->NumReceivedBunches++;
+	}
+
+	ReceivedMessage(Bunch, true, true);
+}
+
+void UMyChatChannel::ReceivedMessage(FInBunch& Bunch, bool bAllowCompressed, bool bAllowUnreliable)
+{
+	uint8 MessageType = 0;
+
+	Bunch << MessageType;
+
+	switch ((EChatMessageType)MessageType)
+	{
+	case EChatMessageType::Text:
+		{
+			FString Text;
+
+			Bunch << Text;
+
+			if (!Bunch.IsError())
+			{
+				ReceivedText(Text);
+			}
+		}
+		break;
+
+	case EChatMessageType::Batch:
+		ReceivedBatch(Bunch);
+		break;
+
+	case EChatMessageType::CompactText:
+		if (FChatMessageCodec::ReadText(Bunch, DecodedText))
+		{
+			ReceivedText(DecodedText);
+		}
+		break;
+
+	case EChatMessageType::CompactBatch:
+		ReceivedCompactBatch(Bunch);
+		break;
+
+	case EChatMessageType::Record:
+		ReceivedRecord(Bunch);
+		break;
+
+	case EChatMessageType::BlobBegin:
+		ReceivedBlobBegin(Bunch);
+		break;
+
+	case EChatMessageType::BlobChunk:
+		ReceivedBlobChunk(Bunch);
+		break;
+
+	case EChatMessageType::BlobEnd:
+		ReceivedBlobEnd(Bunch);
+		break;
+
+	case EChatMessageType::Unreliable:
+		if (bAllowUnreliable && !Bunch.bReliable)
+		{
+			ReceivedUnreliable(Bunch);
+		}
+		else
+		{
+			UE_LOG(LogNet, Warning, TEXT("UMyChannel::ReceivedBunch: misplaced unreliable message"));
+			Bunch.SetError();
+		}
+		break;
+
+	case EChatMessageType::Compressed:
+		if (bAllowCompressed)
+		{
+			ReceivedCompressed(Bunch);
+		}
+		else
+		{
+			UE_LOG(LogNet, Warning, TEXT("UMyChannel::ReceivedBunch: nested compressed message"));
+			Bunch.SetError();
+		}
+		break;
+
+	case EChatMessageType::Ping:
+		ReceivedPing(Bunch);
+		break;
+
+	case EChatMessageType::Pong:
+		ReceivedPong(Bunch);
+		break;
+
+	default:
+		UE_LOG(LogNet, Warning, TEXT("UMyChannel::ReceivedBunch: unknown message type %i"), MessageType);
+		Bunch.SetError();
+		break;
+	}
+}
+
+bool UMyChatChannel::SendMessage(const FBitWriter& Payload, bool bReliable)
+{
+	FOutBunch OutBunch(this, false);
+
+	OutBunch.bReliable = bReliable ? 1 : 0;
+
+	if (!bReliable)
+	{
+		uint8 MessageType = (uint8)EChatMessageType::Unreliable;
+		uint32 Sequence = NextUnreliableSequence++;
+		uint64 SendCycles = FPlatformTime::Cycles64();
+
+		OutBunch << MessageType;
+		OutBunch.SerializeIntPacked(Sequence);
+		OutBunch << SendCycles;
+	}
+
+	OutBunch.SerializeBits((void*)Payload.GetData(), Payload.GetNumBits());
+
+	const bool bReturnVal = !OutBunch.IsError();
+
+	if (bReturnVal)
+	{
+		SendBunch(&OutBunch, false);
+	}
+
+	return bReturnVal;
+}
+
+void UMyChatChannel::ReceivedUnreliable(FInBunch& Bunch)
+{
+	uint32 Sequence = 0;
+	uint64 SendCycles = 0;
+
+	Bunch.SerializeIntPacked(Sequence);
+	Bunch << SendCycles;
+
+	if (!Bunch.IsError())
+	{
+		const uint64 NowCycles = FPlatformTime::Cycles64();
+
+		UnreliableSequences.Receive(Sequence);
+
+		if (SendCycles <= NowCycles)
+		{
+			UnreliableLatency.AddSample((uint64)(FPlatformTime::ToSeconds64(NowCycles - SendCycles) * 1000000.0));
+		}
+
+		ReceivedMessage(Bunch, true, false);
+	}
+}
+
+void UMyChatChannel::ReceivedCompressed(FInBunch& Bunch)
+{
+	int64 NumBits = 0;
+
+	if (FChatCompression::Decompress(Bunch, DecompressedData, NumBits, CompressedData, CompressionStats))
+	{
+		FInBunch InnerBunch(Connection, DecompressedData.GetData(), NumBits);
+
+		ReceivedMessage(InnerBunch, false, false);
+
+		if (InnerBunch.IsError())
+		{
+			Bunch.SetError();
+		}
+	}
+	else
+	{
+		UE_LOG(LogNet, Warning, TEXT("UMyChannel::ReceivedBunch: failed to decompress message"));
+	}
+}
+
+void UMyChatChannel::ReceivedText(const FString& InText)
+{
+	UE_LOG(LogNet, Verbose, TEXT("UMyChannel::ReceivedBunch: %s"), *InText);
 
 	UMyConnection* MyConnection = Cast<UMyConnection>(Connection);
 	if (MyConnection && MyConnection->MinClient)
 	{
-		MyConnection->MinClient->ReceiveMessageDel.Broadcast(Text, Connection);
+		MyConnection->MinClient->NotifyReceivedText(InText, Connection);
+	}
+}
+
+void UMyChatChannel::ReceivedBatch(FInBunch& Bunch)
+{
+	uint32 Count = 0;
+
+	Bunch.SerializeIntPacked(Count);
+
+	for (uint32 i = 0; i < Count && !Bunch.IsError(); i++)
+	{
+		FString Text;
+
+		Bunch << Text;
+
+		if (!Bunch.IsError())
+		{
+			ReceivedText(Text);
+		}
+	}
+}
+
+void UMyChatChannel::ReceivedCompactBatch(FInBunch& Bunch)
+{
+	uint32 Count = 0;
+
+	Bunch.SerializeIntPacked(Count);
+
+	for (uint32 i = 0; i < Count && FChatMessageCodec::ReadText(Bunch, DecodedText); i++)
+	{
+		ReceivedText(DecodedText);
+	}
+}
+
+void UMyChatChannel::ReceivedRecord(FInBunch& Bunch)
+{
+	FChatRecord Record;
+
+	if (FChatMessageCodec::ReadRecord(Bunch, Record))
+	{
+		UMyConnection* MyConnection = Cast<UMyConnection>(Connection);
+		if (MyConnection && MyConnection->MinClient)
+		{
+			MyConnection->MinClient->NotifyReceivedRecord(Record, Connection);
+		}
+	}
+}
+
+void UMyChatChannel::ReceivedBlobBegin(FInBunch& Bunch)
+{
+	uint32 BlobId = 0;
+	int64 TotalBytes = 0;
+	uint32 Crc = 0;
+
+	Bunch.SerializeIntPacked(BlobId);
+	Bunch << TotalBytes;
+	Bunch << Crc;
+
+	if (Bunch.IsError() || TotalBytes < 0 || TotalBytes > FBlobReceiveState::MaxBlobBytes)
+	{
+		UE_LOG(LogNet, Warning, TEXT("UMyChannel::ReceivedBunch: invalid blob %u of %lld bytes"), BlobId, TotalBytes);
+		Bunch.SetError();
+		return;
+	}
+
+	if (!IncomingBlobs.Contains(BlobId) && IncomingBlobs.Num() >= FBlobReceiveState::MaxIncomingBlobs)
+	{
+		UE_LOG(LogNet, Warning, TEXT("UMyChannel::ReceivedBunch: blob %u exceeds %d concurrent incoming blobs"), BlobId,
+			FBlobReceiveState::MaxIncomingBlobs);
+		Bunch.SetError();
+		return;
+	}
+
+	FBlobReceiveState& State = IncomingBlobs.FindOrAdd(BlobId);
+
+	State.Data.Empty();
+	State.TotalBytes = TotalBytes;
+	State.Crc = Crc;
+	State.StartTime = FPlatformTime::Seconds();
+}
+
+void UMyChatChannel::ReceivedBlobChunk(FInBunch& Bunch)
+{
+	uint32 BlobId = 0;
+	int64 Offset = 0;
+	uint32 ChunkBytes = 0;
+
+	Bunch.SerializeIntPacked(BlobId);
+	Bunch << Offset;
+	Bunch.SerializeIntPacked(ChunkBytes);
+
+	FBlobReceiveState* State = IncomingBlobs.Find(BlobId);
+
+	// Chunks arrive reliably and in order, so they always continue where the last one left off
+	if (Bunch.IsError() || State == nullptr || Offset != State->Data.Num() || Offset + ChunkBytes > State->TotalBytes ||
+		(int64)ChunkBytes * 8 > Bunch.GetBitsLeft())
+	{
+		UE_LOG(LogNet, Warning, TEXT("UMyChannel::ReceivedBunch: unexpected chunk of blob %u at %lld"), BlobId, Offset);
+		Bunch.SetError();
+		return;
+	}
+
+	State->Data.AddUninitialized(ChunkBytes);
+	Bunch.Serialize(State->Data.GetData() + Offset, ChunkBytes);
+
+	if (Bunch.IsError())
+	{
+		State->Data.SetNum((int32)Offset, false);
+	}
+}
+
+void UMyChatChannel::ReceivedBlobEnd(FInBunch& Bunch)
+{
+	uint32 BlobId = 0;
+	uint8 bCancelled = 0;
+
+	Bunch.SerializeIntPacked(BlobId);
+	Bunch << bCancelled;
+
+	FBlobReceiveState State;
+
+	if (Bunch.IsError() || !IncomingBlobs.RemoveAndCopyValue(BlobId, State))
+	{
+		Bunch.SetError();
+		return;
+	}
+
+	if (bCancelled)
+	{
+		UE_LOG(LogNet, Log, TEXT("UMyChannel::ReceivedBunch: blob %u cancelled after %d bytes"), BlobId, State.Data.Num());
+	}
+	else if (State.Data.Num() != State.TotalBytes || FCrc::MemCrc32(State.Data.GetData(), State.Data.Num()) != State.Crc)
+	{
+		UE_LOG(LogNet, Warning, TEXT("UMyChannel::ReceivedBunch: blob %u failed verification"), BlobId);
+	}
+	else
+	{
+		const double Seconds = FPlatformTime::Seconds() - State.StartTime;
+
+		NumReceivedBlobs++;
+		ReceivedBlobBytes += State.Data.Num();
+		ReceivedBlobSeconds += Seconds;
+
+		UE_LOG(LogNet, Log, TEXT("UMyChannel::ReceivedBunch: blob %u, %d bytes in %.3f s"), BlobId, State.Data.Num(), Seconds);
+
+		UMyConnection* MyConnection = Cast<UMyConnection>(Connection);
+		if (MyConnection && MyConnection->MinClient)
+		{
+			MyConnection->MinClient->NotifyReceivedBlob(BlobId, MoveTemp(State.Data), Connection);
+		}
+	}
+}
+
+void UMyChatChannel::SendPing()
+{
+	uint8 MessageType = (uint8)EChatMessageType::Ping;
+	uint32 Sequence = NextPingSequence++;
+	uint64 SendCycles = FPlatformTime::Cycles64();
+	FOutBunch OutBunch(this, false);
+
+	OutBunch.bReliable = 1;
+	OutBunch << MessageType;
+	OutBunch << Sequence;
+	OutBunch << SendCycles;
+
+	SendBunch(&OutBunch, false);
+}
+
+void UMyChatChannel::ReceivedPing(FInBunch& Bunch)
+{
+	uint32 Sequence = 0;
+	uint64 SendCycles = 0;
+
+	Bunch << Sequence;
+	Bunch << SendCycles;
+
+	if (!Bunch.IsError())
+	{
+		// Echo the probe back as-is, the timestamp is only ever interpreted by the sender
+		uint8 MessageType = (uint8)EChatMessageType::Pong;
+		FOutBunch OutBunch(this, false);
+
+		OutBunch.bReliable = 1;
+		OutBunch << MessageType;
+		OutBunch << Sequence;
+		OutBunch << SendCycles;
+
+		SendBunch(&OutBunch, false);
+		Connection->FlushNet();
+	}
+}
+
+void UMyChatChannel::ReceivedPong(FInBunch& Bunch)
+{
+	uint32 Sequence = 0;
+	uint64 SendCycles = 0;
+
+	Bunch << Sequence;
+	Bunch << SendCycles;
+
+	if (!Bunch.IsError())
+	{
+		const uint64 NowCycles = FPlatformTime::Cycles64();
+
+		if (Sequence < NextPingSequence && SendCycles <= NowCycles)
+		{
+			const double RttSeconds = FPlatformTime::ToSeconds64(NowCycles - SendCycles);
+
+			RttHistogram.AddSample((uint64)(RttSeconds * 1000000.0));
+		}
+		else
+		{
+			NumUnexpectedPongs++;
+		}
 	}
 }
 
@@ -7,14 +7,63 @@
 #include "CoreMinimal.h"
 #include "UObject/ObjectMacros.h"
 #include "Engine/Channel.h"
+#include "NetLatencyHistogram.h"
+#include "ChatMessageCodec.h"
+#include "ChatCompression.h"
+#include "BlobTransfer.h"
+#include "NetSequenceTracker.h"
 #include "MyChatChannel.generated.h"
 
 
+class FBitWriter;
 class FInBunch;
 class UNetConnection;
 class UMinimalClient;
 
 
+/** The type of a chat channel message, serialized at the start of every bunch */
+enum class EChatMessageType : uint8
+{
+	/** FString text, broadcast through UMinimalClient::ReceiveMessageDel */
+	Text,
+
+	/** Latency probe: sequence number and sender timestamp, echoed back as a Pong */
+	Ping,
+
+	/** Echo of a Ping */
+	Pong,
+
+	/** Packed count, followed by that many FString texts, coalesced by UMinimalClient send batching */
+	Batch,
+
+	/** Packed UTF-8 length, followed by the UTF-8 text (see FChatMessageCodec) */
+	CompactText,
+
+	/** Packed count, followed by that many compact texts */
+	CompactBatch,
+
+	/** Fixed-layout FChatRecord */
+	Record,
+
+	/** Another chat message, compressed (see FChatCompression) */
+	Compressed,
+
+	/** Packed blob id, int64 total size and uint32 CRC, starting a blob stream (see FBlobSender) */
+	BlobBegin,
+
+	/** Packed blob id, int64 offset, packed length, followed by that many bytes of the blob */
+	BlobChunk,
+
+	/** Packed blob id and uint8 cancelled flag, ending a blob stream */
+	BlobEnd,
+
+	/** Packed sequence number and uint64 send cycles, followed by another chat message, sent unreliably */
+	Unreliable,
+
+	MAX
+};
+
+
 /*
  * A net channel for overriding the implementation of traditional net channels
  */
@@ -29,7 +78,94 @@ class UMyChatChannel : public UChannel
 
 	virtual void Tick() override;
 
+public:
+	/** Sends a latency probe, which the remote side echoes back */
+	void SendPing();
+
+	/**
+	 * Sends a prebuilt chat message as one bunch
+	 *
+	 * @param Payload	The serialized message, starting with its EChatMessageType
+	 * @param bReliable	Whether to send reliably, or unreliably wrapped in an Unreliable message with the next sequence number
+	 * @return			Whether or not the bunch was sent
+	 */
+	bool SendMessage(const FBitWriter& Payload, bool bReliable);
+
+protected:
+	/**
+	 * Handles one chat message
+	 *
+	 * @param Bunch				The bunch, positioned at the message type
+	 * @param bAllowCompressed	Whether or not the message may be a Compressed wrapper (which can't be nested)
+	 * @param bAllowUnreliable	Whether or not the message may be an Unreliable wrapper (only at the top level)
+	 */
+	void ReceivedMessage(FInBunch& Bunch, bool bAllowCompressed, bool bAllowUnreliable);
+
+	void ReceivedUnreliable(FInBunch& Bunch);
+
+	void ReceivedCompressed(FInBunch& Bunch);
+
+	void ReceivedText(const FString& InText);
+
+	void ReceivedBatch(FInBunch& Bunch);
+
+	void ReceivedCompactBatch(FInBunch& Bunch);
+
+	void ReceivedRecord(FInBunch& Bunch);
+
+	void ReceivedBlobBegin(FInBunch& Bunch);
+
+	void ReceivedBlobChunk(FInBunch& Bunch);
+
+	void ReceivedBlobEnd(FInBunch& Bunch);
+
+	void ReceivedPing(FInBunch& Bunch);
+
+	void ReceivedPong(FInBunch& Bunch);
+
 public:
 	/** Whether or not this channel should verify it has been opened (resends initial packets until acked, like control channel) */
 	bool bVerifyOpen;
+
+	/** Round trip times (in microseconds) of the pings sent on this channel */
+	FNetLatencyHistogram RttHistogram;
+
+	/** The sequence number of the next ping */
+	uint32 NextPingSequence;
+
+	/** The number of pongs received out of order, or not matching a sent ping */
+	uint32 NumUnexpectedPongs;
+
+	/**
+	 * Compression on this connection: sends count the payloads this channel sent compressed (the CPU cost is paid once
+	 * per broadcast, and kept by UMinimalClient), receives count decompression
+	 */
+	FChatCompressionStats CompressionStats;
+
+	/** The sequence number of the next unreliable message sent */
+	uint32 NextUnreliableSequence;
+
+	/** Loss, reordering and duplicates of the unreliable messages received */
+	FNetSequenceTracker UnreliableSequences;
+
+	/** Send to receive time (in microseconds) of unreliable messages, only meaningful when both ends share a clock (same machine) */
+	FNetLatencyHistogram UnreliableLatency;
+
+	/** Blobs fully received on this channel */
+	uint32 NumReceivedBlobs;
+
+	/** Bytes of fully received blobs, and the time spent receiving them */
+	uint64 ReceivedBlobBytes;
+	double ReceivedBlobSeconds;
+
+protected:
+	/** Blobs currently being received, by id */
+	TMap<uint32, FBlobReceiveState> IncomingBlobs;
+
+	/** Compact text is decoded into this, so its allocation is reused between messages */
+	FString DecodedText;
+
+	/** Reusable decompression buffers */
+	TArray<uint8> CompressedData;
+	TArray<uint8> DecompressedData;
 };
@@ -3,12 +3,194 @@
 
 #include "MyConnection.h"
 #include "Engine/NetConnection.h"
+#include "PacketHandler.h"
 #include "MinimalClient.h"
+#include "MyNetDriver.h"
+#include "NetPacketTrace.h"
+
+
+static volatile int32 GNextConnectionId = 0;
 
 
 UMyConnection::UMyConnection(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 	, MinClient(nullptr)
+	, ConnectionId((uint32)FPlatformAtomics::InterlockedIncrement(&GNextConnectionId))
+	, TraceCaptureId(FNetPacketTraceWriter::Get().IsCapturing() ? FNetPacketTraceWriter::Get().GetCaptureId() : 0)
+	, NumReceivedBunches(0)
+	, PendingSendBatchMode(INDEX_NONE)
+{
+}
+
+ENetPacketTraceFlags UMyConnection::GetTraceFlags() const
+{
+	ENetPacketTraceFlags ReturnVal = ENetPacketTraceFlags::None;
+
+	if (TraceCaptureId != 0 && TraceCaptureId == FNetPacketTraceWriter::Get().GetCaptureId())
+	{
+		ReturnVal |= ENetPacketTraceFlags::Handshake;
+	}
+
+	if (Driver != nullptr && Driver->ServerConnection != this)
+	{
+		ReturnVal |= ENetPacketTraceFlags::ServerConnection;
+	}
+
+	return ReturnVal;
+}
+
+void UMyConnection::ReceivedRawPacket(void* Data, int32 Count)
+{
+	NETTESTER_TRACE_SCOPE(UMyConnection_ReceivedRawPacket);
+
+	if (MinClient != nullptr)
+	{
+		MinClient->ReceivedRawPacketDel.ExecuteIfBound(Data, Count);
+	}
+
+	if (UMyNetDriver* MyNetDriver = Cast<UMyNetDriver>(Driver))
+	{
+		MyNetDriver->NotifyUnbatchedReceive();
+	}
+
+	if (FNetPacketTraceWriter::Get().IsCapturing())
+	{
+		FNetPacketTraceWriter::Get().Write(ConnectionId, ENetPacketDirection::Incoming, GetTraceFlags(), Data, (uint32)Count * 8);
+	}
+
+	if (IncomingSimulator.IsEnabled())
+	{
+		IncomingSimulator.Enqueue(Data, Count * 8, FOutPacketTraits(), FPlatformTime::Seconds());
+	}
+	else
+	{
+		Super::ReceivedRawPacket(Data, Count);
+	}
+}
+
+void UMyConnection::LowLevelSend(void* Data, int32 CountBits, FOutPacketTraits& Traits)
+{
+	NETTESTER_TRACE_SCOPE(UMyConnection_LowLevelSend);
+
+	if (MinClient != nullptr && MinClient->bDropOutgoingPackets)
+	{
+		return;
+	}
+
+	if (FNetPacketTraceWriter::Get().IsCapturing())
+	{
+		FNetPacketTraceWriter::Get().Write(ConnectionId, ENetPacketDirection::Outgoing, GetTraceFlags(), Data, (uint32)CountBits);
+	}
+
+	if (MinClient != nullptr && PendingSendBatchMode != INDEX_NONE)
+	{
+		MinClient->NotifySendBatchPacket(PendingSendBatchMode, FMath::DivideAndRoundUp(CountBits, 8));
+
+		PendingSendBatchMode = INDEX_NONE;
+	}
+
+	if (OutgoingSimulator.IsEnabled())
+	{
+		OutgoingSimulator.Enqueue(Data, CountBits, Traits, FPlatformTime::Seconds());
+	}
+	else
+	{
+		SendToTransport(Data, CountBits, Traits);
+	}
+}
+
+void UMyConnection::SendToTransport(void* Data, int32 CountBits, FOutPacketTraits& Traits)
+{
+	UMyNetDriver* MyNetDriver = Cast<UMyNetDriver>(Driver);
+	const bool bLoopback = LoopbackEndpoint.IsValid() && LoopbackEndpoint->IsLinked();
+	const bool bBatched = !bLoopback && MyNetDriver != nullptr && MyNetDriver->IsSocketBatching();
+
+	if (bLoopback || bBatched)
+	{
+		const uint8* DataToSend = reinterpret_cast<uint8*>(Data);
+
+		// Same as UIpConnection::LowLevelSend, so the peer's PacketHandler gets exactly what the socket would have carried
+		if (Handler.IsValid() && !Handler->GetRawSend())
+		{
+			const ProcessedPacket ProcessedData = Handler->Outgoing(reinterpret_cast<uint8*>(Data), CountBits, Traits);
+
+			DataToSend = ProcessedData.Data;
+			CountBits = ProcessedData.bError ? 0 : ProcessedData.CountBits;
+		}
+
+		if (CountBits > 0 && bLoopback)
+		{
+			LoopbackEndpoint->Send(DataToSend, FMath::DivideAndRoundUp(CountBits, 8));
+		}
+		else if (CountBits > 0)
+		{
+			MyNetDriver->SendBatched(DataToSend, FMath::DivideAndRoundUp(CountBits, 8));
+		}
+	}
+	else
+	{
+		Super::LowLevelSend(Data, CountBits, Traits);
+
+		if (MyNetDriver != nullptr)
+		{
+			MyNetDriver->NotifyUnbatchedSend();
+		}
+	}
+}
+
+void UMyConnection::ReceiveLoopbackPackets()
+{
+	if (LoopbackEndpoint.IsValid() && GetConnectionState() != USOCK_Closed)
+	{
+		LoopbackEndpoint->Receive([this](uint8* Data, int32 Count)
+			{
+				ReceivedRawPacket(Data, Count);
+			});
+	}
+}
+
+void UMyConnection::ReleaseIncomingPackets()
+{
+	// Packets still pending when a profile is switched off are released as normal
+	if (IncomingSimulator.GetNumPending() > 0 && GetConnectionState() != USOCK_Closed)
+	{
+		IncomingSimulator.Release(FPlatformTime::Seconds(), [this](uint8* Data, int32 NumBits, FOutPacketTraits& Traits)
+			{
+				Super::ReceivedRawPacket(Data, (NumBits + 7) / 8);
+			});
+	}
+}
+
+void UMyConnection::Tick(float DeltaSeconds)
+{
+	// Packets still pending when a profile is switched off are released as normal
+	if (OutgoingSimulator.GetNumPending() > 0)
+	{
+		OutgoingSimulator.Release(FPlatformTime::Seconds(), [this](uint8* Data, int32 NumBits, FOutPacketTraits& Traits)
+			{
+				SendToTransport(Data, NumBits, Traits);
+			});
+	}
+
+	Super::Tick(DeltaSeconds);
+}
+
+void UMyConnection::CleanUp()
+{
+	if (LoopbackEndpoint.IsValid())
+	{
+		FNetLoopbackTransport::UnregisterClient(LoopbackEndpoint);
+
+		LoopbackEndpoint->Close();
+		LoopbackEndpoint.Reset();
+	}
+
+	Super::CleanUp();
+}
+
+void UMyConnection::SetNetConditionProfile(const FNetConditionProfile& InProfile)
 {
+	OutgoingSimulator.SetProfile(InProfile, (int32)(ConnectionId * 2));
+	IncomingSimulator.SetProfile(InProfile, (int32)(ConnectionId * 2 + 1));
 }
 
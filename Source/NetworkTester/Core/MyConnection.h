@@ -7,6 +7,10 @@
 #include "CoreMinimal.h"
 #include "UObject/ObjectMacros.h"
 #include "OnlineSubsystemUtils/Classes/IpConnection.h"
+#include "NetConditionSimulator.h"
+#include "NetworkTesterTrace.h"
+#include "NetLoopbackTransport.h"
+#include "NetPacketTrace.h"
 #include "MyConnection.generated.h"
 
 
@@ -23,8 +27,60 @@ class UMyConnection : public UIpConnection
 {
 	GENERATED_UCLASS_BODY()
 
+public:
+	virtual void ReceivedRawPacket(void* Data, int32 Count) override;
+
+	virtual void LowLevelSend(void* Data, int32 CountBits, FOutPacketTraits& Traits) override;
+
+	virtual void Tick(float DeltaSeconds) override;
+
+	virtual void CleanUp() override;
+
+	/** Applies simulated network conditions to both directions of this connection ("Off" disables) */
+	void SetNetConditionProfile(const FNetConditionProfile& InProfile);
+
+	/** Passes the packets queued on the loopback link to ReceivedRawPacket (called by UMyNetDriver::TickDispatch) */
+	void ReceiveLoopbackPackets();
+
+	/** Receives the packets the incoming simulator has held back until now (called by UMyNetDriver::TickDispatch) */
+	void ReleaseIncomingPackets();
+
+	/** @return The role of this connection, and whether it was opened during the current packet capture */
+	ENetPacketTraceFlags GetTraceFlags() const;
+
+protected:
+	/**
+	 * Sends a packet which has passed the simulator - over the loopback link once linked, or the net driver's batching
+	 * socket (running the PacketHandler as the socket path would), or through the engine socket otherwise
+	 */
+	virtual void SendToTransport(void* Data, int32 CountBits, FOutPacketTraits& Traits);
+
 public:
 	/** The minimal client which may require received bunch notifications */
 	UMinimalClient* MinClient;
 
+	/** Process-unique id of this connection, used to tell connections apart in packet traces */
+	uint32 ConnectionId;
+
+	/** FNetPacketTraceWriter::GetCaptureId when this connection was opened, or 0 if it was opened while not capturing */
+	uint32 TraceCaptureId;
+
+	/** The number of bunches received by the minimal client's chat/actor channels on this connection */
+	uint64 NumReceivedBunches;
+
+	/** The minimal client's SendBatchStats the next packet sent is counted in (it carries chat bunches), or INDEX_NONE */
+	int32 PendingSendBatchMode;
+
+	/** Simulated conditions for packets sent by this connection */
+	FNetConditionSimulator OutgoingSimulator;
+
+	/** Simulated conditions for packets received by this connection */
+	FNetConditionSimulator IncomingSimulator;
+
+	/** Insights counters of this connection, created once the NetworkTester trace channel is enabled */
+	TUniquePtr<FNetConnectionTraceCounters> TraceCounters;
+
+	/** This connection's end of an in-process loopback link, if its minimal client uses the loopback transport */
+	TSharedPtr<FNetLoopbackEndpoint, ESPMode::ThreadSafe> LoopbackEndpoint;
+
 };
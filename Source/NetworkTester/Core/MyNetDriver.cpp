@@ -0,0 +1,184 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+//
+
+#include "MyNetDriver.h"
+
+#include "HAL/IConsoleManager.h"
+#include "IPAddress.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+#include "UObject/UObjectIterator.h"
+#include "MinimalClient.h"
+#include "MyConnection.h"
+#include "NetworkTesterTrace.h"
+
+
+int32 UMyNetDriver::SocketBatchSize = 0;
+
+
+UMyNetDriver::UMyNetDriver(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+	, bPollingEngineSocket(false)
+{
+}
+
+bool UMyNetDriver::InitConnect(FNetworkNotify* InNotify, const FURL& ConnectURL, FString& Error)
+{
+	UnbatchedStats = FNetSocketBatchStats();
+
+	// Opened before the handshake is sent, so that the server only ever sees the batching socket's port
+	if (SocketBatchSize > 0 && FNetSocketBatcher::IsSupported())
+	{
+		ISocketSubsystem* SocketSubsystem = GetSocketSubsystem();
+		TSharedPtr<FInternetAddr> ServerAddr = SocketSubsystem != nullptr ? SocketSubsystem->GetAddressFromString(ConnectURL.Host) : nullptr;
+
+		if (ServerAddr.IsValid())
+		{
+			ServerAddr->SetPort(ConnectURL.Port);
+
+			SocketBatcher.Open(*ServerAddr, SocketBatchSize);
+		}
+
+		if (!SocketBatcher.IsOpen())
+		{
+			UE_LOG(LogNetworkTester, Warning, TEXT("MyNetDriver: can't batch to '%s', using the engine socket"), *ConnectURL.Host);
+		}
+	}
+
+	return Super::InitConnect(InNotify, ConnectURL, Error);
+}
+
+void UMyNetDriver::TickDispatch(float DeltaTime)
+{
+	{
+		TGuardValue<bool> PollingGuard(bPollingEngineSocket, true);
+
+		Super::TickDispatch(DeltaTime);
+	}
+
+	// The recvfrom which found the engine socket empty (the only one, once batching or linked through the loopback transport)
+	GetSocketStats().RecvSyscalls++;
+
+	if (SocketBatcher.IsOpen())
+	{
+		NETTESTER_TRACE_SCOPE(UMyNetDriver_ReceiveBatched);
+
+		SocketBatcher.GetStats().NumTicks++;
+
+		SocketBatcher.Receive([this](uint8* Data, int32 CountBytes)
+			{
+				if (ServerConnection != nullptr)
+				{
+					ServerConnection->ReceivedRawPacket(Data, CountBytes);
+				}
+			});
+	}
+	else
+	{
+		UnbatchedStats.NumTicks++;
+	}
+
+	NETTESTER_TRACE_SCOPE(UMyNetDriver_ReceiveLoopback);
+
+	// Simulated incoming latency is released here too, so it is not rounded up to the next TickFlush
+	UMyConnection* MyServerConnection = Cast<UMyConnection>(ServerConnection);
+
+	if (MyServerConnection != nullptr)
+	{
+		MyServerConnection->ReceiveLoopbackPackets();
+		MyServerConnection->ReleaseIncomingPackets();
+	}
+
+	// Backwards, in case a received packet gets its connection removed
+	for (int32 ConnIdx = ClientConnections.Num() - 1; ConnIdx >= 0; ConnIdx--)
+	{
+		UMyConnection* MyConnection = ClientConnections.IsValidIndex(ConnIdx) ? Cast<UMyConnection>(ClientConnections[ConnIdx]) : nullptr;
+
+		if (MyConnection != nullptr)
+		{
+			MyConnection->ReceiveLoopbackPackets();
+			MyConnection->ReleaseIncomingPackets();
+		}
+	}
+}
+
+void UMyNetDriver::TickFlush(float DeltaSeconds)
+{
+	Super::TickFlush(DeltaSeconds);
+
+	// Everything the connections flushed this tick goes out in as few sendmmsg calls as possible
+	SocketBatcher.Flush();
+}
+
+void UMyNetDriver::Shutdown()
+{
+	Super::Shutdown();
+
+	SocketBatcher.Close();
+}
+
+int32 UMyNetDriver::GetLocalPort()
+{
+	int32 ReturnVal = 0;
+
+	if (SocketBatcher.IsOpen())
+	{
+		ReturnVal = SocketBatcher.GetLocalPort();
+	}
+	else if (GetSocket() != nullptr)
+	{
+		ReturnVal = GetSocket()->GetPortNo();
+	}
+
+	return ReturnVal;
+}
+
+void UMyNetDriver::SetSocketBatchSize(int32 InBatchSize)
+{
+	SocketBatchSize = FMath::Clamp(InBatchSize, 0, FNetSocketBatcher::MaxBatchSize);
+}
+
+
+static FAutoConsoleCommand SocketBatchCommand(
+	TEXT("NetTester.Socket.Batch"),
+	TEXT("Sets the most packets per recvmmsg/sendmmsg for minimal clients connecting from now on (Linux only, 0 uses the engine socket). Usage: NetTester.Socket.Batch <BatchSize, up to 64>"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		UMyNetDriver::SetSocketBatchSize(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 0);
+
+		UE_LOG(LogNetworkTester, Log, TEXT("Socket batch size: %i%s"), UMyNetDriver::GetSocketBatchSize(),
+			FNetSocketBatcher::IsSupported() ? TEXT("") : TEXT(" (not supported on this platform, ignored)"));
+	}));
+
+static FAutoConsoleCommand SocketReportCommand(
+	TEXT("NetTester.Socket.Report"),
+	TEXT("Logs the socket syscalls per tick and packets per syscall, of every minimal client, batched and unbatched."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		FNetSocketBatchStats BatchedStats;
+		FNetSocketBatchStats UnbatchedStats;
+		int32 NumBatched = 0;
+		int32 NumUnbatched = 0;
+
+		for (TObjectIterator<UMinimalClient> It; It; ++It)
+		{
+			UMyNetDriver* MyNetDriver = Cast<UMyNetDriver>(It->GetNetDriver());
+
+			if (MyNetDriver != nullptr)
+			{
+				(MyNetDriver->IsSocketBatching() ? BatchedStats : UnbatchedStats).Merge(MyNetDriver->GetSocketStats());
+				(MyNetDriver->IsSocketBatching() ? NumBatched : NumUnbatched)++;
+			}
+		}
+
+		if (NumBatched > 0)
+		{
+			UE_LOG(LogNetworkTester, Log, TEXT("Socket: %i batched drivers (batch size %i), per driver %s"), NumBatched,
+				UMyNetDriver::GetSocketBatchSize(), *BatchedStats.ToString());
+		}
+
+		if (NumUnbatched > 0)
+		{
+			UE_LOG(LogNetworkTester, Log, TEXT("Socket: %i unbatched drivers, per driver %s"), NumUnbatched, *UnbatchedStats.ToString());
+		}
+	}));
@@ -0,0 +1,107 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectMacros.h"
+#include "OnlineSubsystemUtils/Classes/IpNetDriver.h"
+#include "NetSocketBatcher.h"
+#include "MyNetDriver.generated.h"
+
+
+/**
+ * The net driver of minimal clients: an IpNetDriver which also receives the packets of connections linked through the
+ * in-process loopback transport (see FNetLoopbackTransport), rather than through the socket.
+ *
+ * When connecting on Linux with a socket batch size set, the server connection's packets go through an FNetSocketBatcher
+ * instead of the engine socket, receiving and sending up to the batch size per recvmmsg/sendmmsg.
+ *
+ * Either way the engine socket stays open and UIpNetDriver::TickDispatch still runs in full (it also handles socket errors
+ * and address resolution); with nothing sent to the socket, its receive loop costs one empty recvfrom per tick, which is
+ * counted in the socket stats.
+ */
+UCLASS(transient, config=Engine)
+class UMyNetDriver : public UIpNetDriver
+{
+	GENERATED_UCLASS_BODY()
+
+public:
+	virtual bool InitConnect(FNetworkNotify* InNotify, const FURL& ConnectURL, FString& Error) override;
+
+	virtual void TickDispatch(float DeltaTime) override;
+
+	virtual void TickFlush(float DeltaSeconds) override;
+
+	virtual void Shutdown() override;
+
+	/**
+	 * Sets the most packets per recvmmsg/sendmmsg, for net drivers connecting from now on (Linux only)
+	 *
+	 * @param InBatchSize	The batch size (up to FNetSocketBatcher::MaxBatchSize), or 0 to use the engine socket (one syscall per packet)
+	 */
+	static void SetSocketBatchSize(int32 InBatchSize);
+
+	static int32 GetSocketBatchSize()
+	{
+		return SocketBatchSize;
+	}
+
+	bool IsSocketBatching() const
+	{
+		return SocketBatcher.IsOpen();
+	}
+
+	/** Queues a packet (already processed by the PacketHandler) on the batching socket, sent at the end of TickFlush */
+	void SendBatched(const uint8* Data, int32 CountBytes)
+	{
+		SocketBatcher.Send(Data, CountBytes);
+	}
+
+	/** Counts a packet sent through the engine socket, for comparing against batching */
+	void NotifyUnbatchedSend()
+	{
+		UnbatchedStats.SendSyscalls++;
+		UnbatchedStats.SendPackets++;
+	}
+
+	/** Counts a packet a connection received, if it came from polling the engine socket */
+	void NotifyUnbatchedReceive()
+	{
+		if (bPollingEngineSocket)
+		{
+			GetSocketStats().RecvSyscalls++;
+			GetSocketStats().RecvPackets++;
+		}
+	}
+
+	/** @return The syscall accounting of the batching socket (plus the engine socket's polls), or of the engine socket when not batching */
+	const FNetSocketBatchStats& GetSocketStats() const
+	{
+		return SocketBatcher.IsOpen() ? SocketBatcher.GetStats() : UnbatchedStats;
+	}
+
+	FNetSocketBatchStats& GetSocketStats()
+	{
+		return SocketBatcher.IsOpen() ? SocketBatcher.GetStats() : UnbatchedStats;
+	}
+
+	/** @return The local port packets are sent from, as seen by the server */
+	int32 GetLocalPort();
+
+private:
+	/** The socket batch size of net drivers connecting from now on */
+	static int32 SocketBatchSize;
+
+	/** The batching socket, when connected with batching */
+	FNetSocketBatcher SocketBatcher;
+
+	/**
+	 * Sends and receives through the engine socket. UIpNetDriver reads the socket one recvfrom per packet, plus the one
+	 * finding it empty, so receives are counted as such from the packets connections get while it is polled.
+	 */
+	FNetSocketBatchStats UnbatchedStats;
+
+	/** Whether or not UIpNetDriver::TickDispatch is currently polling the engine socket */
+	bool bPollingEngineSocket;
+};
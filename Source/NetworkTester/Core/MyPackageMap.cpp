@@ -4,6 +4,8 @@
 #include "GameFramework/Actor.h"
 
 #include "MinimalClient.h"
+#include "NetworkTesterTrace.h"
+#include "PackageMapProfiler.h"
 
 
 UMyPackageMapClient::UMyPackageMapClient(const FObjectInitializer& ObjectInitializer)
@@ -17,16 +19,77 @@ UMyPackageMapClient::UMyPackageMapClient(const FObjectInitializer& ObjectInitial
 
 bool UMyPackageMapClient::SerializeObject(FArchive& Ar, UClass* InClass, UObject*& Obj, FNetworkGUID* OutNetGUID)
 {
-	return Super::SerializeObject(Ar, InClass, Obj, OutNetGUID);
+	NETTESTER_TRACE_SCOPE(UMyPackageMapClient_SerializeObject);
+
+	const bool bProfile = MinClient != nullptr && FPackageMapProfiler::IsEnabled();
+	const int64 StartBits = bProfile ? FPackageMapProfiler::GetArchiveBits(Ar) : 0;
+	const uint64 StartCycles = bProfile ? FPlatformTime::Cycles64() : 0;
+
+	const bool bReturnVal = Super::SerializeObject(Ar, InClass, Obj, OutNetGUID);
+
+	if (bProfile)
+	{
+		// When loading, the object is only known after serialization
+		const UClass* ObjClass = Obj != nullptr ? Obj->GetClass() : InClass;
+
+		MinClient->NotifyPackageMapSerialize(EPackageMapProfileCategory::Object, ObjClass != nullptr ? ObjClass->GetFName() : NAME_None,
+			FPackageMapProfiler::GetArchiveBits(Ar) - StartBits, FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles),
+			Ar.IsSaving());
+	}
+
+	return bReturnVal;
 }
 
 bool UMyPackageMapClient::SerializeName(FArchive& Ar, FName& InName)
 {
-	return Super::SerializeName(Ar, InName);
+	NETTESTER_TRACE_SCOPE(UMyPackageMapClient_SerializeName);
+
+	const bool bProfile = MinClient != nullptr && FPackageMapProfiler::IsEnabled();
+	const int64 StartBits = bProfile ? FPackageMapProfiler::GetArchiveBits(Ar) : 0;
+	const uint64 StartCycles = bProfile ? FPlatformTime::Cycles64() : 0;
+	bool bSerializedName = false;
+	bool bReturnVal = true;
+
+	// Hooks may serialize the name themselves before serialization, which skips the default serialization
+	OnSerializeName.Broadcast(true, bSerializedName, Ar, InName);
+
+	if (!bSerializedName)
+	{
+		bReturnVal = Super::SerializeName(Ar, InName);
+		bSerializedName = true;
+	}
+
+	OnSerializeName.Broadcast(false, bSerializedName, Ar, InName);
+
+	if (bProfile)
+	{
+		MinClient->NotifyPackageMapSerialize(EPackageMapProfileCategory::Name, InName, FPackageMapProfiler::GetArchiveBits(Ar) - StartBits,
+			FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles), Ar.IsSaving());
+	}
+
+	return bReturnVal;
 }
 
 bool UMyPackageMapClient::SerializeNewActor(FArchive& Ar, class UActorChannel* Channel, class AActor*& Actor)
 {
-	return Super::SerializeNewActor(Ar, Channel, Actor);
-}
+	NETTESTER_TRACE_SCOPE(UMyPackageMapClient_SerializeNewActor);
+
+	const bool bProfile = MinClient != nullptr && FPackageMapProfiler::IsEnabled();
+	const int64 StartBits = bProfile ? FPackageMapProfiler::GetArchiveBits(Ar) : 0;
+	const uint64 StartCycles = bProfile ? FPlatformTime::Cycles64() : 0;
+
+	bWithinSerializeNewActor = true;
 
+	const bool bReturnVal = Super::SerializeNewActor(Ar, Channel, Actor);
+
+	bWithinSerializeNewActor = false;
+
+	if (bProfile)
+	{
+		MinClient->NotifyPackageMapSerialize(EPackageMapProfileCategory::NewActor,
+			Actor != nullptr ? Actor->GetClass()->GetFName() : NAME_None, FPackageMapProfiler::GetArchiveBits(Ar) - StartBits,
+			FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles), Ar.IsSaving());
+	}
+
+	return bReturnVal;
+}
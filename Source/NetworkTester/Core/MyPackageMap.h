@@ -28,6 +28,7 @@ DECLARE_MULTICAST_DELEGATE_FourParams(FOnSerializeName, bool /*bPreSerialize*/,
 
 /**
  * Package map override, for blocking the creation of actor channels for specific actors (by detecting the actor class being created.)
+ * Also profiles the NetGUID/name serialization cost of the connection, per class and name (see FPackageMapProfiler).
  */
 UCLASS(transient)
 class UMyPackageMapClient : public UPackageMapClient
@@ -0,0 +1,151 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+//
+
+#include "NetConditionSimulator.h"
+
+#include "Algo/UpperBound.h"
+
+
+static TArray<FNetConditionProfile>& GetMutableProfiles()
+{
+	static TArray<FNetConditionProfile> Profiles = []()
+	{
+		TArray<FNetConditionProfile> ReturnVal;
+		FNetConditionProfile Profile;
+
+		Profile.Name = TEXT("Off");
+		ReturnVal.Add(Profile);
+
+		Profile.Name = TEXT("LAN");
+		Profile.LatencyMs = 1;
+		Profile.JitterMs = 1;
+		ReturnVal.Add(Profile);
+
+		Profile.Name = TEXT("Transatlantic");
+		Profile.LatencyMs = 45;
+		Profile.JitterMs = 5;
+		Profile.LossPercent = 0.5f;
+		ReturnVal.Add(Profile);
+
+		Profile.Name = TEXT("Mobile3G");
+		Profile.LatencyMs = 100;
+		Profile.JitterMs = 40;
+		Profile.LossPercent = 2.f;
+		Profile.DuplicatePercent = 0.5f;
+		Profile.ReorderPercent = 1.f;
+		ReturnVal.Add(Profile);
+
+		Profile.Name = TEXT("LossyWifi");
+		Profile.LatencyMs = 5;
+		Profile.JitterMs = 20;
+		Profile.LossPercent = 5.f;
+		Profile.DuplicatePercent = 1.f;
+		Profile.ReorderPercent = 2.f;
+		ReturnVal.Add(Profile);
+
+		return ReturnVal;
+	}();
+
+	return Profiles;
+}
+
+const TArray<FNetConditionProfile>& FNetConditionSimulator::GetProfiles()
+{
+	return GetMutableProfiles();
+}
+
+const FNetConditionProfile* FNetConditionSimulator::FindProfile(FName InName)
+{
+	return GetMutableProfiles().FindByPredicate([InName](const FNetConditionProfile& CurProfile)
+		{
+			return CurProfile.Name == InName;
+		});
+}
+
+void FNetConditionSimulator::RegisterProfile(const FNetConditionProfile& InProfile)
+{
+	TArray<FNetConditionProfile>& Profiles = GetMutableProfiles();
+	FNetConditionProfile* Existing = Profiles.FindByPredicate([&InProfile](const FNetConditionProfile& CurProfile)
+		{
+			return CurProfile.Name == InProfile.Name;
+		});
+
+	if (Existing != nullptr)
+	{
+		*Existing = InProfile;
+	}
+	else
+	{
+		Profiles.Add(InProfile);
+	}
+}
+
+FNetConditionSimulator::FNetConditionSimulator()
+	: Random(0)
+{
+}
+
+void FNetConditionSimulator::SetProfile(const FNetConditionProfile& InProfile, int32 Seed)
+{
+	Profile = InProfile;
+	Random.Initialize(Seed);
+}
+
+void FNetConditionSimulator::Enqueue(const void* Data, int32 NumBits, const FOutPacketTraits& Traits, double CurTime)
+{
+	Stats.NumPackets++;
+
+	if (Random.FRand() * 100.f < Profile.LossPercent)
+	{
+		Stats.NumDropped++;
+		return;
+	}
+
+	double ReleaseTime = CurTime + GetDelay();
+
+	if (Random.FRand() * 100.f < Profile.ReorderPercent)
+	{
+		// Hold the packet back by more than the jitter range, so that the packets sent after it overtake it
+		ReleaseTime += (Profile.JitterMs + FMath::Max(Profile.LatencyMs / 2, 5)) / 1000.0;
+	}
+
+	// Counted on the packets that overtake, so reorders from the jitter alone are counted too
+	if (AddPending(Data, NumBits, Traits, ReleaseTime))
+	{
+		Stats.NumReordered++;
+	}
+
+	if (Random.FRand() * 100.f < Profile.DuplicatePercent)
+	{
+		AddPending(Data, NumBits, Traits, CurTime + GetDelay());
+		Stats.NumDuplicated++;
+	}
+}
+
+bool FNetConditionSimulator::AddPending(const void* Data, int32 NumBits, const FOutPacketTraits& Traits, double ReleaseTime)
+{
+	const int32 InsertIndex = Algo::UpperBoundBy(Pending, ReleaseTime, [](const FDelayedPacket& CurPacket)
+		{
+			return CurPacket.ReleaseTime;
+		});
+	const bool bReturnVal = InsertIndex < Pending.Num();
+
+	FDelayedPacket& NewPacket = Pending.InsertDefaulted_GetRef(InsertIndex);
+
+	NewPacket.ReleaseTime = ReleaseTime;
+	NewPacket.NumBits = NumBits;
+	NewPacket.Traits = Traits;
+	if (FreeBuffers.Num() > 0)
+	{
+		NewPacket.Data = FreeBuffers.Pop(false);
+	}
+
+	NewPacket.Data.Append((const uint8*)Data, (NumBits + 7) / 8);
+
+	return bReturnVal;
+}
+
+double FNetConditionSimulator::GetDelay()
+{
+	return (Profile.LatencyMs + (Profile.JitterMs > 0 ? Random.RandRange(0, Profile.JitterMs) : 0)) / 1000.0;
+}
@@ -0,0 +1,154 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Math/RandomStream.h"
+#include "PacketTraits.h"
+
+
+/** A named set of network conditions, applied independently to each direction of a connection */
+struct FNetConditionProfile
+{
+	FName Name;
+
+	/** Added one-way latency, in milliseconds (the round trip grows by twice this) */
+	int32 LatencyMs = 0;
+
+	/** Random extra one-way latency, in milliseconds (0 to JitterMs) */
+	int32 JitterMs = 0;
+
+	/** Chance (0-100) of a packet being dropped */
+	float LossPercent = 0.f;
+
+	/** Chance (0-100) of a packet being delivered twice */
+	float DuplicatePercent = 0.f;
+
+	/** Chance (0-100) of a packet being held back, so that later packets overtake it */
+	float ReorderPercent = 0.f;
+
+	bool IsEnabled() const
+	{
+		return LatencyMs > 0 || JitterMs > 0 || LossPercent > 0.f || DuplicatePercent > 0.f || ReorderPercent > 0.f;
+	}
+};
+
+
+/**
+ * Applies an FNetConditionProfile to the packets of one direction of one connection.
+ * Unlike the driver-wide PktLag/PktLoss settings, every connection (and so every swarm bot) can have its own profile.
+ */
+class NETWORKTESTER_API FNetConditionSimulator
+{
+public:
+	/** Counters of what the simulator did to the packets */
+	struct FStats
+	{
+		uint64 NumPackets = 0;
+		uint64 NumDropped = 0;
+		uint64 NumDuplicated = 0;
+
+		/** Packets that overtook an already queued packet - from ReorderPercent or from jitter alone */
+		uint64 NumReordered = 0;
+	};
+
+	/** @return The built-in and registered profiles */
+	static const TArray<FNetConditionProfile>& GetProfiles();
+
+	/** @return The profile with the specified name, or nullptr */
+	static const FNetConditionProfile* FindProfile(FName InName);
+
+	/** Adds (or replaces) a named profile */
+	static void RegisterProfile(const FNetConditionProfile& InProfile);
+
+	FNetConditionSimulator();
+
+	/**
+	 * Sets the conditions to apply. Packets already delayed keep their release time.
+	 *
+	 * @param InProfile		The conditions
+	 * @param Seed			Seed for the random decisions, so runs are repeatable
+	 */
+	void SetProfile(const FNetConditionProfile& InProfile, int32 Seed);
+
+	bool IsEnabled() const
+	{
+		return Profile.IsEnabled();
+	}
+
+	const FNetConditionProfile& GetProfile() const
+	{
+		return Profile;
+	}
+
+	const FStats& GetStats() const
+	{
+		return Stats;
+	}
+
+	/** Takes a packet in, deciding whether it is dropped, duplicated, and when it is released */
+	void Enqueue(const void* Data, int32 NumBits, const FOutPacketTraits& Traits, double CurTime);
+
+	/** Hands every packet due by CurTime to ReleaseFunc(uint8* Data, int32 NumBits, FOutPacketTraits& Traits), in release order */
+	template<typename FuncType>
+	void Release(double CurTime, FuncType&& ReleaseFunc)
+	{
+		int32 NumReleased = 0;
+
+		while (NumReleased < Pending.Num() && Pending[NumReleased].ReleaseTime <= CurTime)
+		{
+			FDelayedPacket& CurPacket = Pending[NumReleased];
+
+			ReleaseFunc(CurPacket.Data.GetData(), CurPacket.NumBits, CurPacket.Traits);
+			NumReleased++;
+
+			// Keep the buffer for a later packet
+			CurPacket.Data.Reset();
+			FreeBuffers.Add(MoveTemp(CurPacket.Data));
+		}
+
+		if (NumReleased > 0)
+		{
+			Pending.RemoveAt(0, NumReleased, false);
+		}
+	}
+
+	/** @return The number of packets waiting to be released */
+	int32 GetNumPending() const
+	{
+		return Pending.Num();
+	}
+
+private:
+	struct FDelayedPacket
+	{
+		double ReleaseTime;
+		int32 NumBits;
+		FOutPacketTraits Traits;
+		TArray<uint8> Data;
+	};
+
+	/**
+	 * Adds a packet, keeping Pending sorted by release time
+	 *
+	 * @return	Whether the packet was queued ahead of an already queued packet (i.e. it overtakes it)
+	 */
+	bool AddPending(const void* Data, int32 NumBits, const FOutPacketTraits& Traits, double ReleaseTime);
+
+	/** @return A random one-way delay (in seconds), including jitter */
+	double GetDelay();
+
+private:
+	FNetConditionProfile Profile;
+
+	FRandomStream Random;
+
+	/** Delayed packets, sorted by release time */
+	TArray<FDelayedPacket> Pending;
+
+	/** Buffers of released packets, reused by later packets so that steady traffic never allocates */
+	TArray<TArray<uint8>> FreeBuffers;
+
+	FStats Stats;
+};
@@ -0,0 +1,101 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+//
+
+#include "NetLatencyHistogram.h"
+
+
+void FNetLatencyHistogram::AddSample(uint64 Micros)
+{
+	const uint64 Value = FMath::Min(Micros, MaxValue);
+
+	Buckets[GetBucketIndex(Value)]++;
+
+	Count++;
+	Sum += Value;
+	Min = FMath::Min(Min, Value);
+	Max = FMath::Max(Max, Value);
+}
+
+void FNetLatencyHistogram::Merge(const FNetLatencyHistogram& Other)
+{
+	for (int32 i = 0; i < NumBuckets; i++)
+	{
+		Buckets[i] += Other.Buckets[i];
+	}
+
+	Count += Other.Count;
+	Sum += Other.Sum;
+	Min = FMath::Min(Min, Other.Min);
+	Max = FMath::Max(Max, Other.Max);
+}
+
+void FNetLatencyHistogram::Reset()
+{
+	FMemory::Memzero(Buckets, sizeof(Buckets));
+
+	Count = 0;
+	Sum = 0;
+	Min = MAX_uint64;
+	Max = 0;
+}
+
+uint64 FNetLatencyHistogram::GetPercentile(double Percentile) const
+{
+	uint64 ReturnVal = 0;
+
+	if (Count > 0)
+	{
+		const uint64 TargetCount = FMath::Max<uint64>(1, (uint64)FMath::CeilToDouble(FMath::Clamp(Percentile, 0.0, 100.0) / 100.0 * Count));
+		uint64 RunningCount = 0;
+
+		for (int32 i = 0; i < NumBuckets; i++)
+		{
+			RunningCount += Buckets[i];
+
+			if (RunningCount >= TargetCount)
+			{
+				ReturnVal = FMath::Min(GetBucketUpperBound(i), Max);
+				break;
+			}
+		}
+	}
+
+	return ReturnVal;
+}
+
+FString FNetLatencyHistogram::ToString() const
+{
+	return FString::Printf(TEXT("n: %llu p50: %.3fms p90: %.3fms p99: %.3fms p99.9: %.3fms max: %.3fms"), Count,
+		GetPercentile(50.0) / 1000.0, GetPercentile(90.0) / 1000.0, GetPercentile(99.0) / 1000.0,
+		GetPercentile(99.9) / 1000.0, GetMax() / 1000.0);
+}
+
+int32 FNetLatencyHistogram::GetBucketIndex(uint64 Value)
+{
+	int32 ReturnVal = (int32)Value;
+
+	if (Value >= SubBucketCount)
+	{
+		const int32 Exponent = (int32)FMath::FloorLog2_64(Value);
+		const int32 Mantissa = (int32)(Value >> (Exponent - 4));
+
+		ReturnVal = (Exponent - 3) * SubBucketCount + (Mantissa - SubBucketCount);
+	}
+
+	return ReturnVal;
+}
+
+uint64 FNetLatencyHistogram::GetBucketUpperBound(int32 Index)
+{
+	uint64 ReturnVal = (uint64)Index;
+
+	if (Index >= SubBucketCount)
+	{
+		const int32 Exponent = Index / SubBucketCount + 3;
+		const uint64 Mantissa = (uint64)(Index % SubBucketCount + SubBucketCount);
+
+		ReturnVal = ((Mantissa + 1) << (Exponent - 4)) - 1;
+	}
+
+	return ReturnVal;
+}
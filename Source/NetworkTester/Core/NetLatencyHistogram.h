@@ -0,0 +1,77 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+
+/**
+ * Log-bucketed latency histogram (HDR-style), recording microsecond samples with ~6% precision.
+ *
+ * Values up to 31us are recorded exactly, above that every power of two is split into 16 linear sub-buckets.
+ * Histograms are fixed-size, so recording never allocates, and they can be merged across connections/bots.
+ */
+struct NETWORKTESTER_API FNetLatencyHistogram
+{
+	/** The number of linear sub-buckets per power of two */
+	static constexpr int32 SubBucketCount = 16;
+
+	/** The largest recordable value (larger values are clamped), ~19 hours */
+	static constexpr uint64 MaxValue = (1ull << 36) - 1;
+
+	/** Total number of buckets needed to cover [0, MaxValue] */
+	static constexpr int32 NumBuckets = (36 - 3) * SubBucketCount;
+
+	FNetLatencyHistogram()
+	{
+		Reset();
+	}
+
+	/** Records a single sample, in microseconds */
+	void AddSample(uint64 Micros);
+
+	/** Adds all samples of another histogram to this one */
+	void Merge(const FNetLatencyHistogram& Other);
+
+	void Reset();
+
+	uint64 GetCount() const
+	{
+		return Count;
+	}
+
+	uint64 GetMin() const
+	{
+		return Count > 0 ? Min : 0;
+	}
+
+	uint64 GetMax() const
+	{
+		return Max;
+	}
+
+	double GetMean() const
+	{
+		return Count > 0 ? (double)Sum / (double)Count : 0.0;
+	}
+
+	/** @return The (upper bound) value in microseconds, below which the specified percentage (0-100) of samples fall */
+	uint64 GetPercentile(double Percentile) const;
+
+	/** @return A one line summary of p50/p90/p99/p99.9/max, in milliseconds */
+	FString ToString() const;
+
+private:
+	static int32 GetBucketIndex(uint64 Value);
+
+	static uint64 GetBucketUpperBound(int32 Index);
+
+private:
+	uint64 Buckets[NumBuckets];
+
+	uint64 Count;
+	uint64 Sum;
+	uint64 Min;
+	uint64 Max;
+};
@@ -0,0 +1,95 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+//
+
+#include "NetLoopbackTransport.h"
+
+#include "HAL/CriticalSection.h"
+#include "Misc/ScopeLock.h"
+
+
+/** Client endpoints waiting to be accepted, keyed by client and server port */
+static TMap<TPair<int32, int32>, TSharedPtr<FNetLoopbackEndpoint, ESPMode::ThreadSafe>> GPendingLoopbackClients;
+
+static FCriticalSection GPendingLoopbackClientsLock;
+
+
+FNetLoopbackEndpoint::FNetLoopbackEndpoint()
+	: bLinked(false)
+	, bClosed(false)
+	, NumSent(0)
+	, NumReceived(0)
+{
+}
+
+void FNetLoopbackEndpoint::Link(const TSharedPtr<FNetLoopbackEndpoint, ESPMode::ThreadSafe>& A,
+	const TSharedPtr<FNetLoopbackEndpoint, ESPMode::ThreadSafe>& B)
+{
+	check(A.IsValid() && B.IsValid() && !A->IsLinked() && !B->IsLinked());
+
+	A->Peer = B;
+	B->Peer = A;
+
+	// Released after the peers are set, so that no thread acquiring bLinked sees it without its Peer
+	A->bLinked.store(true, std::memory_order_release);
+	B->bLinked.store(true, std::memory_order_release);
+}
+
+bool FNetLoopbackEndpoint::Send(const uint8* Data, int32 CountBytes)
+{
+	bool bReturnVal = false;
+
+	if (IsLinked() && Peer.IsValid() && !Peer->bClosed.load(std::memory_order_acquire))
+	{
+		FNetLoopbackPacket Packet;
+
+		Packet.Data.Append(Data, CountBytes);
+
+		bReturnVal = Peer->Inbound.Enqueue(MoveTemp(Packet));
+
+		NumSent++;
+	}
+
+	return bReturnVal;
+}
+
+void FNetLoopbackEndpoint::Close()
+{
+	bClosed.store(true, std::memory_order_release);
+
+	// Only this end reads its Peer after linking, so releasing it here can't race - and breaks the reference cycle
+	if (IsLinked())
+	{
+		Peer.Reset();
+	}
+}
+
+
+void FNetLoopbackTransport::RegisterClient(int32 ClientPort, int32 ServerPort, const TSharedPtr<FNetLoopbackEndpoint, ESPMode::ThreadSafe>& Endpoint)
+{
+	FScopeLock ScopeLock(&GPendingLoopbackClientsLock);
+
+	GPendingLoopbackClients.Add(TPair<int32, int32>(ClientPort, ServerPort), Endpoint);
+}
+
+void FNetLoopbackTransport::UnregisterClient(const TSharedPtr<FNetLoopbackEndpoint, ESPMode::ThreadSafe>& Endpoint)
+{
+	FScopeLock ScopeLock(&GPendingLoopbackClientsLock);
+
+	for (auto It = GPendingLoopbackClients.CreateIterator(); It; ++It)
+	{
+		if (It.Value() == Endpoint)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+TSharedPtr<FNetLoopbackEndpoint, ESPMode::ThreadSafe> FNetLoopbackTransport::ClaimClient(int32 ClientPort, int32 ServerPort)
+{
+	TSharedPtr<FNetLoopbackEndpoint, ESPMode::ThreadSafe> ReturnVal;
+	FScopeLock ScopeLock(&GPendingLoopbackClientsLock);
+
+	GPendingLoopbackClients.RemoveAndCopyValue(TPair<int32, int32>(ClientPort, ServerPort), ReturnVal);
+
+	return ReturnVal;
+}
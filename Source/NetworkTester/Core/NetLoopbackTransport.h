@@ -0,0 +1,134 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Queue.h"
+
+#include <atomic>
+
+
+/** A packet in flight over a loopback link, as processed by the sender's PacketHandler */
+struct FNetLoopbackPacket
+{
+	TArray<uint8> Data;
+};
+
+
+/**
+ * One end of an in-process link between a client and a server connection, which replaces the socket beneath them.
+ *
+ * Each end owns a lock-free queue of the packets sent to it: the peer's thread is its only producer, and the thread
+ * ticking its own connection is its only consumer. Links are made once, and published with bLinked (stored with release
+ * semantics after Peer is set, and loaded with acquire semantics before Peer is read).
+ */
+class NETWORKTESTER_API FNetLoopbackEndpoint
+{
+public:
+	FNetLoopbackEndpoint();
+
+	/**
+	 * Links two endpoints, after which each sends to the other
+	 *
+	 * @param A		The first endpoint (not yet linked)
+	 * @param B		The second endpoint (not yet linked)
+	 */
+	static void Link(const TSharedPtr<FNetLoopbackEndpoint, ESPMode::ThreadSafe>& A, const TSharedPtr<FNetLoopbackEndpoint, ESPMode::ThreadSafe>& B);
+
+	bool IsLinked() const
+	{
+		return bLinked.load(std::memory_order_acquire);
+	}
+
+	/**
+	 * Queues a packet on the peer (called by the thread ticking this end)
+	 *
+	 * @param Data			The packet data, as it would be written to the socket
+	 * @param CountBytes	The size of the packet
+	 * @return				Whether or not the packet was queued (false once the peer has closed)
+	 */
+	bool Send(const uint8* Data, int32 CountBytes);
+
+	/**
+	 * Dequeues every packet sent to this end (called by the thread ticking this end)
+	 *
+	 * @param Func	Called with each packet's data and size in bytes
+	 * @return		The number of packets received
+	 */
+	template<typename FuncType>
+	int32 Receive(FuncType&& Func)
+	{
+		int32 ReturnVal = 0;
+		FNetLoopbackPacket Packet;
+
+		while (Inbound.Dequeue(Packet))
+		{
+			Func(Packet.Data.GetData(), Packet.Data.Num());
+			ReturnVal++;
+		}
+
+		NumReceived += ReturnVal;
+
+		return ReturnVal;
+	}
+
+	/** Stops accepting packets, and releases the peer (called by the thread ticking this end) */
+	void Close();
+
+	uint64 GetNumSent() const
+	{
+		return NumSent;
+	}
+
+	uint64 GetNumReceived() const
+	{
+		return NumReceived;
+	}
+
+private:
+	/** Packets sent to this end */
+	TQueue<FNetLoopbackPacket, EQueueMode::Spsc> Inbound;
+
+	/** The other end, only read once bLinked is set */
+	TSharedPtr<FNetLoopbackEndpoint, ESPMode::ThreadSafe> Peer;
+
+	std::atomic<bool> bLinked;
+	std::atomic<bool> bClosed;
+
+	/** Packets sent/received by this end (written by the thread ticking it, read approximately by reports) */
+	uint64 NumSent;
+	uint64 NumReceived;
+};
+
+
+/**
+ * Matches up loopback client connections with the listen server connections accepting them.
+ *
+ * The handshake still goes over the sockets: a client registers its endpoint under its socket's port, and the server
+ * claims it when it accepts a connection from that port, after which both connections send through the link.
+ */
+class NETWORKTESTER_API FNetLoopbackTransport
+{
+public:
+	/**
+	 * Registers a client endpoint, waiting for a server to accept it
+	 *
+	 * @param ClientPort	The port of the client's socket
+	 * @param ServerPort	The port the client is connecting to
+	 * @param Endpoint		The client connection's endpoint
+	 */
+	static void RegisterClient(int32 ClientPort, int32 ServerPort, const TSharedPtr<FNetLoopbackEndpoint, ESPMode::ThreadSafe>& Endpoint);
+
+	/** Removes a client endpoint which is no longer waiting (e.g. because its connection was cleaned up) */
+	static void UnregisterClient(const TSharedPtr<FNetLoopbackEndpoint, ESPMode::ThreadSafe>& Endpoint);
+
+	/**
+	 * Claims a registered client endpoint
+	 *
+	 * @param ClientPort	The port the accepted connection came from
+	 * @param ServerPort	The port the server is listening on
+	 * @return				The waiting client endpoint, or nullptr if the client is not using the loopback transport
+	 */
+	static TSharedPtr<FNetLoopbackEndpoint, ESPMode::ThreadSafe> ClaimClient(int32 ClientPort, int32 ServerPort);
+};
@@ -0,0 +1,243 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+//
+
+#include "NetPacketReplay.h"
+
+#include "HAL/IConsoleManager.h"
+#include "Engine/NetDriver.h"
+#include "MinimalClient.h"
+#include "MyConnection.h"
+#include "MyNetDriver.h"
+#include "NetPacketTrace.h"
+
+
+/** @return Why packets captured by a connection with these flags can't be replayed, or nullptr if they can */
+static const TCHAR* GetReplayRejectReason(ENetPacketTraceFlags Flags)
+{
+	const TCHAR* ReturnVal = nullptr;
+
+	if (EnumHasAnyFlags(Flags, ENetPacketTraceFlags::ServerConnection))
+	{
+		ReturnVal = TEXT("it was captured on the server side, and replay drives a client connection");
+	}
+	else if (!EnumHasAnyFlags(Flags, ENetPacketTraceFlags::Handshake))
+	{
+		ReturnVal = TEXT("it was opened before capture started, so its handshake and initial sequence state are missing");
+	}
+
+	return ReturnVal;
+}
+
+bool FNetPacketReplay::Run(const FNetPacketReplayConfig& Config, FNetPacketReplayResult& OutResult)
+{
+	FNetPacketTraceReader Reader;
+
+	if (!Reader.Open(Config.TraceFile))
+	{
+		return false;
+	}
+
+	const FNetPacketTraceHeader& Header = Reader.GetHeader();
+
+	// The header is only filled in by a closed trace, the record flags are checked either way
+	if (Header.RecordBytes > 0 && !EnumHasAnyFlags(Header.Roles, ENetPacketTraceRoles::Client))
+	{
+		UE_LOG(LogNetworkTester, Warning, TEXT("Replay: rejected '%s', it only holds server side connections"), *Config.TraceFile);
+		return false;
+	}
+
+	const FNetPacketTraceRecord* Record = nullptr;
+	const uint8* Data = nullptr;
+	uint32 ConnectionId = Config.ConnectionId;
+	const TCHAR* RejectReason = nullptr;
+	uint32 RejectedConnectionId = 0;
+	bool bFound = false;
+
+	// Pick the first connection which received anything and can be replayed, or validate the requested one
+	while (!bFound && Reader.Next(Record, Data))
+	{
+		if (Record->Direction != ENetPacketDirection::Incoming || (ConnectionId != 0 && Record->ConnectionId != ConnectionId))
+		{
+			continue;
+		}
+
+		const TCHAR* RecordRejectReason = GetReplayRejectReason(Record->Flags);
+
+		if (RecordRejectReason == nullptr)
+		{
+			ConnectionId = Record->ConnectionId;
+			bFound = true;
+		}
+		else if (RejectReason == nullptr)
+		{
+			RejectReason = RecordRejectReason;
+			RejectedConnectionId = Record->ConnectionId;
+
+			// A connection's flags never change, so the requested one is settled by its first packet
+			if (ConnectionId != 0)
+			{
+				break;
+			}
+		}
+	}
+
+	if (!bFound)
+	{
+		if (RejectReason != nullptr)
+		{
+			UE_LOG(LogNetworkTester, Warning, TEXT("Replay: rejected connection %u of '%s', %s"), RejectedConnectionId,
+				*Config.TraceFile, RejectReason);
+		}
+		else
+		{
+			UE_LOG(LogNetworkTester, Warning, TEXT("Replay: no incoming packets in '%s'"), *Config.TraceFile);
+		}
+
+		return false;
+	}
+
+	// Build the same channel/package map stack as a real minimal client, but never put anything on the wire
+	UMinimalClient* ReplayClient = NewObject<UMinimalClient>();
+
+	ReplayClient->AddToRoot();
+	ReplayClient->bDropOutgoingPackets = true;
+
+	// The replay loop below ticks the driver by hand on this thread, and feeds its connection directly - so no net thread,
+	// and neither the batching socket nor the loopback link may stand in for the connection's transport
+	ReplayClient->bLoopbackTransport = false;
+
+	const int32 OldSocketBatchSize = UMyNetDriver::GetSocketBatchSize();
+	bool bSuccess = false;
+
+	UMyNetDriver::SetSocketBatchSize(0);
+
+	{
+		TGuardValue<float> NetThreadRateGuard(UMinimalClient::DefaultNetThreadRate, 0.f);
+
+		bSuccess = ReplayClient->Connect(TEXT("127.0.0.1"), 7777);
+	}
+
+	UMyNetDriver::SetSocketBatchSize(OldSocketBatchSize);
+
+	check(!ReplayClient->IsUsingNetThread());
+
+	UNetDriver* ReplayDriver = ReplayClient->GetNetDriver();
+	UMyConnection* ReplayConn = ReplayDriver != nullptr ? Cast<UMyConnection>(ReplayDriver->ServerConnection) : nullptr;
+
+	bSuccess = bSuccess && ReplayConn != nullptr;
+
+	if (bSuccess)
+	{
+		const double FrameSeconds = FMath::Max(Config.FrameSeconds, 0.0001);
+		const double ReplayStartTime = FPlatformTime::Seconds();
+		double FirstPacketTime = -1.0;
+		double FrameEndTime = 0.0;
+		TArray<uint8> PacketBuffer;
+
+		Reader.Rewind();
+
+		while (Reader.Next(Record, Data))
+		{
+			if (Record->ConnectionId != ConnectionId || Record->Direction != ENetPacketDirection::Incoming)
+			{
+				continue;
+			}
+
+			const double PacketTime = Reader.GetRecordSeconds(*Record);
+
+			if (FirstPacketTime < 0.0)
+			{
+				FirstPacketTime = PacketTime;
+				FrameEndTime = PacketTime + FrameSeconds;
+
+				ReplayDriver->TickDispatch((float)FrameSeconds);
+			}
+
+			// Advance the virtual clock one frame at a time, up to this packet
+			while (PacketTime >= FrameEndTime)
+			{
+				ReplayDriver->PostTickDispatch();
+				ReplayDriver->TickFlush((float)FrameSeconds);
+				ReplayDriver->PostTickFlush();
+
+				ReplayDriver->TickDispatch((float)FrameSeconds);
+
+				FrameEndTime += FrameSeconds;
+				OutResult.NumFrames++;
+			}
+
+			// The receive path may modify the packet in place (e.g. PacketHandler), so never hand it the mapped trace
+			const int32 NumBytes = (int32)((Record->NumBits + 7) / 8);
+
+			PacketBuffer.SetNumUninitialized(NumBytes, false);
+			FMemory::Memcpy(PacketBuffer.GetData(), Data, NumBytes);
+
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+
+			ReplayConn->ReceivedRawPacket(PacketBuffer.GetData(), NumBytes);
+
+			const double PacketSeconds = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles);
+
+			OutResult.ReceiveSeconds += PacketSeconds;
+			OutResult.PacketNanos.AddSample((uint64)(PacketSeconds * 1000000000.0));
+			OutResult.NumPackets++;
+			OutResult.NumBytes += NumBytes;
+			OutResult.CapturedSeconds = PacketTime - FirstPacketTime;
+		}
+
+		if (OutResult.NumPackets > 0)
+		{
+			ReplayDriver->PostTickDispatch();
+			ReplayDriver->TickFlush((float)FrameSeconds);
+			ReplayDriver->PostTickFlush();
+			OutResult.NumFrames++;
+		}
+
+		OutResult.NumBunches = ReplayConn->NumReceivedBunches;
+		OutResult.TotalSeconds = FPlatformTime::Seconds() - ReplayStartTime;
+	}
+	else
+	{
+		UE_LOG(LogNetworkTester, Warning, TEXT("Replay: failed to create the replay connection"));
+	}
+
+	ReplayClient->Cleanup();
+	ReplayClient->RemoveFromRoot();
+
+	return bSuccess;
+}
+
+void FNetPacketReplay::LogResult(const FNetPacketReplayResult& Result)
+{
+	const double Packets = (double)FMath::Max<uint64>(Result.NumPackets, 1);
+	const double Bunches = (double)FMath::Max<uint64>(Result.NumBunches, 1);
+
+	UE_LOG(LogNetworkTester, Log, TEXT("Replay: %llu packets (%llu bytes), %llu bunches, %llu frames, %.3fs captured replayed in %.3fs"),
+		Result.NumPackets, Result.NumBytes, Result.NumBunches, Result.NumFrames, Result.CapturedSeconds, Result.TotalSeconds);
+
+	UE_LOG(LogNetworkTester, Log, TEXT("Replay: receive %.1f ns/packet, %.1f ns/bunch (p50: %llu ns p99: %llu ns max: %llu ns)"),
+		Result.ReceiveSeconds * 1000000000.0 / Packets, Result.ReceiveSeconds * 1000000000.0 / Bunches,
+		Result.PacketNanos.GetPercentile(50.0), Result.PacketNanos.GetPercentile(99.0), Result.PacketNanos.GetMax());
+}
+
+
+static FAutoConsoleCommand PacketReplayCommand(
+	TEXT("NetTester.Replay"),
+	TEXT("Replays the incoming packets of a captured connection, and logs receive-path cost. Usage: NetTester.Replay <TraceFile> [ConnectionId] [FrameMs]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		FNetPacketReplayConfig Config;
+		FNetPacketReplayResult Result;
+
+		if (Args.Num() > 0)
+		{
+			Config.TraceFile = Args[0];
+			Config.ConnectionId = Args.Num() > 1 ? (uint32)FCString::Atoi(*Args[1]) : 0;
+			Config.FrameSeconds = Args.Num() > 2 ? FCString::Atod(*Args[2]) / 1000.0 : Config.FrameSeconds;
+
+			if (FNetPacketReplay::Run(Config, Result))
+			{
+				FNetPacketReplay::LogResult(Result);
+			}
+		}
+	}));
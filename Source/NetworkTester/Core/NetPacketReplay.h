@@ -0,0 +1,72 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NetLatencyHistogram.h"
+
+
+/** Settings for a packet trace replay */
+struct FNetPacketReplayConfig
+{
+	/** The packet trace to replay */
+	FString TraceFile;
+
+	/** The captured connection whose incoming packets are replayed, or 0 for the first replayable connection in the trace */
+	uint32 ConnectionId = 0;
+
+	/** The virtual time (in seconds) per net driver tick - packets captured within one frame are received within one tick */
+	double FrameSeconds = 1.0 / 60.0;
+};
+
+/** Receive-path cost measured by a packet trace replay */
+struct FNetPacketReplayResult
+{
+	uint64 NumPackets = 0;
+
+	uint64 NumBytes = 0;
+
+	/** Bunches received by the minimal client's chat/actor channels */
+	uint64 NumBunches = 0;
+
+	/** The number of virtual frames (net driver ticks) replayed */
+	uint64 NumFrames = 0;
+
+	/** Wall time (in seconds) spent inside ReceivedRawPacket */
+	double ReceiveSeconds = 0.0;
+
+	/** Wall time (in seconds) of the whole replay, including net driver ticks */
+	double TotalSeconds = 0.0;
+
+	/** The time span (in seconds) the replayed packets covered when captured */
+	double CapturedSeconds = 0.0;
+
+	/** ReceivedRawPacket cost per packet, in nanoseconds */
+	FNetLatencyHistogram PacketNanos;
+};
+
+
+/**
+ * Deterministically replays the incoming packets of one captured connection into a fresh minimal client connection,
+ * on a virtual clock and as fast as possible, to benchmark the engine's receive path without any remote peer.
+ *
+ * The whole capture is replayed, including the stateless handshake, so the new connection ends up in the same
+ * sequence state as the captured one. Everything the replay connection sends is discarded. Only client side connections
+ * opened while capturing can be replayed - the trace records both, and anything else is rejected with the reason logged.
+ */
+class NETWORKTESTER_API FNetPacketReplay
+{
+public:
+	/**
+	 * Runs a replay to completion
+	 *
+	 * @param Config		What to replay
+	 * @param OutResult		Receives the measured costs
+	 * @return				Whether or not the trace could be replayed
+	 */
+	static bool Run(const FNetPacketReplayConfig& Config, FNetPacketReplayResult& OutResult);
+
+	// Writes a replay result to the log
+	static void LogResult(const FNetPacketReplayResult& Result);
+};
@@ -0,0 +1,375 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+//
+
+#include "NetPacketTrace.h"
+
+#include "Async/MappedFileHandle.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/DateTime.h"
+#include "Misc/Paths.h"
+#include "MinimalClient.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/AllowWindowsPlatformTypes.h"
+#include <windows.h>
+#include "Windows/HideWindowsPlatformTypes.h"
+#elif PLATFORM_UNIX || PLATFORM_MAC
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+
+FNetPacketTraceWriter& FNetPacketTraceWriter::Get()
+{
+	static FNetPacketTraceWriter Singleton;
+
+	return Singleton;
+}
+
+FNetPacketTraceWriter::FNetPacketTraceWriter()
+	: bCapturing(false)
+	, MappedData(nullptr)
+	, MappedSize(0)
+	, WriteOffset(0)
+	, NumWritesInFlight(0)
+	, NumRecords(0)
+	, NumDroppedRecords(0)
+	, Roles(0)
+	, bIncludesHandshakes(1)
+	, CaptureId(0)
+	, FileHandle(nullptr)
+	, MappingHandle(nullptr)
+{
+}
+
+FNetPacketTraceWriter::~FNetPacketTraceWriter()
+{
+	Close();
+}
+
+bool FNetPacketTraceWriter::Open(const FString& Filename, uint64 CapacityBytes)
+{
+	Close();
+
+	const FString FullFilename = FPaths::ConvertRelativePathToFull(Filename);
+	const uint64 Size = FMath::Max<uint64>(CapacityBytes, sizeof(FNetPacketTraceHeader));
+
+	IFileManager::Get().MakeDirectory(*FPaths::GetPath(FullFilename), true);
+
+	if (!MapFile(FullFilename, Size))
+	{
+		UE_LOG(LogNetworkTester, Warning, TEXT("PacketTrace: failed to map '%s' (%llu bytes)"), *FullFilename, Size);
+		return false;
+	}
+
+	FNetPacketTraceHeader* Header = (FNetPacketTraceHeader*)MappedData;
+
+	Header->Magic = FNetPacketTraceHeader::ExpectedMagic;
+	Header->Version = FNetPacketTraceHeader::ExpectedVersion;
+	Header->SecondsPerCycle = FPlatformTime::GetSecondsPerCycle64();
+	Header->StartCycles = FPlatformTime::Cycles64();
+	Header->RecordBytes = 0;
+	Header->NumDroppedRecords = 0;
+	Header->Roles = ENetPacketTraceRoles::None;
+	Header->bIncludesHandshakes = 0;
+
+	WriteOffset = sizeof(FNetPacketTraceHeader);
+	NumRecords = 0;
+	NumDroppedRecords = 0;
+	Roles = 0;
+	bIncludesHandshakes = 1;
+	FPlatformAtomics::InterlockedIncrement(&CaptureId);
+
+	FPlatformMisc::MemoryBarrier();
+	bCapturing = true;
+
+	UE_LOG(LogNetworkTester, Log, TEXT("PacketTrace: capturing to '%s' (%llu MB)"), *FullFilename, Size >> 20);
+
+	return true;
+}
+
+void FNetPacketTraceWriter::Close()
+{
+	if (MappedData == nullptr)
+	{
+		return;
+	}
+
+	bCapturing = false;
+	FPlatformMisc::MemoryBarrier();
+
+	while (FPlatformAtomics::AtomicRead(&NumWritesInFlight) > 0)
+	{
+		FPlatformProcess::YieldThread();
+	}
+
+	const uint64 FinalSize = (uint64)WriteOffset;
+	FNetPacketTraceHeader* Header = (FNetPacketTraceHeader*)MappedData;
+
+	Header->RecordBytes = FinalSize - sizeof(FNetPacketTraceHeader);
+	Header->NumDroppedRecords = (uint64)NumDroppedRecords;
+	Header->Roles = (ENetPacketTraceRoles)Roles;
+	Header->bIncludesHandshakes = NumRecords > 0 ? (uint32)bIncludesHandshakes : 0;
+
+	UE_LOG(LogNetworkTester, Log, TEXT("PacketTrace: closed, %lld records (%llu bytes), %lld dropped"), NumRecords,
+		Header->RecordBytes, NumDroppedRecords);
+
+	UnmapFile(FinalSize);
+}
+
+void FNetPacketTraceWriter::WriteRecord(uint32 ConnectionId, ENetPacketDirection Direction, ENetPacketTraceFlags Flags,
+	const void* Data, uint32 NumBits)
+{
+	// Register as in-flight before re-checking, so that Close can't unmap underneath us
+	FPlatformAtomics::InterlockedIncrement(&NumWritesInFlight);
+
+	if (bCapturing)
+	{
+		const int64 RecordSize = (int64)FNetPacketTraceRecord::GetRecordSize(NumBits);
+		int64 RecordOffset = FPlatformAtomics::AtomicRead(&WriteOffset);
+		bool bReserved = false;
+
+		// Only advance the offset when the record fits, so the file always ends on a whole record
+		while (RecordOffset + RecordSize <= (int64)MappedSize)
+		{
+			const int64 PrevOffset = FPlatformAtomics::InterlockedCompareExchange(&WriteOffset, RecordOffset + RecordSize, RecordOffset);
+
+			if (PrevOffset == RecordOffset)
+			{
+				bReserved = true;
+				break;
+			}
+
+			RecordOffset = PrevOffset;
+		}
+
+		if (bReserved)
+		{
+			FNetPacketTraceRecord* Record = (FNetPacketTraceRecord*)(MappedData + RecordOffset);
+
+			Record->Cycles = FPlatformTime::Cycles64();
+			Record->ConnectionId = ConnectionId;
+			Record->Direction = Direction;
+			Record->NumBits = NumBits;
+			Record->Flags = Flags;
+
+			FMemory::Memcpy(Record + 1, Data, (NumBits + 7) / 8);
+
+			FPlatformAtomics::InterlockedIncrement(&NumRecords);
+
+			// Read first, so the shared flags are only written (contended) when they change
+			const int32 RecordRole = (int32)(EnumHasAnyFlags(Flags, ENetPacketTraceFlags::ServerConnection) ? ENetPacketTraceRoles::Server : ENetPacketTraceRoles::Client);
+
+			if ((FPlatformAtomics::AtomicRead(&Roles) & RecordRole) == 0)
+			{
+				FPlatformAtomics::InterlockedOr(&Roles, RecordRole);
+			}
+
+			if (!EnumHasAnyFlags(Flags, ENetPacketTraceFlags::Handshake) && FPlatformAtomics::AtomicRead(&bIncludesHandshakes) != 0)
+			{
+				FPlatformAtomics::InterlockedExchange(&bIncludesHandshakes, 0);
+			}
+		}
+		else
+		{
+			FPlatformAtomics::InterlockedIncrement(&NumDroppedRecords);
+		}
+	}
+
+	FPlatformAtomics::InterlockedDecrement(&NumWritesInFlight);
+}
+
+bool FNetPacketTraceWriter::MapFile(const FString& Filename, uint64 Size)
+{
+#if PLATFORM_WINDOWS
+	HANDLE File = CreateFileW(*Filename, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS,
+		FILE_ATTRIBUTE_NORMAL, nullptr);
+
+	if (File != INVALID_HANDLE_VALUE)
+	{
+		HANDLE Mapping = CreateFileMappingW(File, nullptr, PAGE_READWRITE, (DWORD)(Size >> 32), (DWORD)(Size & 0xFFFFFFFF), nullptr);
+		void* View = Mapping != nullptr ? MapViewOfFile(Mapping, FILE_MAP_WRITE, 0, 0, (SIZE_T)Size) : nullptr;
+
+		if (View != nullptr)
+		{
+			FileHandle = File;
+			MappingHandle = Mapping;
+			MappedData = (uint8*)View;
+			MappedSize = Size;
+		}
+		else
+		{
+			if (Mapping != nullptr)
+			{
+				CloseHandle(Mapping);
+			}
+
+			CloseHandle(File);
+		}
+	}
+#elif PLATFORM_UNIX || PLATFORM_MAC
+	int File = open(TCHAR_TO_UTF8(*Filename), O_RDWR | O_CREAT | O_TRUNC, 0644);
+
+	if (File >= 0)
+	{
+		void* View = ftruncate(File, (off_t)Size) == 0 ? mmap(nullptr, Size, PROT_READ | PROT_WRITE, MAP_SHARED, File, 0) : MAP_FAILED;
+
+		if (View != MAP_FAILED)
+		{
+			FileHandle = (void*)(PTRINT)File;
+			MappedData = (uint8*)View;
+			MappedSize = Size;
+		}
+		else
+		{
+			close(File);
+		}
+	}
+#endif
+
+	return MappedData != nullptr;
+}
+
+void FNetPacketTraceWriter::UnmapFile(uint64 FinalSize)
+{
+#if PLATFORM_WINDOWS
+	UnmapViewOfFile(MappedData);
+	CloseHandle((HANDLE)MappingHandle);
+
+	LARGE_INTEGER FileSize;
+
+	FileSize.QuadPart = (LONGLONG)FinalSize;
+
+	SetFilePointerEx((HANDLE)FileHandle, FileSize, nullptr, FILE_BEGIN);
+	SetEndOfFile((HANDLE)FileHandle);
+	CloseHandle((HANDLE)FileHandle);
+#elif PLATFORM_UNIX || PLATFORM_MAC
+	const int File = (int)(PTRINT)FileHandle;
+
+	munmap(MappedData, MappedSize);
+
+	if (ftruncate(File, (off_t)FinalSize) != 0)
+	{
+		UE_LOG(LogNetworkTester, Warning, TEXT("PacketTrace: failed to truncate trace to %llu bytes"), FinalSize);
+	}
+
+	close(File);
+#endif
+
+	MappedData = nullptr;
+	MappedSize = 0;
+	FileHandle = nullptr;
+	MappingHandle = nullptr;
+}
+
+
+FNetPacketTraceReader::FNetPacketTraceReader()
+	: FileHandle(nullptr)
+	, FileRegion(nullptr)
+	, MappedData(nullptr)
+	, EndOffset(0)
+	, ReadOffset(0)
+{
+}
+
+FNetPacketTraceReader::~FNetPacketTraceReader()
+{
+	Close();
+}
+
+bool FNetPacketTraceReader::Open(const FString& Filename)
+{
+	Close();
+
+	FileHandle = FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*Filename);
+
+	if (FileHandle != nullptr && FileHandle->GetFileSize() >= (int64)sizeof(FNetPacketTraceHeader))
+	{
+		FileRegion = FileHandle->MapRegion(0, FileHandle->GetFileSize());
+	}
+
+	if (FileRegion != nullptr)
+	{
+		MappedData = FileRegion->GetMappedPtr();
+
+		const FNetPacketTraceHeader& Header = GetHeader();
+		const uint64 FileSize = (uint64)FileRegion->GetMappedSize();
+
+		if (Header.Magic == FNetPacketTraceHeader::ExpectedMagic && Header.Version == FNetPacketTraceHeader::ExpectedVersion)
+		{
+			// An unclosed trace has no RecordBytes, and is zero filled past the last record
+			EndOffset = Header.RecordBytes > 0 ? FMath::Min((uint64)sizeof(FNetPacketTraceHeader) + Header.RecordBytes, FileSize) : FileSize;
+			Rewind();
+		}
+		else
+		{
+			UE_LOG(LogNetworkTester, Warning, TEXT("PacketTrace: '%s' is not a packet trace (or has an unsupported version)"), *Filename);
+			Close();
+		}
+	}
+	else
+	{
+		UE_LOG(LogNetworkTester, Warning, TEXT("PacketTrace: failed to map '%s'"), *Filename);
+		Close();
+	}
+
+	return MappedData != nullptr;
+}
+
+void FNetPacketTraceReader::Close()
+{
+	delete FileRegion;
+	FileRegion = nullptr;
+
+	delete FileHandle;
+	FileHandle = nullptr;
+
+	MappedData = nullptr;
+	EndOffset = 0;
+	ReadOffset = 0;
+}
+
+bool FNetPacketTraceReader::Next(const FNetPacketTraceRecord*& OutRecord, const uint8*& OutData)
+{
+	bool bSuccess = false;
+
+	if (MappedData != nullptr && ReadOffset + sizeof(FNetPacketTraceRecord) <= EndOffset)
+	{
+		const FNetPacketTraceRecord* Record = (const FNetPacketTraceRecord*)(MappedData + ReadOffset);
+		const uint64 RecordSize = FNetPacketTraceRecord::GetRecordSize(Record->NumBits);
+
+		if (Record->Cycles != 0 && ReadOffset + RecordSize <= EndOffset)
+		{
+			OutRecord = Record;
+			OutData = (const uint8*)(Record + 1);
+			ReadOffset += RecordSize;
+			bSuccess = true;
+		}
+	}
+
+	return bSuccess;
+}
+
+
+static FAutoConsoleCommand PacketTraceStartCommand(
+	TEXT("NetTester.Trace.Start"),
+	TEXT("Captures every raw packet of every minimal client connection. Usage: NetTester.Trace.Start [Filename] [CapacityMB]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		FString Filename = Args.Num() > 0 ? Args[0] :
+			FPaths::ProjectSavedDir() / TEXT("NetworkTester") / FString::Printf(TEXT("PacketTrace_%s.ntpt"), *FDateTime::Now().ToString());
+		const uint64 CapacityMB = Args.Num() > 1 ? (uint64)FCString::Atoi64(*Args[1]) : 256;
+
+		FNetPacketTraceWriter::Get().Open(Filename, CapacityMB << 20);
+	}));
+
+static FAutoConsoleCommand PacketTraceStopCommand(
+	TEXT("NetTester.Trace.Stop"),
+	TEXT("Stops raw packet capture, and finalizes the trace file."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		FNetPacketTraceWriter::Get().Close();
+	}));
@@ -0,0 +1,254 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+
+/**
+ * The direction of a captured packet. The two directions are captured at different layers: incoming packets are the
+ * wire bytes (still carrying the sender's PacketHandler processing), outgoing packets are what the connection built,
+ * before its own PacketHandler processed them - so an outgoing record is not what the peer receives.
+ */
+enum class ENetPacketDirection : uint32
+{
+	/** The wire bytes, as received from the socket (ReceivedRawPacket, before the PacketHandler undoes its processing) */
+	Incoming,
+
+	/** As passed to LowLevelSend, before the PacketHandler processes it into the wire bytes */
+	Outgoing
+};
+
+/** Describes the connection which captured a record */
+enum class ENetPacketTraceFlags : uint32
+{
+	None = 0,
+
+	/** Captured by a server's connection to a client (otherwise by a client's connection to its server) */
+	ServerConnection = 0x1,
+
+	/** The connection was opened while capturing, so the trace holds its whole handshake */
+	Handshake = 0x2
+};
+
+ENUM_CLASS_FLAGS(ENetPacketTraceFlags);
+
+/** The roles of the connections captured into a trace */
+enum class ENetPacketTraceRoles : uint32
+{
+	None = 0,
+	Client = 0x1,
+	Server = 0x2
+};
+
+ENUM_CLASS_FLAGS(ENetPacketTraceRoles);
+
+/** The header at the start of a packet trace file */
+struct FNetPacketTraceHeader
+{
+	static constexpr uint32 ExpectedMagic = 0x5450544E; // 'NTPT'
+	static constexpr uint32 ExpectedVersion = 2;
+
+	uint32 Magic;
+	uint32 Version;
+
+	/** FPlatformTime::GetSecondsPerCycle64 of the capturing machine, for converting record timestamps */
+	double SecondsPerCycle;
+
+	/** FPlatformTime::Cycles64 when capture started */
+	uint64 StartCycles;
+
+	/** Bytes of records following the header (only valid once the trace has been closed) */
+	uint64 RecordBytes;
+
+	/** Records dropped because the trace was full */
+	uint64 NumDroppedRecords;
+
+	/** The roles of the connections captured (only valid once the trace has been closed) */
+	ENetPacketTraceRoles Roles;
+
+	/** Whether or not every captured connection was opened while capturing (only valid once the trace has been closed) */
+	uint32 bIncludesHandshakes;
+};
+
+/** The header of every packet record, followed by the packet data padded to 8 bytes */
+struct FNetPacketTraceRecord
+{
+	/** FPlatformTime::Cycles64 when the packet was captured */
+	uint64 Cycles;
+
+	/** UMyConnection::ConnectionId of the capturing connection */
+	uint32 ConnectionId;
+
+	ENetPacketDirection Direction;
+
+	/** The size of the packet data in bits */
+	uint32 NumBits;
+
+	ENetPacketTraceFlags Flags;
+
+	/** @return The size of the record including its data, as laid out in the file */
+	static uint64 GetRecordSize(uint32 InNumBits)
+	{
+		return sizeof(FNetPacketTraceRecord) + Align((uint64)(InNumBits + 7) / 8, 8);
+	}
+};
+
+
+/**
+ * Append-only capture of raw packets into a fixed-size memory-mapped file.
+ *
+ * Writers reserve space with a compare-and-swap loop on the write offset (so a record which does not fit never moves
+ * it) and copy straight into the mapping, so capturing never locks, allocates or touches the file system; records which
+ * do not fit are dropped and counted.
+ */
+class NETWORKTESTER_API FNetPacketTraceWriter
+{
+public:
+	/** @return The capture shared by every UMyConnection */
+	static FNetPacketTraceWriter& Get();
+
+	~FNetPacketTraceWriter();
+
+	/**
+	 * Creates and maps the trace file, and starts capturing
+	 *
+	 * @param Filename		The trace file to create (overwritten if it exists)
+	 * @param CapacityBytes	The size of the mapping - capture stops once this is full
+	 * @return				Whether or not capture started
+	 */
+	bool Open(const FString& Filename, uint64 CapacityBytes);
+
+	/** Stops capturing, waits for in-flight writes, and truncates the file to the captured size */
+	void Close();
+
+	bool IsCapturing() const
+	{
+		return bCapturing;
+	}
+
+	/** Appends a packet to the trace (does nothing if not capturing) */
+	void Write(uint32 ConnectionId, ENetPacketDirection Direction, ENetPacketTraceFlags Flags, const void* Data, uint32 NumBits)
+	{
+		if (bCapturing)
+		{
+			WriteRecord(ConnectionId, Direction, Flags, Data, NumBits);
+		}
+	}
+
+	/** @return The id of the current (or last) capture, incremented by every Open - 0 before the first one */
+	uint32 GetCaptureId() const
+	{
+		return (uint32)CaptureId;
+	}
+
+	uint64 GetNumRecords() const
+	{
+		return (uint64)NumRecords;
+	}
+
+	uint64 GetNumDroppedRecords() const
+	{
+		return (uint64)NumDroppedRecords;
+	}
+
+private:
+	FNetPacketTraceWriter();
+
+	void WriteRecord(uint32 ConnectionId, ENetPacketDirection Direction, ENetPacketTraceFlags Flags, const void* Data, uint32 NumBits);
+
+	/** Platform specific mapping of the file */
+	bool MapFile(const FString& Filename, uint64 Size);
+
+	void UnmapFile(uint64 FinalSize);
+
+private:
+	/** Whether or not Write calls are accepted */
+	volatile bool bCapturing;
+
+	/** The start of the mapped file */
+	uint8* MappedData;
+
+	/** The size of the mapping */
+	uint64 MappedSize;
+
+	/** The offset of the next record (reserved with a compare-and-swap loop) */
+	volatile int64 WriteOffset;
+
+	/** The number of Write calls currently copying into the mapping */
+	volatile int32 NumWritesInFlight;
+
+	volatile int64 NumRecords;
+	volatile int64 NumDroppedRecords;
+
+	/** ENetPacketTraceRoles of the records written */
+	volatile int32 Roles;
+
+	/** Cleared by the first record of a connection opened before capture started */
+	volatile int32 bIncludesHandshakes;
+
+	volatile int32 CaptureId;
+
+	/** Platform file/mapping handles */
+	void* FileHandle;
+	void* MappingHandle;
+};
+
+
+/**
+ * Sequential reader of a packet trace file, mapped read-only.
+ * Traces which were never closed (e.g. after a crash) are read up to the first unwritten record.
+ */
+class NETWORKTESTER_API FNetPacketTraceReader
+{
+public:
+	FNetPacketTraceReader();
+	~FNetPacketTraceReader();
+
+	/** @return Whether or not the file was mapped, and has a valid header */
+	bool Open(const FString& Filename);
+
+	void Close();
+
+	const FNetPacketTraceHeader& GetHeader() const
+	{
+		return *(const FNetPacketTraceHeader*)MappedData;
+	}
+
+	/**
+	 * Reads the next record
+	 *
+	 * @param OutRecord		Receives the record header
+	 * @param OutData		Receives the packet data following the header
+	 * @return				Whether or not a record was read (false at the end of the trace)
+	 */
+	bool Next(const FNetPacketTraceRecord*& OutRecord, const uint8*& OutData);
+
+	/** Restarts reading from the first record */
+	void Rewind()
+	{
+		ReadOffset = sizeof(FNetPacketTraceHeader);
+	}
+
+	/** @return The time (in seconds) of a record, relative to the start of capture */
+	double GetRecordSeconds(const FNetPacketTraceRecord& Record) const
+	{
+		return (double)(Record.Cycles - GetHeader().StartCycles) * GetHeader().SecondsPerCycle;
+	}
+
+private:
+	IMappedFileHandle* FileHandle;
+	IMappedFileRegion* FileRegion;
+
+	const uint8* MappedData;
+
+	/** The end of the valid records */
+	uint64 EndOffset;
+
+	uint64 ReadOffset;
+};
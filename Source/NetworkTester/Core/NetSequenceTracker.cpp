@@ -0,0 +1,95 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+//
+
+#include "NetSequenceTracker.h"
+
+
+void FNetSequenceTracker::Receive(uint32 Sequence)
+{
+	if (!bHasSequence)
+	{
+		bHasSequence = true;
+		HighestSequence = Sequence;
+		LowestSequence = Sequence;
+		NumReceived++;
+
+		SetInWindow(Sequence, true);
+		return;
+	}
+
+	// Wrap-safe distance from the highest sequence so far
+	const int32 Delta = (int32)(Sequence - HighestSequence);
+
+	if (Delta > 0)
+	{
+		// Forget the sequences the window slides past, so their slots can be reused
+		if ((uint32)Delta >= WindowSize)
+		{
+			FMemory::Memzero(Window, sizeof(Window));
+		}
+		else
+		{
+			for (uint32 i = 1; i <= (uint32)Delta; i++)
+			{
+				SetInWindow(HighestSequence + i, false);
+			}
+		}
+
+		NumLost += (uint64)(Delta - 1);
+		NumReceived++;
+		HighestSequence = Sequence;
+
+		SetInWindow(Sequence, true);
+	}
+	else if (HighestSequence - Sequence >= WindowSize)
+	{
+		NumTooLate++;
+	}
+	else if (IsInWindow(Sequence))
+	{
+		NumDuplicates++;
+	}
+	else if ((int32)(Sequence - LowestSequence) < 0)
+	{
+		// Older than anything received so far, so no gap was counted for it - but the ones up to the lowest are lost now
+		NumReordered++;
+		NumReceived++;
+		NumLost += (uint64)(LowestSequence - Sequence - 1);
+		LowestSequence = Sequence;
+
+		SetInWindow(Sequence, true);
+	}
+	else
+	{
+		// A gap filled in late - it was counted as lost when the later message arrived
+		check(NumLost > 0);
+
+		NumReordered++;
+		NumReceived++;
+		NumLost--;
+
+		SetInWindow(Sequence, true);
+	}
+}
+
+void FNetSequenceTracker::Reset()
+{
+	FMemory::Memzero(Window, sizeof(Window));
+
+	NumReceived = 0;
+	NumLost = 0;
+	NumReordered = 0;
+	NumDuplicates = 0;
+	NumTooLate = 0;
+	HighestSequence = 0;
+	LowestSequence = 0;
+	bHasSequence = false;
+}
+
+void FNetSequenceTracker::SetInWindow(uint32 Sequence, bool bValue)
+{
+	uint64& Bits = Window[(Sequence % WindowSize) / 64];
+	const uint64 Mask = 1ull << (Sequence % 64);
+
+	Bits = bValue ? (Bits | Mask) : (Bits & ~Mask);
+}
@@ -0,0 +1,76 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+
+/**
+ * Tracks the sequence numbers of unreliably delivered messages, counting loss, reordering and duplicates.
+ *
+ * Gaps are counted as lost when a later sequence arrives, and un-counted if the missing message shows up late
+ * (within the window). A message older than the first one received counts the gap up to it as lost instead. A fixed bit window remembers which recent sequences arrived, so tracking never allocates.
+ */
+struct NETWORKTESTER_API FNetSequenceTracker
+{
+	/** The number of recent sequences remembered, for telling late arrivals from duplicates */
+	static constexpr uint32 WindowSize = 1024;
+
+	FNetSequenceTracker()
+	{
+		Reset();
+	}
+
+	/** Records the arrival of a sequence number */
+	void Receive(uint32 Sequence);
+
+	void Reset();
+
+	/** Unique messages received */
+	uint64 NumReceived;
+
+	/** Messages never received (so far) */
+	uint64 NumLost;
+
+	/** Messages received after a later message */
+	uint64 NumReordered;
+
+	/** Messages received more than once */
+	uint64 NumDuplicates;
+
+	/** Messages too late to tell whether they were duplicates (older than the window) */
+	uint64 NumTooLate;
+
+	/** @return The number of messages the peer sent, as far as the sequences received so far show */
+	uint64 GetNumExpected() const
+	{
+		return NumReceived + NumLost;
+	}
+
+	/** @return The percentage of the peer's messages which were received */
+	double GetDeliveryPercent() const
+	{
+		return GetNumExpected() > 0 ? 100.0 * NumReceived / GetNumExpected() : 100.0;
+	}
+
+private:
+	bool IsInWindow(uint32 Sequence) const
+	{
+		return (Window[(Sequence % WindowSize) / 64] & (1ull << (Sequence % 64))) != 0;
+	}
+
+	void SetInWindow(uint32 Sequence, bool bValue);
+
+private:
+	/** Arrival bits of the last WindowSize sequences, indexed by sequence modulo WindowSize */
+	uint64 Window[WindowSize / 64];
+
+	/** The highest sequence received */
+	uint32 HighestSequence;
+
+	/** The lowest sequence received - only gaps between this and HighestSequence were counted as lost */
+	uint32 LowestSequence;
+
+	bool bHasSequence;
+};
@@ -0,0 +1,276 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+//
+
+#include "NetSocketBatcher.h"
+
+#include "IPAddress.h"
+#include "MinimalClient.h"
+
+#if PLATFORM_LINUX
+#include <errno.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+
+struct FNetSocketBatcher::FMessages
+{
+#if PLATFORM_LINUX
+	/** BatchSize message headers, each pointing at its buffer's vector, set up once by Open and reused by every syscall */
+	TArray<mmsghdr> RecvMessages;
+	TArray<iovec> RecvVectors;
+	TArray<mmsghdr> SendMessages;
+	TArray<iovec> SendVectors;
+#endif
+};
+
+
+FString FNetSocketBatchStats::ToString() const
+{
+	const double Ticks = (double)FMath::Max<uint64>(NumTicks, 1);
+
+	return FString::Printf(TEXT("recv %.2f syscalls/tick, %.2f packets/syscall; send %.2f syscalls/tick, %.2f packets/syscall, %llu dropped"),
+		RecvSyscalls / Ticks, RecvSyscalls > 0 ? (double)RecvPackets / RecvSyscalls : 0.0,
+		SendSyscalls / Ticks, SendSyscalls > 0 ? (double)SendPackets / SendSyscalls : 0.0, DroppedSends);
+}
+
+
+bool FNetSocketBatcher::IsSupported()
+{
+	return !!PLATFORM_LINUX;
+}
+
+FNetSocketBatcher::FNetSocketBatcher()
+	: SocketFd(-1)
+	, BatchSize(0)
+	, Messages(MakeUnique<FMessages>())
+{
+}
+
+FNetSocketBatcher::~FNetSocketBatcher()
+{
+	Close();
+}
+
+bool FNetSocketBatcher::Open(const FInternetAddr& ServerAddr, int32 InBatchSize)
+{
+	Close();
+
+#if PLATFORM_LINUX
+	const TArray<uint8> RawIp = ServerAddr.GetRawIp();
+	sockaddr_storage Addr;
+	socklen_t AddrLen = 0;
+
+	FMemory::Memzero(Addr);
+
+	if (RawIp.Num() == 4)
+	{
+		sockaddr_in* Addr4 = (sockaddr_in*)&Addr;
+
+		Addr4->sin_family = AF_INET;
+		Addr4->sin_port = htons((uint16)ServerAddr.GetPort());
+		FMemory::Memcpy(&Addr4->sin_addr, RawIp.GetData(), 4);
+		AddrLen = sizeof(sockaddr_in);
+	}
+	else if (RawIp.Num() == 16)
+	{
+		sockaddr_in6* Addr6 = (sockaddr_in6*)&Addr;
+
+		Addr6->sin6_family = AF_INET6;
+		Addr6->sin6_port = htons((uint16)ServerAddr.GetPort());
+		FMemory::Memcpy(&Addr6->sin6_addr, RawIp.GetData(), 16);
+		AddrLen = sizeof(sockaddr_in6);
+	}
+
+	if (AddrLen > 0)
+	{
+		SocketFd = socket(Addr.ss_family, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_UDP);
+
+		// Connecting lets the kernel filter out datagrams from anyone but the server, and sends need no address
+		if (SocketFd >= 0 && connect(SocketFd, (const sockaddr*)&Addr, AddrLen) != 0)
+		{
+			UE_LOG(LogNetworkTester, Warning, TEXT("SocketBatcher: connect to %s failed (errno %i)"), *ServerAddr.ToString(true), errno);
+
+			close(SocketFd);
+			SocketFd = -1;
+		}
+	}
+
+	if (SocketFd >= 0)
+	{
+		BatchSize = FMath::Clamp(InBatchSize, 1, MaxBatchSize);
+
+		RecvBuffers.SetNumUninitialized(BatchSize * MaxDatagramBytes);
+		SendBuffers.SetNumUninitialized(BatchSize * MaxDatagramBytes);
+		SendSizes.Reset(BatchSize);
+
+		Messages->RecvMessages.SetNumZeroed(BatchSize);
+		Messages->RecvVectors.SetNumUninitialized(BatchSize);
+		Messages->SendMessages.SetNumZeroed(BatchSize);
+		Messages->SendVectors.SetNumUninitialized(BatchSize);
+
+		for (int32 MsgIdx = 0; MsgIdx < BatchSize; MsgIdx++)
+		{
+			Messages->RecvVectors[MsgIdx].iov_base = RecvBuffers.GetData() + MsgIdx * MaxDatagramBytes;
+			Messages->RecvVectors[MsgIdx].iov_len = (size_t)MaxDatagramBytes;
+
+			Messages->RecvMessages[MsgIdx].msg_hdr.msg_iov = &Messages->RecvVectors[MsgIdx];
+			Messages->RecvMessages[MsgIdx].msg_hdr.msg_iovlen = 1;
+
+			Messages->SendVectors[MsgIdx].iov_base = SendBuffers.GetData() + MsgIdx * MaxDatagramBytes;
+			Messages->SendVectors[MsgIdx].iov_len = 0;
+
+			Messages->SendMessages[MsgIdx].msg_hdr.msg_iov = &Messages->SendVectors[MsgIdx];
+			Messages->SendMessages[MsgIdx].msg_hdr.msg_iovlen = 1;
+		}
+
+		Stats = FNetSocketBatchStats();
+	}
+#endif
+
+	return IsOpen();
+}
+
+void FNetSocketBatcher::Close()
+{
+	if (IsOpen())
+	{
+		Flush();
+
+#if PLATFORM_LINUX
+		close(SocketFd);
+#endif
+
+		SocketFd = -1;
+	}
+}
+
+int32 FNetSocketBatcher::GetLocalPort() const
+{
+	int32 ReturnVal = 0;
+
+#if PLATFORM_LINUX
+	sockaddr_storage Addr;
+	socklen_t AddrLen = sizeof(Addr);
+
+	if (IsOpen() && getsockname(SocketFd, (sockaddr*)&Addr, &AddrLen) == 0)
+	{
+		ReturnVal = ntohs(Addr.ss_family == AF_INET6 ? ((sockaddr_in6*)&Addr)->sin6_port : ((sockaddr_in*)&Addr)->sin_port);
+	}
+#endif
+
+	return ReturnVal;
+}
+
+void FNetSocketBatcher::Send(const uint8* Data, int32 CountBytes)
+{
+	if (!IsOpen() || CountBytes <= 0 || CountBytes > MaxDatagramBytes)
+	{
+		Stats.DroppedSends++;
+		return;
+	}
+
+	if (SendSizes.Num() >= BatchSize)
+	{
+		Flush();
+	}
+
+	FMemory::Memcpy(SendBuffers.GetData() + SendSizes.Num() * MaxDatagramBytes, Data, CountBytes);
+	SendSizes.Add(CountBytes);
+}
+
+void FNetSocketBatcher::Flush()
+{
+#if PLATFORM_LINUX
+	const int32 NumQueued = SendSizes.Num();
+
+	if (IsOpen() && NumQueued > 0)
+	{
+		for (int32 MsgIdx = 0; MsgIdx < NumQueued; MsgIdx++)
+		{
+			Messages->SendVectors[MsgIdx].iov_len = (size_t)SendSizes[MsgIdx];
+		}
+
+		int32 NumDone = 0;
+
+		// sendmmsg may send part of the batch, so keep going until it is all sent, or the socket buffer is full
+		while (NumDone < NumQueued)
+		{
+			const int Result = sendmmsg(SocketFd, Messages->SendMessages.GetData() + NumDone, (unsigned int)(NumQueued - NumDone), 0);
+
+			Stats.SendSyscalls++;
+
+			if (Result > 0)
+			{
+				NumDone += Result;
+				Stats.SendPackets += (uint64)Result;
+			}
+			else if (Result < 0 && errno == EINTR)
+			{
+				continue;
+			}
+			else if (Result < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+			{
+				// The first datagram failed (e.g. refused by the server's host) - skip it, and send the rest
+				NumDone++;
+				Stats.DroppedSends++;
+			}
+			else
+			{
+				break;
+			}
+		}
+
+		// UDP semantics: what doesn't fit in the socket buffer now is lost
+		Stats.DroppedSends += (uint64)(NumQueued - NumDone);
+	}
+#endif
+
+	SendSizes.Reset();
+}
+
+void FNetSocketBatcher::Receive(TFunctionRef<void(uint8* /*Data*/, int32 /*CountBytes*/)> Func)
+{
+#if PLATFORM_LINUX
+	if (!IsOpen())
+	{
+		return;
+	}
+
+	while (true)
+	{
+		// The kernel only writes msg_len and msg_flags, so the headers set up by Open are reused as they are
+		const int Result = recvmmsg(SocketFd, Messages->RecvMessages.GetData(), (unsigned int)BatchSize, 0, nullptr);
+
+		Stats.RecvSyscalls++;
+
+		if (Result < 0 && errno == EINTR)
+		{
+			continue;
+		}
+
+		// EAGAIN once the socket is empty - a refused connection (ICMP) is left to the connection timeout
+		if (Result <= 0)
+		{
+			break;
+		}
+
+		for (int32 MsgIdx = 0; MsgIdx < Result; MsgIdx++)
+		{
+			if ((Messages->RecvMessages[MsgIdx].msg_hdr.msg_flags & MSG_TRUNC) == 0 && Messages->RecvMessages[MsgIdx].msg_len > 0)
+			{
+				Func((uint8*)Messages->RecvVectors[MsgIdx].iov_base, (int32)Messages->RecvMessages[MsgIdx].msg_len);
+			}
+		}
+
+		Stats.RecvPackets += (uint64)Result;
+
+		// A partial batch means the socket is empty, which saves the syscall finding that out
+		if (Result < BatchSize || !IsOpen())
+		{
+			break;
+		}
+	}
+#endif
+}
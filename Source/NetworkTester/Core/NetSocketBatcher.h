@@ -0,0 +1,124 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+
+class FInternetAddr;
+
+
+/** Syscall accounting of a net driver's socket I/O */
+struct FNetSocketBatchStats
+{
+	/** TickDispatch calls, the syscalls below are spread over */
+	uint64 NumTicks = 0;
+
+	uint64 RecvSyscalls = 0;
+	uint64 RecvPackets = 0;
+
+	uint64 SendSyscalls = 0;
+	uint64 SendPackets = 0;
+
+	/** Packets which could not be sent (the socket buffer was full) */
+	uint64 DroppedSends = 0;
+
+	void Merge(const FNetSocketBatchStats& Other)
+	{
+		NumTicks += Other.NumTicks;
+		RecvSyscalls += Other.RecvSyscalls;
+		RecvPackets += Other.RecvPackets;
+		SendSyscalls += Other.SendSyscalls;
+		SendPackets += Other.SendPackets;
+		DroppedSends += Other.DroppedSends;
+	}
+
+	/** @return Syscalls per tick and packets per syscall, for both directions */
+	FString ToString() const;
+};
+
+
+/**
+ * A UDP socket connected to one server, which receives with recvmmsg and sends with sendmmsg, up to BatchSize packets
+ * per syscall (Linux only - IsSupported is false elsewhere, and the socket never opens).
+ *
+ * Sends are queued until Flush (or until a batch is full); receives drain the socket a batch at a time. Only used by
+ * the thread ticking the net driver.
+ */
+class NETWORKTESTER_API FNetSocketBatcher
+{
+public:
+	/** The largest datagram received: an Ethernet MTU, above MAX_PACKET_SIZE (larger ones are truncated by the kernel, and dropped) */
+	static constexpr int32 MaxDatagramBytes = 1500;
+
+	/** The most packets per syscall - the buffers take 2 x BatchSize x MaxDatagramBytes per socket */
+	static constexpr int32 MaxBatchSize = 64;
+
+	static bool IsSupported();
+
+	FNetSocketBatcher();
+	~FNetSocketBatcher();
+
+	/**
+	 * Creates the socket, connected to the server
+	 *
+	 * @param ServerAddr	The address (IPv4 or IPv6) of the server
+	 * @param InBatchSize	The most packets per syscall (clamped to MaxBatchSize)
+	 * @return				Whether or not the socket was opened
+	 */
+	bool Open(const FInternetAddr& ServerAddr, int32 InBatchSize);
+
+	/** Sends anything queued, and closes the socket */
+	void Close();
+
+	bool IsOpen() const
+	{
+		return SocketFd >= 0;
+	}
+
+	/** @return The local port the socket is bound to, as seen by the server */
+	int32 GetLocalPort() const;
+
+	/** Queues a datagram, sending the batch first if it is full */
+	void Send(const uint8* Data, int32 CountBytes);
+
+	/** Sends every queued datagram */
+	void Flush();
+
+	/**
+	 * Receives every pending datagram
+	 *
+	 * @param Func	Called with each datagram's data and size in bytes
+	 */
+	void Receive(TFunctionRef<void(uint8* /*Data*/, int32 /*CountBytes*/)> Func);
+
+	const FNetSocketBatchStats& GetStats() const
+	{
+		return Stats;
+	}
+
+	FNetSocketBatchStats& GetStats()
+	{
+		return Stats;
+	}
+
+private:
+	int32 SocketFd;
+
+	int32 BatchSize;
+
+	/** BatchSize datagram buffers each, for receiving and for queued sends */
+	TArray<uint8> RecvBuffers;
+	TArray<uint8> SendBuffers;
+
+	/** The size of each queued send */
+	TArray<int32> SendSizes;
+
+	/** The recvmmsg/sendmmsg message headers, defined with the socket code so that no system header leaks out of this one */
+	struct FMessages;
+
+	TUniquePtr<FMessages> Messages;
+
+	FNetSocketBatchStats Stats;
+};
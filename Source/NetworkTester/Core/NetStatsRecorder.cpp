@@ -0,0 +1,264 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+//
+
+#include "NetStatsRecorder.h"
+
+#include "Async/Async.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Engine/NetDriver.h"
+#include "Engine/NetConnection.h"
+#include "Engine/Channel.h"
+#include "Misc/Paths.h"
+#include "MinimalClient.h"
+#include "MyConnection.h"
+
+
+/** Bytes of formatted text buffered before writing to the file */
+static constexpr int32 StatsWriteBufferSize = 64 * 1024;
+
+/** Longest formatted sample */
+static constexpr int32 StatsMaxLineSize = 512;
+
+
+FNetStatsRecorder::FNetStatsRecorder()
+	: File(nullptr)
+	, Format(ENetStatsFormat::Csv)
+	, Interval(1.0)
+	, StartTime(0.0)
+	, NextSampleTime(0.0)
+	, SamplesPerFlush(64)
+	, NumDroppedSamples(0)
+{
+}
+
+FNetStatsRecorder::~FNetStatsRecorder()
+{
+	Stop();
+}
+
+bool FNetStatsRecorder::Start(const FString& Filename, ENetStatsFormat InFormat, float IntervalSeconds, int32 NumConnections,
+	int32 InSamplesPerFlush)
+{
+	Stop();
+
+	IFileManager::Get().MakeDirectory(*FPaths::GetPath(Filename), true);
+
+	File = FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*Filename);
+
+	if (File != nullptr)
+	{
+		Format = InFormat;
+		Interval = FMath::Max(IntervalSeconds, 0.001f);
+		StartTime = FPlatformTime::Seconds();
+		NextSampleTime = StartTime;
+
+		SamplesPerFlush = FMath::Max(InSamplesPerFlush, 2);
+
+		const int32 Capacity = FMath::Max(NumConnections, 1) * SamplesPerFlush;
+
+		Samples.Empty(Capacity);
+		WritingSamples.Empty(Capacity);
+		NumDroppedSamples = 0;
+
+		WriteBuffer.Reset(StatsWriteBufferSize);
+
+		if (Format == ENetStatsFormat::Csv)
+		{
+			static const ANSICHAR Header[] = "time,conn,in_bytes,out_bytes,in_packets,out_packets,in_bunches,queued_bits,saturated,"
+				"rtt_ms,in_loss_pct,out_loss_pct,reliable_buffer_pct\n";
+
+			AppendText(Header, sizeof(Header) - 1);
+		}
+
+		UE_LOG(LogNetworkTester, Log, TEXT("Stats: recording to '%s'"), *Filename);
+	}
+	else
+	{
+		UE_LOG(LogNetworkTester, Warning, TEXT("Stats: failed to open '%s'"), *Filename);
+	}
+
+	return File != nullptr;
+}
+
+void FNetStatsRecorder::Stop()
+{
+	if (File != nullptr)
+	{
+		if (PendingWrite.IsValid())
+		{
+			PendingWrite.Wait();
+			PendingWrite = TFuture<void>();
+		}
+
+		WriteSamples(Samples);
+
+		Samples.Empty();
+		WritingSamples.Empty();
+
+		delete File;
+		File = nullptr;
+
+		if (NumDroppedSamples > 0)
+		{
+			UE_LOG(LogNetworkTester, Warning, TEXT("Stats: %llu samples were dropped, the file was written too slowly"), NumDroppedSamples);
+		}
+	}
+}
+
+void FNetStatsRecorder::Tick(UNetDriver* Driver, double CurTime)
+{
+	if (File == nullptr || Driver == nullptr || CurTime < NextSampleTime)
+	{
+		return;
+	}
+
+	const int32 NumConnections = Driver->ServerConnection != nullptr ? 1 : Driver->ClientConnections.Num();
+
+	// Hand the samples to the background write once this interval's would not fit
+	if (Samples.Num() + NumConnections > Samples.Max())
+	{
+		Flush(NumConnections);
+	}
+
+	const double SampleTime = CurTime - StartTime;
+	auto AddSample = [this, SampleTime](UNetConnection* Connection)
+		{
+			if (Samples.Num() < Samples.Max())
+			{
+				Samples.AddUninitialized();
+				SampleConnection(Connection, SampleTime, Samples.Last());
+			}
+			else
+			{
+				NumDroppedSamples++;
+			}
+		};
+
+	if (Driver->ServerConnection != nullptr)
+	{
+		AddSample(Driver->ServerConnection);
+	}
+	else
+	{
+		for (UNetConnection* CurConn : Driver->ClientConnections)
+		{
+			AddSample(CurConn);
+		}
+	}
+
+	NextSampleTime += Interval;
+
+	if (NextSampleTime < CurTime)
+	{
+		NextSampleTime = CurTime + Interval;
+	}
+}
+
+void FNetStatsRecorder::SampleConnection(UNetConnection* Connection, double Time, FNetConnectionSample& OutSample)
+{
+	UMyConnection* MyConnection = Cast<UMyConnection>(Connection);
+	int32 MaxOutRec = 0;
+
+	for (UChannel* CurChannel : Connection->OpenChannels)
+	{
+		if (CurChannel != nullptr)
+		{
+			MaxOutRec = FMath::Max(MaxOutRec, CurChannel->NumOutRec);
+		}
+	}
+
+	OutSample.Time = Time;
+	OutSample.ConnectionId = MyConnection != nullptr ? MyConnection->ConnectionId : 0;
+	OutSample.InBytes = (uint64)Connection->InTotalBytes;
+	OutSample.OutBytes = (uint64)Connection->OutTotalBytes;
+	OutSample.InPackets = (uint64)Connection->InTotalPackets;
+	OutSample.OutPackets = (uint64)Connection->OutTotalPackets;
+	OutSample.InBunches = MyConnection != nullptr ? MyConnection->NumReceivedBunches : 0;
+	OutSample.QueuedBits = Connection->QueuedBits;
+	OutSample.bSaturated = !Connection->IsNetReady(false);
+	OutSample.RttMs = Connection->AvgLag * 1000.f;
+	OutSample.InLossPercent = Connection->InTotalPackets > 0 ? 100.f * Connection->InTotalPacketsLost / Connection->InTotalPackets : 0.f;
+	OutSample.OutLossPercent = Connection->OutTotalPackets > 0 ? 100.f * Connection->OutTotalPacketsLost / Connection->OutTotalPackets : 0.f;
+	OutSample.ReliableBufferPercent = 100.f * MaxOutRec / RELIABLE_BUFFER;
+}
+
+void FNetStatsRecorder::Flush(int32 NumConnections)
+{
+	// Still writing the previous buffer, keep filling this one (and drop what doesn't fit) rather than block the tick
+	if (PendingWrite.IsValid() && !PendingWrite.IsReady())
+	{
+		return;
+	}
+
+	Swap(Samples, WritingSamples);
+	Samples.Reset();
+
+	const int32 Capacity = FMath::Max(NumConnections, 1) * SamplesPerFlush;
+
+	PendingWrite = Async(EAsyncExecution::ThreadPool, [this, Capacity]()
+		{
+			WriteSamples(WritingSamples);
+
+			// Sized for the connection count here rather than on the tick, it is swapped in by the next flush
+			if (WritingSamples.Max() < Capacity)
+			{
+				WritingSamples.Empty(Capacity);
+			}
+			else
+			{
+				WritingSamples.Reset();
+			}
+		});
+}
+
+void FNetStatsRecorder::WriteSamples(const TArray<FNetConnectionSample>& InSamples)
+{
+	for (const FNetConnectionSample& CurSample : InSamples)
+	{
+		AppendSample(CurSample);
+	}
+
+	if (File != nullptr && WriteBuffer.Num() > 0)
+	{
+		File->Write((const uint8*)WriteBuffer.GetData(), WriteBuffer.Num());
+		WriteBuffer.Reset();
+	}
+}
+
+void FNetStatsRecorder::AppendSample(const FNetConnectionSample& Sample)
+{
+	ANSICHAR Line[StatsMaxLineSize];
+	int32 Len = 0;
+
+	if (Format == ENetStatsFormat::Csv)
+	{
+		Len = FCStringAnsi::Snprintf(Line, StatsMaxLineSize, "%.3f,%u,%llu,%llu,%llu,%llu,%llu,%d,%d,%.2f,%.2f,%.2f,%.1f\n",
+			Sample.Time, Sample.ConnectionId, Sample.InBytes, Sample.OutBytes, Sample.InPackets, Sample.OutPackets,
+			Sample.InBunches, Sample.QueuedBits, Sample.bSaturated ? 1 : 0, Sample.RttMs, Sample.InLossPercent,
+			Sample.OutLossPercent, Sample.ReliableBufferPercent);
+	}
+	else
+	{
+		Len = FCStringAnsi::Snprintf(Line, StatsMaxLineSize,
+			"{\"time\":%.3f,\"conn\":%u,\"in_bytes\":%llu,\"out_bytes\":%llu,\"in_packets\":%llu,\"out_packets\":%llu,"
+			"\"in_bunches\":%llu,\"queued_bits\":%d,\"saturated\":%s,\"rtt_ms\":%.2f,\"in_loss_pct\":%.2f,"
+			"\"out_loss_pct\":%.2f,\"reliable_buffer_pct\":%.1f}\n",
+			Sample.Time, Sample.ConnectionId, Sample.InBytes, Sample.OutBytes, Sample.InPackets, Sample.OutPackets,
+			Sample.InBunches, Sample.QueuedBits, Sample.bSaturated ? "true" : "false", Sample.RttMs, Sample.InLossPercent,
+			Sample.OutLossPercent, Sample.ReliableBufferPercent);
+	}
+
+	AppendText(Line, FMath::Clamp(Len, 0, StatsMaxLineSize - 1));
+}
+
+void FNetStatsRecorder::AppendText(const ANSICHAR* Text, int32 Len)
+{
+	if (File != nullptr && WriteBuffer.Num() + Len > StatsWriteBufferSize)
+	{
+		File->Write((const uint8*)WriteBuffer.GetData(), WriteBuffer.Num());
+		WriteBuffer.Reset();
+	}
+
+	WriteBuffer.Append(Text, Len);
+}
@@ -0,0 +1,140 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+
+
+class IFileHandle;
+class UNetDriver;
+
+
+/** Output format of recorded connection stats */
+enum class ENetStatsFormat : uint8
+{
+	/** One header row, then one row per sample */
+	Csv,
+
+	/** One JSON object per line */
+	JsonLines
+};
+
+/** One sample of one connection's stats */
+struct FNetConnectionSample
+{
+	/** Seconds since recording started */
+	double Time;
+
+	/** UMyConnection::ConnectionId, or 0 for non minimal client connections */
+	uint32 ConnectionId;
+
+	uint64 InBytes;
+	uint64 OutBytes;
+	uint64 InPackets;
+	uint64 OutPackets;
+
+	/** Bunches received by the chat/actor channels */
+	uint64 InBunches;
+
+	int32 QueuedBits;
+
+	/** Whether or not the connection was saturated (not net ready) */
+	bool bSaturated;
+
+	float RttMs;
+
+	/** Packets lost, as a percentage of the packets sent/received, over the whole connection */
+	float InLossPercent;
+	float OutLossPercent;
+
+	/** Fullest reliable buffer of any open channel, as a percentage of RELIABLE_BUFFER */
+	float ReliableBufferPercent;
+};
+
+
+/**
+ * Samples every connection of a net driver at a fixed interval, into a preallocated buffer which is handed to a
+ * background write (formatting to CSV or JSON-lines, and file I/O) once it can't hold another interval's samples.
+ * Sampling never allocates or touches the file - the buffers are sized to the connection count by the write, off the tick.
+ */
+class NETWORKTESTER_API FNetStatsRecorder
+{
+public:
+	FNetStatsRecorder();
+	~FNetStatsRecorder();
+
+	/**
+	 * Starts recording to a file
+	 *
+	 * @param Filename			The file to write (overwritten)
+	 * @param InFormat			The file format
+	 * @param IntervalSeconds	The time between samples
+	 * @param NumConnections	The number of connections expected, to size the buffers with
+	 * @param InSamplesPerFlush	The number of intervals sampled between background writes
+	 * @return					Whether or not the file could be opened
+	 */
+	bool Start(const FString& Filename, ENetStatsFormat InFormat, float IntervalSeconds, int32 NumConnections = 1,
+		int32 InSamplesPerFlush = 64);
+
+	/** Waits for the background write, writes the pending samples and closes the file */
+	void Stop();
+
+	bool IsRecording() const
+	{
+		return File != nullptr;
+	}
+
+	/** Samples the driver's connections if the interval has elapsed, and hands full buffers to the background write */
+	void Tick(UNetDriver* Driver, double CurTime);
+
+	/** @return The number of samples lost, because the buffer filled up while the background write was still going */
+	uint64 GetNumDroppedSamples() const
+	{
+		return NumDroppedSamples;
+	}
+
+	/** Fills a sample with the current stats of a connection */
+	static void SampleConnection(UNetConnection* Connection, double Time, FNetConnectionSample& OutSample);
+
+private:
+	/** Hands the samples to a background write, unless the previous one is still going */
+	void Flush(int32 NumConnections);
+
+	/** Formats samples and writes them to the file (on the background write, or on Stop) */
+	void WriteSamples(const TArray<FNetConnectionSample>& InSamples);
+
+	/** Formats a sample into the write buffer */
+	void AppendSample(const FNetConnectionSample& Sample);
+
+	void AppendText(const ANSICHAR* Text, int32 Len);
+
+private:
+	IFileHandle* File;
+
+	ENetStatsFormat Format;
+
+	double Interval;
+
+	double StartTime;
+
+	double NextSampleTime;
+
+	/** The number of intervals the buffers hold, for the current number of connections */
+	int32 SamplesPerFlush;
+
+	/** Samples taken since the last flush (never grown by Tick) */
+	TArray<FNetConnectionSample> Samples;
+
+	/** Samples owned by the background write until it is done, then regrown by it and swapped back in by the next flush */
+	TArray<FNetConnectionSample> WritingSamples;
+
+	/** The background write, if one was started */
+	TFuture<void> PendingWrite;
+
+	uint64 NumDroppedSamples;
+
+	/** Formatting buffer, written to the file in one go (only used by the write) */
+	TArray<ANSICHAR> WriteBuffer;
+};
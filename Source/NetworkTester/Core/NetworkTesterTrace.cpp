@@ -0,0 +1,100 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+//
+
+#include "NetworkTesterTrace.h"
+#include "Engine/NetDriver.h"
+#include "MyConnection.h"
+#include "NetStatsRecorder.h"
+
+
+UE_TRACE_CHANNEL_DEFINE(NetworkTesterChannel);
+
+TRACE_DECLARE_INT_COUNTER(NetTester_SentPayloads, TEXT("NetTester/SentPayloads"));
+TRACE_DECLARE_MEMORY_COUNTER(NetTester_SentPayloadBytes, TEXT("NetTester/SentPayloadBytes"));
+TRACE_DECLARE_INT_COUNTER(NetTester_ReceivedBunches, TEXT("NetTester/ReceivedBunches"));
+
+
+#if COUNTERSTRACE_ENABLED
+FNetConnectionTraceCounters::FNetConnectionTraceCounters(uint32 ConnectionId)
+	: InBytes(*FString::Printf(TEXT("NetTester/Conn%u/InBytes"), ConnectionId), TraceCounterDisplayHint_Memory)
+	, OutBytes(*FString::Printf(TEXT("NetTester/Conn%u/OutBytes"), ConnectionId), TraceCounterDisplayHint_Memory)
+	, InBunches(*FString::Printf(TEXT("NetTester/Conn%u/InBunches"), ConnectionId), TraceCounterDisplayHint_None)
+	, QueuedBits(*FString::Printf(TEXT("NetTester/Conn%u/QueuedBits"), ConnectionId), TraceCounterDisplayHint_None)
+	, RttMs(*FString::Printf(TEXT("NetTester/Conn%u/RttMs"), ConnectionId), TraceCounterDisplayHint_None)
+	, InLossPercent(*FString::Printf(TEXT("NetTester/Conn%u/InLossPercent"), ConnectionId), TraceCounterDisplayHint_None)
+	, OutLossPercent(*FString::Printf(TEXT("NetTester/Conn%u/OutLossPercent"), ConnectionId), TraceCounterDisplayHint_None)
+	, ReliableBufferPercent(*FString::Printf(TEXT("NetTester/Conn%u/ReliableBufferPercent"), ConnectionId), TraceCounterDisplayHint_None)
+{
+}
+
+void FNetConnectionTraceCounters::Update(const FNetConnectionSample& Sample)
+{
+	InBytes.Set((int64)Sample.InBytes);
+	OutBytes.Set((int64)Sample.OutBytes);
+	InBunches.Set((int64)Sample.InBunches);
+	QueuedBits.Set(Sample.QueuedBits);
+	RttMs.Set(Sample.RttMs);
+	InLossPercent.Set(Sample.InLossPercent);
+	OutLossPercent.Set(Sample.OutLossPercent);
+	ReliableBufferPercent.Set(Sample.ReliableBufferPercent);
+}
+#else
+FNetConnectionTraceCounters::FNetConnectionTraceCounters(uint32 ConnectionId)
+{
+}
+
+void FNetConnectionTraceCounters::Update(const FNetConnectionSample& Sample)
+{
+}
+#endif
+
+
+bool FNetworkTesterTrace::AreCountersEnabled()
+{
+#if COUNTERSTRACE_ENABLED
+	return UE_TRACE_CHANNELEXPR_IS_ENABLED(NetworkTesterChannel) && UE_TRACE_CHANNELEXPR_IS_ENABLED(CountersChannel);
+#else
+	return false;
+#endif
+}
+
+void FNetworkTesterTrace::UpdateConnectionCounters(UNetDriver* Driver)
+{
+	if (Driver == nullptr || !AreCountersEnabled())
+	{
+		return;
+	}
+
+	NETTESTER_TRACE_SCOPE(NetTester_UpdateConnectionCounters);
+
+	const double CurTime = FPlatformTime::Seconds();
+	FNetConnectionSample Sample;
+
+	auto UpdateConnection = [&](UNetConnection* Connection)
+		{
+			UMyConnection* MyConnection = Cast<UMyConnection>(Connection);
+
+			if (MyConnection != nullptr)
+			{
+				if (!MyConnection->TraceCounters.IsValid())
+				{
+					MyConnection->TraceCounters = MakeUnique<FNetConnectionTraceCounters>(MyConnection->ConnectionId);
+				}
+
+				FNetStatsRecorder::SampleConnection(MyConnection, CurTime, Sample);
+				MyConnection->TraceCounters->Update(Sample);
+			}
+		};
+
+	if (Driver->ServerConnection != nullptr)
+	{
+		UpdateConnection(Driver->ServerConnection);
+	}
+	else
+	{
+		for (UNetConnection* CurConn : Driver->ClientConnections)
+		{
+			UpdateConnection(CurConn);
+		}
+	}
+}
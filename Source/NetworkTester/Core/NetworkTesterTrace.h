@@ -0,0 +1,67 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Trace/Trace.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "ProfilingDebugging/CountersTrace.h"
+
+
+class UNetDriver;
+struct FNetConnectionSample;
+
+
+/**
+ * Unreal Insights channel for the minimal client's network hot paths ("NetworkTester").
+ * Enable it along with the cpu and counters channels, e.g. -trace=cpu,counters,NetworkTester or "Trace.Enable NetworkTester".
+ */
+UE_TRACE_CHANNEL_EXTERN(NetworkTesterChannel, NETWORKTESTER_API);
+
+/** CPU scope, only recorded while the NetworkTester channel is enabled */
+#define NETTESTER_TRACE_SCOPE(Name) TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(Name, NetworkTesterChannel)
+
+/** Totals across every minimal client in the process */
+TRACE_DECLARE_INT_COUNTER_EXTERN(NetTester_SentPayloads);
+TRACE_DECLARE_MEMORY_COUNTER_EXTERN(NetTester_SentPayloadBytes);
+TRACE_DECLARE_INT_COUNTER_EXTERN(NetTester_ReceivedBunches);
+
+
+/**
+ * Insights counters of one connection, named "NetTester/Conn<ConnectionId>/...".
+ * Trace counters register their name when constructed, so these are only created once tracing is running.
+ */
+struct FNetConnectionTraceCounters
+{
+	FNetConnectionTraceCounters(uint32 ConnectionId);
+
+	/** Updates every counter from a sample of the connection */
+	void Update(const FNetConnectionSample& Sample);
+
+#if COUNTERSTRACE_ENABLED
+private:
+	FCountersTrace::FCounterInt InBytes;
+	FCountersTrace::FCounterInt OutBytes;
+	FCountersTrace::FCounterInt InBunches;
+	FCountersTrace::FCounterInt QueuedBits;
+	FCountersTrace::FCounterFloat RttMs;
+	FCountersTrace::FCounterFloat InLossPercent;
+	FCountersTrace::FCounterFloat OutLossPercent;
+	FCountersTrace::FCounterFloat ReliableBufferPercent;
+#endif
+};
+
+
+struct NETWORKTESTER_API FNetworkTesterTrace
+{
+	/** @return Whether or not the NetworkTester and counters channels are both enabled */
+	static bool AreCountersEnabled();
+
+	/**
+	 * Samples every UMyConnection of a net driver into its trace counters (does nothing unless AreCountersEnabled)
+	 *
+	 * @param Driver	The net driver whose connections are sampled
+	 */
+	static void UpdateConnectionCounters(UNetDriver* Driver);
+};
@@ -0,0 +1,131 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+//
+
+#include "PackageMapProfiler.h"
+
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/BitReader.h"
+#include "Serialization/BitWriter.h"
+#include "MinimalClient.h"
+
+
+static const TCHAR* CategoryNames[] = { TEXT("Object"), TEXT("Name"), TEXT("NewActor") };
+
+bool FPackageMapProfiler::bEnabled = false;
+
+
+int64 FPackageMapProfiler::GetArchiveBits(FArchive& Ar)
+{
+	int64 ReturnVal = 0;
+
+	// Only FBitWriter/FBitReader (and the FNetBit* archives derived from them) flag themselves as net archives - there is
+	// no RTTI to check the type with, and any other archive (e.g. a serialization helper's) has no bit position to read
+	if (Ar.IsNetArchive())
+	{
+		ReturnVal = Ar.IsSaving() ? static_cast<FBitWriter&>(Ar).GetNumBits() : static_cast<FBitReader&>(Ar).GetPosBits();
+	}
+
+	return ReturnVal;
+}
+
+void FPackageMapProfiler::Record(EPackageMapProfileCategory Category, FName Key, int64 NumBits, double Seconds, bool bSaving)
+{
+	FPackageMapProfileEntry& Entry = Entries[(int32)Category][bSaving ? 1 : 0].FindOrAdd(Key);
+
+	Entry.NumCalls++;
+	Entry.Bits += (uint64)FMath::Max<int64>(NumBits, 0);
+	Entry.Seconds += Seconds;
+}
+
+void FPackageMapProfiler::Reset()
+{
+	for (int32 CategoryIdx = 0; CategoryIdx < (int32)EPackageMapProfileCategory::Num; CategoryIdx++)
+	{
+		Entries[CategoryIdx][0].Reset();
+		Entries[CategoryIdx][1].Reset();
+	}
+}
+
+TArray<TPair<FName, FPackageMapProfileEntry>> FPackageMapProfiler::GetTop(EPackageMapProfileCategory Category, bool bSaving,
+	int32 TopN) const
+{
+	TArray<TPair<FName, FPackageMapProfileEntry>> ReturnVal = Entries[(int32)Category][bSaving ? 1 : 0].Array();
+
+	ReturnVal.Sort([](const TPair<FName, FPackageMapProfileEntry>& A, const TPair<FName, FPackageMapProfileEntry>& B)
+		{
+			return A.Value.Bits != B.Value.Bits ? A.Value.Bits > B.Value.Bits : A.Value.Seconds > B.Value.Seconds;
+		});
+
+	if (ReturnVal.Num() > TopN)
+	{
+		ReturnVal.SetNum(TopN, false);
+	}
+
+	return ReturnVal;
+}
+
+void FPackageMapProfiler::LogTop(const FString& OwnerName, int32 TopN) const
+{
+	for (int32 CategoryIdx = 0; CategoryIdx < (int32)EPackageMapProfileCategory::Num; CategoryIdx++)
+	{
+		for (int32 Direction = 1; Direction >= 0; Direction--)
+		{
+			const TMap<FName, FPackageMapProfileEntry>& CurEntries = Entries[CategoryIdx][Direction];
+
+			if (CurEntries.Num() == 0)
+			{
+				continue;
+			}
+
+			FPackageMapProfileEntry Total;
+
+			for (const TPair<FName, FPackageMapProfileEntry>& CurPair : CurEntries)
+			{
+				Total.NumCalls += CurPair.Value.NumCalls;
+				Total.Bits += CurPair.Value.Bits;
+				Total.Seconds += CurPair.Value.Seconds;
+			}
+
+			UE_LOG(LogNetworkTester, Log, TEXT("%s PackageMap %s %s: %i entries, %llu calls, %.1f KB, %.3f ms"), *OwnerName,
+				CategoryNames[CategoryIdx], Direction == 1 ? TEXT("sent") : TEXT("received"), CurEntries.Num(), Total.NumCalls,
+				Total.Bits / 8192.0, Total.Seconds * 1000.0);
+
+			for (const TPair<FName, FPackageMapProfileEntry>& CurPair : GetTop((EPackageMapProfileCategory)CategoryIdx, Direction == 1, TopN))
+			{
+				UE_LOG(LogNetworkTester, Log, TEXT("    %-48s %8llu calls %10.1f bytes %5.1f%% %8.3f ms"), *CurPair.Key.ToString(),
+					CurPair.Value.NumCalls, CurPair.Value.Bits / 8.0, Total.Bits > 0 ? 100.0 * CurPair.Value.Bits / Total.Bits : 0.0,
+					CurPair.Value.Seconds * 1000.0);
+			}
+		}
+	}
+}
+
+bool FPackageMapProfiler::ExportCsv(const FString& Filename, const FString& OwnerName, int32 TopN) const
+{
+	FString Output;
+
+	if (IFileManager::Get().FileSize(*Filename) <= 0)
+	{
+		Output += TEXT("Client,Category,Direction,Key,Calls,Bits,Ms\n");
+	}
+
+	for (int32 CategoryIdx = 0; CategoryIdx < (int32)EPackageMapProfileCategory::Num; CategoryIdx++)
+	{
+		for (int32 Direction = 1; Direction >= 0; Direction--)
+		{
+			for (const TPair<FName, FPackageMapProfileEntry>& CurPair : GetTop((EPackageMapProfileCategory)CategoryIdx, Direction == 1, TopN))
+			{
+				Output += FString::Printf(TEXT("%s,%s,%s,\"%s\",%llu,%llu,%.4f\n"), *OwnerName, CategoryNames[CategoryIdx],
+					Direction == 1 ? TEXT("sent") : TEXT("received"), *CurPair.Key.ToString().Replace(TEXT("\""), TEXT("\"\"")),
+					CurPair.Value.NumCalls, CurPair.Value.Bits, CurPair.Value.Seconds * 1000.0);
+			}
+		}
+	}
+
+	IFileManager::Get().MakeDirectory(*FPaths::GetPath(Filename), true);
+
+	return FFileHelper::SaveStringToFile(Output, *Filename, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM, &IFileManager::Get(),
+		FILEWRITE_Append);
+}
@@ -0,0 +1,101 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+
+class FArchive;
+
+
+/** The package map hook a profile entry was recorded in */
+enum class EPackageMapProfileCategory : uint8
+{
+	/** SerializeObject, keyed by object class (NetGUIDs and their exports) */
+	Object,
+
+	/** SerializeName, keyed by name */
+	Name,
+
+	/** SerializeNewActor, keyed by actor class (includes the objects it serializes) */
+	NewActor,
+
+	Num
+};
+
+/** The cost of one class/name, in one direction */
+struct FPackageMapProfileEntry
+{
+	uint64 NumCalls = 0;
+
+	/** Bits written or read */
+	uint64 Bits = 0;
+
+	/** Time (in seconds) spent serializing */
+	double Seconds = 0.0;
+};
+
+
+/**
+ * Counts the calls, bits and time of UMyPackageMapClient's serialization hooks, per object class and per name, for
+ * finding the NetGUID/name export overhead of a connection.
+ */
+class NETWORKTESTER_API FPackageMapProfiler
+{
+public:
+	/** @return Whether or not package maps are being profiled (shared by every minimal client) */
+	static bool IsEnabled()
+	{
+		return bEnabled;
+	}
+
+	static void SetEnabled(bool bInEnabled)
+	{
+		bEnabled = bInEnabled;
+	}
+
+	/** @return The bit position of a package map archive, or 0 if it is not a bit writer/reader */
+	static int64 GetArchiveBits(FArchive& Ar);
+
+	/**
+	 * Records one serialization
+	 *
+	 * @param Category	The hook which serialized
+	 * @param Key		The object/actor class, or the name
+	 * @param NumBits	The bits written or read
+	 * @param Seconds	The time taken
+	 * @param bSaving	Whether the bits were written (sent) or read (received)
+	 */
+	void Record(EPackageMapProfileCategory Category, FName Key, int64 NumBits, double Seconds, bool bSaving);
+
+	void Reset();
+
+	/**
+	 * Writes the costliest entries (by bits) of every category and direction to the log
+	 *
+	 * @param OwnerName	The name of the profiled minimal client, to prefix every line with
+	 * @param TopN		The number of entries per category and direction
+	 */
+	void LogTop(const FString& OwnerName, int32 TopN) const;
+
+	/**
+	 * Appends the costliest entries to a CSV file (with a header, if the file is new)
+	 *
+	 * @param Filename	The file to append to
+	 * @param OwnerName	The name of the profiled minimal client
+	 * @param TopN		The number of entries per category and direction
+	 * @return			Whether or not the file could be written
+	 */
+	bool ExportCsv(const FString& Filename, const FString& OwnerName, int32 TopN) const;
+
+private:
+	/** @return The costliest entries of one category and direction, most bits first */
+	TArray<TPair<FName, FPackageMapProfileEntry>> GetTop(EPackageMapProfileCategory Category, bool bSaving, int32 TopN) const;
+
+private:
+	static bool bEnabled;
+
+	/** Entries per category, received [0] and sent [1] */
+	TMap<FName, FPackageMapProfileEntry> Entries[(int32)EPackageMapProfileCategory::Num][2];
+};
@@ -0,0 +1,236 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+//
+
+#include "SyntheticActorScenario.h"
+
+#include "Engine/ActorChannel.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "Net/DataChannel.h"
+#include "Net/UnrealNetwork.h"
+#include "MinimalClient.h"
+
+
+ANetTesterSyntheticActor::ANetTesterSyntheticActor(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	bReplicates = true;
+	bAlwaysRelevant = true;
+}
+
+void ANetTesterSyntheticActor::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(ANetTesterSyntheticActor, Floats);
+	DOREPLIFETIME(ANetTesterSyntheticActor, Ints);
+	DOREPLIFETIME(ANetTesterSyntheticActor, Payload);
+}
+
+void ANetTesterSyntheticActor::InitProperties(int32 NumFloats, int32 NumInts, int32 PayloadBytes)
+{
+	Floats.SetNumZeroed(FMath::Max(NumFloats, 0));
+	Ints.SetNumZeroed(FMath::Max(NumInts, 0));
+	Payload.SetNumZeroed(FMath::Max(PayloadBytes, 0));
+}
+
+void ANetTesterSyntheticActor::MutateProperties(uint32 Generation)
+{
+	for (int32 i = 0; i < Floats.Num(); i++)
+	{
+		Floats[i] = (float)(Generation * 31 + i) * 0.5f;
+	}
+
+	for (int32 i = 0; i < Ints.Num(); i++)
+	{
+		Ints[i] = (int32)(Generation + i);
+	}
+
+	for (int32 i = 0; i < Payload.Num(); i++)
+	{
+		Payload[i] = (uint8)(Generation + i);
+	}
+}
+
+
+FSyntheticActorScenario::FSyntheticActorScenario()
+	: StartTime(0.0)
+{
+}
+
+int32 FSyntheticActorScenario::Spawn(UWorld* World, UNetDriver* Driver, const FSyntheticActorGroupSettings& Settings)
+{
+	if (World == nullptr || Driver == nullptr || Driver->ServerConnection != nullptr)
+	{
+		UE_LOG(LogNetworkTester, Warning, TEXT("SyntheticActors: only a listening minimal client can spawn actors"));
+		return 0;
+	}
+
+	FGroup& NewGroup = Groups.AddDefaulted_GetRef();
+
+	NewGroup.Settings = Settings;
+	NewGroup.Settings.ActorClass = Settings.ActorClass != nullptr ? Settings.ActorClass : ANetTesterSyntheticActor::StaticClass();
+	NewGroup.Settings.UpdateRate = FMath::Max(Settings.UpdateRate, 0.f);
+	NewGroup.Actors.Reserve(Settings.NumActors);
+
+	FActorSpawnParameters SpawnParams;
+
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	for (int32 i = 0; i < Settings.NumActors; i++)
+	{
+		AActor* NewActor = World->SpawnActor<AActor>(NewGroup.Settings.ActorClass, FTransform::Identity, SpawnParams);
+
+		if (NewActor == nullptr)
+		{
+			UE_LOG(LogNetworkTester, Warning, TEXT("SyntheticActors: failed to spawn %s"), *NewGroup.Settings.ActorClass->GetName());
+			break;
+		}
+
+		// The minimal client's net driver is a named driver, not the world's game net driver
+		NewActor->SetNetDriverName(Driver->NetDriverName);
+		NewActor->SetReplicates(true);
+
+		if (ANetTesterSyntheticActor* SyntheticActor = Cast<ANetTesterSyntheticActor>(NewActor))
+		{
+			SyntheticActor->InitProperties(Settings.NumFloats, Settings.NumInts, Settings.PayloadBytes);
+		}
+
+		NewGroup.Actors.Add(NewActor);
+	}
+
+	if (Groups.Num() == 1)
+	{
+		StartTime = FPlatformTime::Seconds();
+	}
+
+	return NewGroup.Actors.Num();
+}
+
+void FSyntheticActorScenario::Tick(UNetDriver* Driver, double CurTime)
+{
+	if (Groups.Num() == 0 || Driver == nullptr)
+	{
+		return;
+	}
+
+	for (FGroup& CurGroup : Groups)
+	{
+		if (CurGroup.Settings.UpdateRate > 0.f)
+		{
+			if (CurTime < CurGroup.NextUpdateTime)
+			{
+				continue;
+			}
+
+			CurGroup.NextUpdateTime = FMath::Max(CurGroup.NextUpdateTime + 1.0 / CurGroup.Settings.UpdateRate, CurTime);
+		}
+
+		CurGroup.Generation++;
+
+		for (const TWeakObjectPtr<AActor>& CurActor : CurGroup.Actors)
+		{
+			if (ANetTesterSyntheticActor* SyntheticActor = Cast<ANetTesterSyntheticActor>(CurActor.Get()))
+			{
+				SyntheticActor->MutateProperties(CurGroup.Generation);
+			}
+		}
+
+		for (UNetConnection* CurConn : Driver->ClientConnections)
+		{
+			if (CurConn == nullptr || CurConn->GetConnectionState() != USOCK_Open)
+			{
+				continue;
+			}
+
+			for (const TWeakObjectPtr<AActor>& CurActor : CurGroup.Actors)
+			{
+				// Leave the rest of this update for the next one, rather than flooding a saturated connection
+				if (!CurConn->IsNetReady(false))
+				{
+					CurGroup.Stats.NumSaturatedSkips++;
+					break;
+				}
+
+				if (!CurActor.IsValid())
+				{
+					continue;
+				}
+
+				UActorChannel* Channel = CurConn->FindActorChannelRef(CurActor);
+
+				if (Channel == nullptr)
+				{
+					Channel = Cast<UActorChannel>(CurConn->CreateChannelByName(NAME_Actor, EChannelCreateFlags::OpenedLocally));
+
+					if (Channel == nullptr)
+					{
+						// Out of channels
+						break;
+					}
+
+					Channel->SetChannelActor(CurActor.Get(), ESetChannelActorFlags::None);
+					CurGroup.Stats.NumChannelsOpened++;
+				}
+
+				// Every reliable bunch in flight takes a reliable buffer slot, overflowing it closes the connection
+				if (Channel->NumOutRec < RELIABLE_BUFFER / 2)
+				{
+					CurGroup.Stats.SentBits += (uint64)FMath::Max<int64>(Channel->ReplicateActor(), 0);
+					CurGroup.Stats.NumReplications++;
+				}
+				else
+				{
+					CurGroup.Stats.NumReliableBufferSkips++;
+				}
+			}
+		}
+	}
+}
+
+void FSyntheticActorScenario::Reset()
+{
+	for (FGroup& CurGroup : Groups)
+	{
+		for (const TWeakObjectPtr<AActor>& CurActor : CurGroup.Actors)
+		{
+			if (CurActor.IsValid())
+			{
+				CurActor->Destroy();
+			}
+		}
+	}
+
+	Groups.Empty();
+}
+
+void FSyntheticActorScenario::LogReport() const
+{
+	const double Elapsed = FMath::Max(FPlatformTime::Seconds() - StartTime, 0.001);
+
+	for (const FGroup& CurGroup : Groups)
+	{
+		const FGroupStats& Stats = CurGroup.Stats;
+
+		UE_LOG(LogNetworkTester, Log, TEXT("SyntheticActors %s x%i @ %.1f Hz (%i floats, %i ints, %i bytes): %llu channels opened, ")
+			TEXT("%llu replications, %.1f KB sent (%.1f KB/s, %.1f bytes/replication), %llu saturated skips, %llu reliable buffer skips"),
+			*CurGroup.Settings.ActorClass->GetName(), CurGroup.Actors.Num(), CurGroup.Settings.UpdateRate, CurGroup.Settings.NumFloats,
+			CurGroup.Settings.NumInts, CurGroup.Settings.PayloadBytes, Stats.NumChannelsOpened, Stats.NumReplications,
+			Stats.SentBits / 8192.0, Stats.SentBits / 8192.0 / Elapsed,
+			Stats.NumReplications > 0 ? Stats.SentBits / 8.0 / Stats.NumReplications : 0.0, Stats.NumSaturatedSkips,
+			Stats.NumReliableBufferSkips);
+	}
+}
+
+int32 FSyntheticActorScenario::GetNumActors() const
+{
+	int32 ReturnVal = 0;
+
+	for (const FGroup& CurGroup : Groups)
+	{
+		ReturnVal += CurGroup.Actors.Num();
+	}
+
+	return ReturnVal;
+}
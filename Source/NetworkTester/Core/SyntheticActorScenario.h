@@ -0,0 +1,126 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+
+#include "SyntheticActorScenario.generated.h"
+
+
+class UNetDriver;
+
+
+/**
+ * A replicated actor with a configurable amount of replicated state, for generating actor replication load
+ */
+UCLASS(transient, notplaceable)
+class NETWORKTESTER_API ANetTesterSyntheticActor : public AActor
+{
+	GENERATED_UCLASS_BODY()
+
+public:
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	/** Sizes the replicated state */
+	void InitProperties(int32 NumFloats, int32 NumInts, int32 PayloadBytes);
+
+	/** Changes every replicated value, so that the next replication sends all of them */
+	void MutateProperties(uint32 Generation);
+
+public:
+	UPROPERTY(Replicated)
+	TArray<float> Floats;
+
+	UPROPERTY(Replicated)
+	TArray<int32> Ints;
+
+	UPROPERTY(Replicated)
+	TArray<uint8> Payload;
+};
+
+
+/** A group of synthetic actors, sharing a class, property set and update rate */
+struct FSyntheticActorGroupSettings
+{
+	/** The replicated actor class to spawn (nullptr spawns ANetTesterSyntheticActor) */
+	UClass* ActorClass = nullptr;
+
+	int32 NumActors = 100;
+
+	/** Property changes and replications per second (0 replicates every tick) */
+	float UpdateRate = 10.f;
+
+	/** The replicated property set of ANetTesterSyntheticActor (ignored for other classes) */
+	int32 NumFloats = 8;
+	int32 NumInts = 4;
+	int32 PayloadBytes = 0;
+};
+
+
+/**
+ * Spawns synthetic replicated actors in a listen server's world, and replicates them to every client connection at a
+ * fixed rate. Actor channels are opened and replicated directly, as minimal client connections have no player
+ * controller/view target for the engine's ServerReplicateActors to consider.
+ */
+class NETWORKTESTER_API FSyntheticActorScenario
+{
+public:
+	FSyntheticActorScenario();
+
+	/**
+	 * Spawns a group of actors
+	 *
+	 * @param World		The listen server's world
+	 * @param Driver	The listen server's net driver, which replicates the actors
+	 * @param Settings	The class, count, property set and update rate of the group
+	 * @return			The number of actors spawned
+	 */
+	int32 Spawn(UWorld* World, UNetDriver* Driver, const FSyntheticActorGroupSettings& Settings);
+
+	/** Updates and replicates every group which is due, to every open connection (call before TickFlush) */
+	void Tick(UNetDriver* Driver, double CurTime);
+
+	/** Destroys every spawned actor */
+	void Reset();
+
+	// Writes the replication counters of every group to the log
+	void LogReport() const;
+
+	int32 GetNumActors() const;
+
+private:
+	struct FGroupStats
+	{
+		/** ReplicateActor calls, and the bits they wrote */
+		uint64 NumReplications = 0;
+		uint64 SentBits = 0;
+
+		uint64 NumChannelsOpened = 0;
+
+		/** Connections skipped for an update, because they were saturated */
+		uint64 NumSaturatedSkips = 0;
+
+		/** Actor replications skipped, because their channel's reliable buffer was half full */
+		uint64 NumReliableBufferSkips = 0;
+	};
+
+	struct FGroup
+	{
+		FSyntheticActorGroupSettings Settings;
+
+		TArray<TWeakObjectPtr<AActor>> Actors;
+
+		double NextUpdateTime = 0.0;
+
+		uint32 Generation = 0;
+
+		FGroupStats Stats;
+	};
+
+	TArray<FGroup> Groups;
+
+	/** The time (FPlatformTime::Seconds) the first group was spawned */
+	double StartTime;
+};
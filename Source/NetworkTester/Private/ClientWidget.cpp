@@ -15,6 +15,8 @@
 #include "Widgets/Input/SEditableTextBox.h"
 #include "Widgets/Input/SMultiLineEditableTextBox.h"
 #include "Widgets/Input/SNumericEntryBox.h"
+#include "NetStatsPanel.h"
+#include "MessageHistory.h"
 
 
 #define LOCTEXT_NAMESPACE	"NetworkTester"
@@ -115,6 +117,14 @@ void SClientWidget::Construct(const FArguments& InArgs)
 			]
 		]
 		+ SVerticalBox::Slot()
+		.AutoHeight()
+		.Padding(0.0f, 4.0f)
+		[
+			SNew(SNetStatsPanel)
+			.MinimalClient(MinimalClient)
+			.ShowConnectionTable(false)
+		]
+		+ SVerticalBox::Slot()
 		.FillHeight(1.0f)
 		[
 			SNew(SSplitter)
@@ -122,8 +132,7 @@ void SClientWidget::Construct(const FArguments& InArgs)
 			+ SSplitter::Slot()
 			.Value(0.5f)
 			[
-				SAssignNew(HistoryBox, SMultiLineEditableTextBox)
-				.IsReadOnly(false)
+				SAssignNew(HistoryBox, SMessageHistory)
 			]
 			+ SSplitter::Slot()
 			.Value(0.5f)
@@ -212,23 +221,50 @@ FReply SClientWidget::OnConnectClicked()
 // tick mode button
 FText SClientWidget::GetTickModeButtonText() const
 {
-	return LOCTEXT("NetworkTester_TickModeAuto", "Auto");
+	const EMinimalClientTickMode Mode = MinimalClient ? MinimalClient->GetTickSchedule().Mode : EMinimalClientTickMode::Auto;
+
+	switch (Mode)
+	{
+	case EMinimalClientTickMode::Step:
+		return LOCTEXT("NetworkTester_TickModeStep", "Step");
+
+	case EMinimalClientTickMode::Split:
+		return LOCTEXT("NetworkTester_TickModeSplit", "Split");
+
+	default:
+		return LOCTEXT("NetworkTester_TickModeAuto", "Auto");
+	}
 }
 
 FReply SClientWidget::OnTickModeClicked()
 {
+	if (MinimalClient)
+	{
+		// Auto -> Step -> Split -> Auto, keeping the configured rates
+		FMinimalClientTickSettings Settings = MinimalClient->GetTickSchedule();
+
+		Settings.Mode = (EMinimalClientTickMode)(((int32)Settings.Mode + 1) % ((int32)EMinimalClientTickMode::Split + 1));
+
+		MinimalClient->SetTickSchedule(Settings);
+	}
+
 	return FReply::Handled();
 }
 
 // tick step button
 FReply SClientWidget::OnTickStepClicked()
 {
+	if (MinimalClient)
+	{
+		MinimalClient->StepTick();
+	}
+
 	return FReply::Handled();
 }
 
 bool SClientWidget::GetIsTickStepEnabled() const
 {
-	return true;
+	return MinimalClient && MinimalClient->GetTickSchedule().Mode == EMinimalClientTickMode::Step;
 }
 
 // send message button
@@ -260,7 +296,7 @@ void SClientWidget::OnReceiveMessage(const FString& InText, class UNetConnection
 {
 	if (HistoryBox)
 	{
-		HistoryBox->InsertTextAtCursor(InText);
+		HistoryBox->AddMessage(InText);
 	}
 }
 
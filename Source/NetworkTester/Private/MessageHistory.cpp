@@ -0,0 +1,199 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "MessageHistory.h"
+#include "MinimalClient.h"
+#include "HAL/IConsoleManager.h"
+#include "Widgets/SBoxPanel.h"
+#include "Widgets/Text/STextBlock.h"
+#include "Widgets/Views/STableRow.h"
+
+
+#define LOCTEXT_NAMESPACE	"NetworkTester"
+
+
+FMessageHistoryRateLimit& FMessageHistoryRateLimit::Get()
+{
+	static FMessageHistoryRateLimit Singleton;
+
+	return Singleton;
+}
+
+
+void SMessageHistory::Construct(const FArguments& InArgs)
+{
+	Messages.SetNum(FMath::Max(InArgs._Capacity, 1));
+	VisibleMessages.Reserve(Messages.Num());
+
+	Head = 0;
+	Count = 0;
+	NumPending = 0;
+	bDirty = false;
+	RateWindowStart = 0.0;
+	NumInRateWindow = 0;
+	NumReceived = 0;
+	NumDropped = 0;
+
+	ChildSlot
+	[
+		SNew(SVerticalBox)
+		+ SVerticalBox::Slot()
+		.FillHeight(1.f)
+		[
+			SAssignNew(ListView, SListView<TSharedPtr<FString>>)
+			.ListItemsSource(&VisibleMessages)
+			.OnGenerateRow(this, &SMessageHistory::OnGenerateRow)
+			.SelectionMode(ESelectionMode::Multi)
+		]
+		+ SVerticalBox::Slot()
+		.AutoHeight()
+		[
+			SNew(STextBlock)
+			.Text(this, &SMessageHistory::GetStatusText)
+		]
+	];
+}
+
+void SMessageHistory::AddMessage(const FString& InText)
+{
+	NumReceived++;
+
+	if (!PassesRateLimit())
+	{
+		NumDropped++;
+		return;
+	}
+
+	// A new item per message - the list view tracks rows by item, so slots can't be reused in place
+	TSharedPtr<FString> NewItem = MakeShared<FString>(InText);
+
+	if (Count == Messages.Num())
+	{
+		Messages[Head] = MoveTemp(NewItem);
+		Head = (Head + 1) % Messages.Num();
+	}
+	else
+	{
+		Messages[(Head + Count) % Messages.Num()] = MoveTemp(NewItem);
+		Count++;
+	}
+
+	NumPending = FMath::Min(NumPending + 1, Messages.Num());
+
+	// The timer only runs for the frame after messages arrive
+	if (!bDirty)
+	{
+		RegisterActiveTimer(0.f, FWidgetActiveTimerDelegate::CreateSP(this, &SMessageHistory::UpdateList));
+
+		bDirty = true;
+	}
+}
+
+void SMessageHistory::Clear()
+{
+	for (TSharedPtr<FString>& CurMessage : Messages)
+	{
+		CurMessage.Reset();
+	}
+
+	Head = 0;
+	Count = 0;
+	NumPending = 0;
+	NumReceived = 0;
+	NumDropped = 0;
+
+	VisibleMessages.Reset();
+	ListView->RequestListRefresh();
+}
+
+bool SMessageHistory::PassesRateLimit()
+{
+	const FMessageHistoryRateLimit& Limit = FMessageHistoryRateLimit::Get();
+	bool bReturnVal = true;
+
+	if (Limit.MaxPerSecond > 0)
+	{
+		const double CurTime = FPlatformTime::Seconds();
+
+		if (CurTime - RateWindowStart >= 1.0)
+		{
+			RateWindowStart = CurTime;
+			NumInRateWindow = 0;
+		}
+
+		NumInRateWindow++;
+
+		if (NumInRateWindow > Limit.MaxPerSecond)
+		{
+			bReturnVal = Limit.SampleEvery > 0 && ((NumInRateWindow - Limit.MaxPerSecond) % Limit.SampleEvery) == 0;
+		}
+	}
+
+	return bReturnVal;
+}
+
+EActiveTimerReturnType SMessageHistory::UpdateList(double InCurrentTime, float InDeltaTime)
+{
+	if (NumPending > 0)
+	{
+		// Only follow new messages if the user hasn't scrolled away from the end
+		const bool bWasAtEnd = VisibleMessages.Num() == 0 || ListView->GetScrollDistanceRemaining().Y <= 0.f;
+
+		// Drop the messages the ring has overwritten since, then append the new ones
+		const int32 NumOverwritten = FMath::Max(VisibleMessages.Num() + NumPending - Messages.Num(), 0);
+
+		if (NumOverwritten > 0)
+		{
+			VisibleMessages.RemoveAt(0, NumOverwritten, false);
+		}
+
+		for (int32 i = Count - NumPending; i < Count; i++)
+		{
+			VisibleMessages.Add(Messages[(Head + i) % Messages.Num()]);
+		}
+
+		ListView->RequestListRefresh();
+
+		if (bWasAtEnd)
+		{
+			ListView->ScrollToBottom();
+		}
+
+		NumPending = 0;
+	}
+
+	bDirty = false;
+
+	return EActiveTimerReturnType::Stop;
+}
+
+TSharedRef<ITableRow> SMessageHistory::OnGenerateRow(TSharedPtr<FString> InItem, const TSharedRef<STableViewBase>& OwnerTable)
+{
+	return SNew(STableRow<TSharedPtr<FString>>, OwnerTable)
+		[
+			SNew(STextBlock)
+			.Text(FText::FromString(*InItem))
+		];
+}
+
+FText SMessageHistory::GetStatusText() const
+{
+	return FText::Format(LOCTEXT("NetworkTester_HistoryStatus", "{0} shown, {1} received, {2} dropped by rate limit"),
+		FText::AsNumber(Count), FText::AsNumber(NumReceived), FText::AsNumber(NumDropped));
+}
+
+
+static FAutoConsoleCommand MessageHistoryRateLimitCommand(
+	TEXT("NetTester.History.RateLimit"),
+	TEXT("Limits the messages per second added to the message history views. Usage: NetTester.History.RateLimit MaxPerSecond [SampleEvery] (0 disables)"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		FMessageHistoryRateLimit& Limit = FMessageHistoryRateLimit::Get();
+
+		Limit.MaxPerSecond = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 0) : 0;
+		Limit.SampleEvery = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 0) : 0;
+
+		UE_LOG(LogNetworkTester, Log, TEXT("History rate limit: %d/s, above which %s"), Limit.MaxPerSecond,
+			Limit.SampleEvery > 0 ? *FString::Printf(TEXT("1 in %d is kept"), Limit.SampleEvery) : TEXT("all are dropped"));
+	}));
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,88 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "NetStatsGraph.h"
+#include "Rendering/DrawElements.h"
+#include "Styling/CoreStyle.h"
+
+
+void SNetStatsGraph::Construct(const FArguments& InArgs)
+{
+	Label = InArgs._Label;
+	Color = InArgs._Color;
+
+	Values.SetNumZeroed(FMath::Max(InArgs._Capacity, 2));
+	Points.Reserve(Values.Num());
+
+	Head = 0;
+	Count = 0;
+}
+
+void SNetStatsGraph::AddValue(float InValue)
+{
+	if (Count == Values.Num())
+	{
+		Values[Head] = InValue;
+		Head = (Head + 1) % Values.Num();
+	}
+	else
+	{
+		Values[(Head + Count) % Values.Num()] = InValue;
+		Count++;
+	}
+}
+
+void SNetStatsGraph::Reset()
+{
+	Head = 0;
+	Count = 0;
+}
+
+FVector2D SNetStatsGraph::ComputeDesiredSize(float LayoutScaleMultiplier) const
+{
+	return FVector2D(160.f, 48.f);
+}
+
+int32 SNetStatsGraph::OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect,
+	FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const
+{
+	const FVector2D Size = AllottedGeometry.GetLocalSize();
+
+	FSlateDrawElement::MakeBox(OutDrawElements, LayerId, AllottedGeometry.ToPaintGeometry(),
+		FCoreStyle::Get().GetBrush("GenericWhiteBox"), ESlateDrawEffect::None, FLinearColor(0.02f, 0.02f, 0.02f, 1.f));
+
+	float MaxValue = 0.f;
+	float LastValue = 0.f;
+
+	for (int32 i = 0; i < Count; i++)
+	{
+		LastValue = Values[(Head + i) % Values.Num()];
+		MaxValue = FMath::Max(MaxValue, LastValue);
+	}
+
+	if (Count > 1)
+	{
+		const float XStep = Size.X / (Values.Num() - 1);
+		const float YScale = MaxValue > 0.f ? (Size.Y - 2.f) / MaxValue : 0.f;
+
+		Points.Reset();
+
+		// Newest value on the right edge
+		for (int32 i = 0; i < Count; i++)
+		{
+			const float CurValue = Values[(Head + i) % Values.Num()];
+
+			Points.Add(FVector2D(Size.X - (Count - 1 - i) * XStep, Size.Y - 1.f - CurValue * YScale));
+		}
+
+		FSlateDrawElement::MakeLines(OutDrawElements, LayerId + 1, AllottedGeometry.ToPaintGeometry(), Points,
+			ESlateDrawEffect::None, Color, true, 1.f);
+	}
+
+	const FText Caption = FText::Format(NSLOCTEXT("NetworkTester", "NetStatsGraphCaption", "{0}: {1} (max {2})"), Label,
+		FText::AsNumber(LastValue), FText::AsNumber(MaxValue));
+
+	FSlateDrawElement::MakeText(OutDrawElements, LayerId + 2, AllottedGeometry.ToOffsetPaintGeometry(FVector2D(2.f, 1.f)), Caption,
+		FCoreStyle::Get().GetFontStyle("SmallFont"), ESlateDrawEffect::None, FLinearColor::White);
+
+	return LayerId + 2;
+}
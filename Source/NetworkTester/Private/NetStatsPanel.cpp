@@ -0,0 +1,275 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "NetStatsPanel.h"
+#include "NetStatsGraph.h"
+#include "MinimalClient.h"
+#include "Widgets/SBoxPanel.h"
+#include "Widgets/Layout/SBox.h"
+#include "Widgets/Layout/SWrapBox.h"
+#include "Widgets/Text/STextBlock.h"
+#include "Widgets/Views/SHeaderRow.h"
+#include "Widgets/Views/STableRow.h"
+
+
+#define LOCTEXT_NAMESPACE	"NetworkTester"
+
+
+/** The interval between stats updates */
+static constexpr float NetStatsPanelInterval = 0.1f;
+
+static const FName NetStatsColumn_Id(TEXT("Id"));
+static const FName NetStatsColumn_In(TEXT("In"));
+static const FName NetStatsColumn_Out(TEXT("Out"));
+static const FName NetStatsColumn_Rtt(TEXT("Rtt"));
+static const FName NetStatsColumn_Loss(TEXT("Loss"));
+static const FName NetStatsColumn_Queued(TEXT("Queued"));
+static const FName NetStatsColumn_Saturated(TEXT("Saturated"));
+
+
+/* One row of the connection table. Cells read the row data through attributes, so rows are never regenerated. */
+class SNetConnectionRow : public SMultiColumnTableRow<TSharedPtr<FNetConnectionRowData>>
+{
+public:
+	SLATE_BEGIN_ARGS(SNetConnectionRow) {}
+	SLATE_END_ARGS()
+
+	void Construct(const FArguments& InArgs, const TSharedRef<STableViewBase>& InOwnerTable, TSharedPtr<FNetConnectionRowData> InItem)
+	{
+		Item = InItem;
+
+		SMultiColumnTableRow<TSharedPtr<FNetConnectionRowData>>::Construct(FSuperRowType::FArguments(), InOwnerTable);
+	}
+
+	virtual TSharedRef<SWidget> GenerateWidgetForColumn(const FName& ColumnName) override
+	{
+		TSharedPtr<FNetConnectionRowData> RowData = Item;
+		TAttribute<FText> CellText;
+
+		if (ColumnName == NetStatsColumn_Id)
+		{
+			CellText = TAttribute<FText>::CreateLambda([RowData]() { return FText::AsNumber(RowData->ConnectionId); });
+		}
+		else if (ColumnName == NetStatsColumn_In)
+		{
+			CellText = TAttribute<FText>::CreateLambda([RowData]() { return FText::AsNumber(RowData->InKBps); });
+		}
+		else if (ColumnName == NetStatsColumn_Out)
+		{
+			CellText = TAttribute<FText>::CreateLambda([RowData]() { return FText::AsNumber(RowData->OutKBps); });
+		}
+		else if (ColumnName == NetStatsColumn_Rtt)
+		{
+			CellText = TAttribute<FText>::CreateLambda([RowData]() { return FText::AsNumber(RowData->RttMs); });
+		}
+		else if (ColumnName == NetStatsColumn_Loss)
+		{
+			CellText = TAttribute<FText>::CreateLambda([RowData]() { return FText::AsNumber(RowData->LossPct); });
+		}
+		else if (ColumnName == NetStatsColumn_Queued)
+		{
+			CellText = TAttribute<FText>::CreateLambda([RowData]() { return FText::AsNumber(RowData->QueuedBits); });
+		}
+		else if (ColumnName == NetStatsColumn_Saturated)
+		{
+			CellText = TAttribute<FText>::CreateLambda([RowData]()
+				{
+					return RowData->bSaturated ? LOCTEXT("NetworkTester_Saturated", "Yes") : FText::GetEmpty();
+				});
+		}
+
+		return SNew(STextBlock)
+			.Text(CellText);
+	}
+
+private:
+	TSharedPtr<FNetConnectionRowData> Item;
+};
+
+
+SNetStatsPanel::~SNetStatsPanel()
+{
+	if (MinimalClient != nullptr)
+	{
+		MinimalClient->SetLiveSampleInterval(0.f);
+	}
+}
+
+void SNetStatsPanel::Construct(const FArguments& InArgs)
+{
+	MinimalClient = InArgs._MinimalClient;
+
+	TSharedRef<SVerticalBox> VerticalBox = SNew(SVerticalBox)
+		+ SVerticalBox::Slot()
+		.AutoHeight()
+		[
+			SNew(SWrapBox)
+			.UseAllottedSize(true)
+			+ SWrapBox::Slot()
+			.Padding(2.f)
+			[
+				SAssignNew(InKBpsGraph, SNetStatsGraph)
+				.Label(LOCTEXT("NetworkTester_GraphIn", "Recv KB/s"))
+				.Color(FLinearColor(0.2f, 0.8f, 0.2f))
+			]
+			+ SWrapBox::Slot()
+			.Padding(2.f)
+			[
+				SAssignNew(OutKBpsGraph, SNetStatsGraph)
+				.Label(LOCTEXT("NetworkTester_GraphOut", "Send KB/s"))
+				.Color(FLinearColor(0.2f, 0.5f, 1.f))
+			]
+			+ SWrapBox::Slot()
+			.Padding(2.f)
+			[
+				SAssignNew(PacketsGraph, SNetStatsGraph)
+				.Label(LOCTEXT("NetworkTester_GraphPackets", "Packets/s"))
+				.Color(FLinearColor(0.8f, 0.8f, 0.8f))
+			]
+			+ SWrapBox::Slot()
+			.Padding(2.f)
+			[
+				SAssignNew(RttGraph, SNetStatsGraph)
+				.Label(LOCTEXT("NetworkTester_GraphRtt", "RTT ms"))
+				.Color(FLinearColor(1.f, 0.8f, 0.2f))
+			]
+			+ SWrapBox::Slot()
+			.Padding(2.f)
+			[
+				SAssignNew(LossGraph, SNetStatsGraph)
+				.Label(LOCTEXT("NetworkTester_GraphLoss", "Loss %"))
+				.Color(FLinearColor(1.f, 0.3f, 0.3f))
+			]
+		];
+
+	if (InArgs._ShowConnectionTable)
+	{
+		VerticalBox->AddSlot()
+			.AutoHeight()
+			[
+				SNew(SBox)
+				.MaxDesiredHeight(150.f)
+				[
+					SAssignNew(ConnectionList, SListView<TSharedPtr<FNetConnectionRowData>>)
+					.ListItemsSource(&ConnectionRows)
+					.OnGenerateRow(this, &SNetStatsPanel::OnGenerateConnectionRow)
+					.SelectionMode(ESelectionMode::None)
+					.HeaderRow
+					(
+						SNew(SHeaderRow)
+						+ SHeaderRow::Column(NetStatsColumn_Id).DefaultLabel(LOCTEXT("NetworkTester_ColId", "Id")).FillWidth(0.5f)
+						+ SHeaderRow::Column(NetStatsColumn_In).DefaultLabel(LOCTEXT("NetworkTester_ColIn", "Recv KB/s"))
+						+ SHeaderRow::Column(NetStatsColumn_Out).DefaultLabel(LOCTEXT("NetworkTester_ColOut", "Send KB/s"))
+						+ SHeaderRow::Column(NetStatsColumn_Rtt).DefaultLabel(LOCTEXT("NetworkTester_ColRtt", "RTT ms"))
+						+ SHeaderRow::Column(NetStatsColumn_Loss).DefaultLabel(LOCTEXT("NetworkTester_ColLoss", "Loss %"))
+						+ SHeaderRow::Column(NetStatsColumn_Queued).DefaultLabel(LOCTEXT("NetworkTester_ColQueued", "Queued bits"))
+						+ SHeaderRow::Column(NetStatsColumn_Saturated).DefaultLabel(LOCTEXT("NetworkTester_ColSaturated", "Saturated")).FillWidth(0.5f)
+					)
+				]
+			];
+	}
+
+	ChildSlot
+	[
+		VerticalBox
+	];
+
+	if (MinimalClient != nullptr)
+	{
+		MinimalClient->SetLiveSampleInterval(NetStatsPanelInterval);
+	}
+
+	RegisterActiveTimer(NetStatsPanelInterval, FWidgetActiveTimerDelegate::CreateSP(this, &SNetStatsPanel::UpdateStats));
+}
+
+EActiveTimerReturnType SNetStatsPanel::UpdateStats(double InCurrentTime, float InDeltaTime)
+{
+	if (MinimalClient == nullptr)
+	{
+		return EActiveTimerReturnType::Stop;
+	}
+
+	Swap(PrevSamples, CurSamples);
+	MinimalClient->CopyLiveSamples(CurSamples);
+
+	// Nothing new since the last update (the net driver ticks slower than the panel, or is stepped by hand)
+	if (CurSamples.Num() > 0 && PrevSamples.Num() > 0 && CurSamples[0].Time == PrevSamples[0].Time)
+	{
+		return EActiveTimerReturnType::Continue;
+	}
+
+	const int32 NumRowsBefore = ConnectionRows.Num();
+	float TotalInKBps = 0.f;
+	float TotalOutKBps = 0.f;
+	float TotalPackets = 0.f;
+	float MaxRttMs = 0.f;
+	float MaxLossPct = 0.f;
+
+	ConnectionRows.SetNum(CurSamples.Num());
+
+	// Look up each connection's previous sample by id, rather than searching the previous samples for every row
+	PrevSampleIndices.Reset();
+
+	for (int32 i = 0; i < PrevSamples.Num(); i++)
+	{
+		PrevSampleIndices.Add(PrevSamples[i].ConnectionId, i);
+	}
+
+	for (int32 i = 0; i < CurSamples.Num(); i++)
+	{
+		const FNetConnectionSample& Cur = CurSamples[i];
+		const int32* PrevIndex = PrevSampleIndices.Find(Cur.ConnectionId);
+		const FNetConnectionSample* Prev = PrevIndex != nullptr ? &PrevSamples[*PrevIndex] : nullptr;
+
+		if (!ConnectionRows[i].IsValid())
+		{
+			ConnectionRows[i] = MakeShared<FNetConnectionRowData>();
+		}
+
+		FNetConnectionRowData& Row = *ConnectionRows[i];
+
+		Row.ConnectionId = Cur.ConnectionId;
+		Row.RttMs = Cur.RttMs;
+		Row.LossPct = FMath::Max(Cur.InLossPercent, Cur.OutLossPercent);
+		Row.QueuedBits = Cur.QueuedBits;
+		Row.bSaturated = Cur.bSaturated;
+		Row.InKBps = 0.f;
+		Row.OutKBps = 0.f;
+
+		// New connections have no rate until their second sample, and counters reset with the connection
+		if (Prev != nullptr && Cur.Time > Prev->Time)
+		{
+			const double Seconds = Cur.Time - Prev->Time;
+
+			Row.InKBps = (float)(FMath::Max<int64>(0, (int64)(Cur.InBytes - Prev->InBytes)) / 1024.0 / Seconds);
+			Row.OutKBps = (float)(FMath::Max<int64>(0, (int64)(Cur.OutBytes - Prev->OutBytes)) / 1024.0 / Seconds);
+
+			TotalPackets += (float)(FMath::Max<int64>(0, (int64)(Cur.InPackets + Cur.OutPackets - Prev->InPackets - Prev->OutPackets)) / Seconds);
+		}
+
+		TotalInKBps += Row.InKBps;
+		TotalOutKBps += Row.OutKBps;
+		MaxRttMs = FMath::Max(MaxRttMs, Row.RttMs);
+		MaxLossPct = FMath::Max(MaxLossPct, Row.LossPct);
+	}
+
+	InKBpsGraph->AddValue(TotalInKBps);
+	OutKBpsGraph->AddValue(TotalOutKBps);
+	PacketsGraph->AddValue(TotalPackets);
+	RttGraph->AddValue(MaxRttMs);
+	LossGraph->AddValue(MaxLossPct);
+
+	// Existing rows pick up their new values through their attributes, only a changed row count needs a refresh
+	if (ConnectionList.IsValid() && ConnectionRows.Num() != NumRowsBefore)
+	{
+		ConnectionList->RequestListRefresh();
+	}
+
+	return EActiveTimerReturnType::Continue;
+}
+
+TSharedRef<ITableRow> SNetStatsPanel::OnGenerateConnectionRow(TSharedPtr<FNetConnectionRowData> InItem, const TSharedRef<STableViewBase>& OwnerTable)
+{
+	return SNew(SNetConnectionRow, OwnerTable, InItem);
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -15,6 +15,8 @@
 #include "Widgets/Input/SEditableTextBox.h"
 #include "Widgets/Input/SMultiLineEditableTextBox.h"
 #include "Widgets/Input/SNumericEntryBox.h"
+#include "NetStatsPanel.h"
+#include "MessageHistory.h"
 
 
 #define LOCTEXT_NAMESPACE	"NetworkTester"
@@ -114,6 +116,14 @@ void SServerWidget::Construct(const FArguments& InArgs)
 			]
 		]
 		+ SVerticalBox::Slot()
+		.AutoHeight()
+		.Padding(0.0f, 4.0f)
+		[
+			SNew(SNetStatsPanel)
+			.MinimalClient(MinimalServer)
+			.ShowConnectionTable(true)
+		]
+		+ SVerticalBox::Slot()
 		.FillHeight(1.0f)
 		[
 			SNew(SSplitter)
@@ -121,8 +131,7 @@ void SServerWidget::Construct(const FArguments& InArgs)
 			+ SSplitter::Slot()
 			.Value(0.5f)
 			[
-				SAssignNew(HistoryBox, SMultiLineEditableTextBox)
-				.IsReadOnly(false)
+				SAssignNew(HistoryBox, SMessageHistory)
 			]
 			+ SSplitter::Slot()
 			.Value(0.5f)
@@ -211,23 +220,50 @@ FReply SServerWidget::OnListenClicked()
 // tick mode button
 FText SServerWidget::GetTickModeButtonText() const
 {
-	return LOCTEXT("NetworkTester_TickModeAuto", "Auto");
+	const EMinimalClientTickMode Mode = MinimalServer ? MinimalServer->GetTickSchedule().Mode : EMinimalClientTickMode::Auto;
+
+	switch (Mode)
+	{
+	case EMinimalClientTickMode::Step:
+		return LOCTEXT("NetworkTester_TickModeStep", "Step");
+
+	case EMinimalClientTickMode::Split:
+		return LOCTEXT("NetworkTester_TickModeSplit", "Split");
+
+	default:
+		return LOCTEXT("NetworkTester_TickModeAuto", "Auto");
+	}
 }
 
 FReply SServerWidget::OnTickModeClicked()
 {
+	if (MinimalServer)
+	{
+		// Auto -> Step -> Split -> Auto, keeping the configured rates
+		FMinimalClientTickSettings Settings = MinimalServer->GetTickSchedule();
+
+		Settings.Mode = (EMinimalClientTickMode)(((int32)Settings.Mode + 1) % ((int32)EMinimalClientTickMode::Split + 1));
+
+		MinimalServer->SetTickSchedule(Settings);
+	}
+
 	return FReply::Handled();
 }
 
 // tick step button
 FReply SServerWidget::OnTickStepClicked()
 {
+	if (MinimalServer)
+	{
+		MinimalServer->StepTick();
+	}
+
 	return FReply::Handled();
 }
 
 bool SServerWidget::GetIsTickStepEnabled() const
 {
-	return true;
+	return MinimalServer && MinimalServer->GetTickSchedule().Mode == EMinimalClientTickMode::Step;
 }
 
 // send message button
@@ -259,7 +295,7 @@ void SServerWidget::OnReceiveMessage(const FString& InText, class UNetConnection
 {
 	if (HistoryBox)
 	{
-		HistoryBox->InsertTextAtCursor(InText);
+		HistoryBox->AddMessage(InText);
 	}
 }
 
@@ -9,6 +9,8 @@
 #include "Widgets/Input/SMultiLineEditableTextBox.h"
 #include "MinimalClient.h"
 
+class SMessageHistory;
+
 
 /* Implements the client operating window. */
 class SClientWidget : public SCompoundWidget
@@ -60,7 +62,7 @@ protected:
 
 	void OnReceiveMessage(const FString& InText, class UNetConnection* InConnection);
 protected:
-	TSharedPtr<SMultiLineEditableTextBox>  HistoryBox;
+	TSharedPtr<SMessageHistory>  HistoryBox;
 	TSharedPtr<SMultiLineEditableTextBox>  SendBox;
 
 	FString IpAddress;
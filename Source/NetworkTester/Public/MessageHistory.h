@@ -0,0 +1,88 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Widgets/DeclarativeSyntaxSupport.h"
+#include "Widgets/SCompoundWidget.h"
+#include "Widgets/Views/SListView.h"
+
+
+/** Rate limiting of message history views, shared by every view (set with NetTester.History.RateLimit) */
+struct FMessageHistoryRateLimit
+{
+	/** The number of messages per second accepted before limiting kicks in, or 0 for no limit */
+	int32 MaxPerSecond = 0;
+
+	/** Above the limit, keep one message in this many (0 drops them all) */
+	int32 SampleEvery = 0;
+
+	static FMessageHistoryRateLimit& Get();
+};
+
+
+/*
+ * Virtualized message history: messages go into a bounded ring buffer, and the list view is rebuilt at most once per
+ * frame, so only the visible rows are laid out no matter how many messages arrive.
+ */
+class SMessageHistory : public SCompoundWidget
+{
+public:
+	SLATE_BEGIN_ARGS(SMessageHistory)
+		: _Capacity(10000)
+		{}
+
+		/** The number of messages kept (older messages are discarded) */
+		SLATE_ARGUMENT(int32, Capacity)
+	SLATE_END_ARGS()
+
+	/**
+	* Constructs this widget.
+	*/
+	void Construct(const FArguments& InArgs);
+
+	/** Adds a message, which becomes visible on the next frame */
+	void AddMessage(const FString& InText);
+
+	/** Removes all messages */
+	void Clear();
+
+protected:
+	/** On the frame after messages arrive, appends them to the list view (the timer is only registered while dirty) */
+	EActiveTimerReturnType UpdateList(double InCurrentTime, float InDeltaTime);
+
+	TSharedRef<ITableRow> OnGenerateRow(TSharedPtr<FString> InItem, const TSharedRef<STableViewBase>& OwnerTable);
+
+	FText GetStatusText() const;
+
+	/** @return Whether or not the message should be kept, according to FMessageHistoryRateLimit */
+	bool PassesRateLimit();
+
+protected:
+	TSharedPtr<SListView<TSharedPtr<FString>>> ListView;
+
+	/** Ring buffer of messages */
+	TArray<TSharedPtr<FString>> Messages;
+
+	/** Index of the oldest message */
+	int32 Head;
+
+	/** Number of messages in the ring */
+	int32 Count;
+
+	/** The ring buffer in order, as displayed by the list view */
+	TArray<TSharedPtr<FString>> VisibleMessages;
+
+	/** The number of messages at the end of the ring which are not in VisibleMessages yet */
+	int32 NumPending;
+
+	/** Whether or not the update timer is registered (messages were added since the list view was last updated) */
+	bool bDirty;
+
+	/** Rate limiting window */
+	double RateWindowStart;
+	int32 NumInRateWindow;
+
+	uint64 NumReceived;
+	uint64 NumDropped;
+};
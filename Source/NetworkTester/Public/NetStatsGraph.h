@@ -0,0 +1,61 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Widgets/DeclarativeSyntaxSupport.h"
+#include "Widgets/SLeafWidget.h"
+
+/* A sparkline of the most recent values of one stat, drawn from a fixed-size ring buffer. */
+class SNetStatsGraph : public SLeafWidget
+{
+public:
+	SLATE_BEGIN_ARGS(SNetStatsGraph)
+		: _Capacity(120)
+		, _Color(FLinearColor::Green)
+		{}
+
+		/** The name of the stat, drawn in the corner */
+		SLATE_ARGUMENT(FText, Label)
+
+		/** The number of values kept (and drawn across the width of the graph) */
+		SLATE_ARGUMENT(int32, Capacity)
+
+		/** The color of the line */
+		SLATE_ARGUMENT(FLinearColor, Color)
+	SLATE_END_ARGS()
+
+	/**
+	* Constructs this widget.
+	*/
+	void Construct(const FArguments& InArgs);
+
+	/** Adds a value, dropping the oldest one if the graph is full */
+	void AddValue(float InValue);
+
+	/** Removes all values */
+	void Reset();
+
+	// SWidget
+	virtual int32 OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect,
+		FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const override;
+
+protected:
+	virtual FVector2D ComputeDesiredSize(float LayoutScaleMultiplier) const override;
+
+protected:
+	FText Label;
+	FLinearColor Color;
+
+	/** Ring buffer of values */
+	TArray<float> Values;
+
+	/** Index of the oldest value */
+	int32 Head;
+
+	/** Number of values in the ring */
+	int32 Count;
+
+	/** Line points, reused between paints */
+	mutable TArray<FVector2D> Points;
+};
@@ -0,0 +1,78 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Widgets/DeclarativeSyntaxSupport.h"
+#include "Widgets/SCompoundWidget.h"
+#include "Widgets/Views/SListView.h"
+#include "NetStatsRecorder.h"
+
+class SNetStatsGraph;
+class UMinimalClient;
+
+
+/** The live stats of one connection, as shown by one row of the connection table */
+struct FNetConnectionRowData
+{
+	uint32 ConnectionId = 0;
+	float InKBps = 0.f;
+	float OutKBps = 0.f;
+	float RttMs = 0.f;
+	float LossPct = 0.f;
+	int32 QueuedBits = 0;
+	bool bSaturated = false;
+};
+
+
+/* Live throughput/latency graphs of a minimal client, and optionally a table of its connections. */
+class SNetStatsPanel : public SCompoundWidget
+{
+public:
+	SLATE_BEGIN_ARGS(SNetStatsPanel)
+		: _MinimalClient(nullptr)
+		, _ShowConnectionTable(false)
+		{}
+
+		/** The client (or listen server) to display, which must outlive this widget */
+		SLATE_ARGUMENT(UMinimalClient*, MinimalClient)
+
+		/** Whether or not to show the per-connection table */
+		SLATE_ARGUMENT(bool, ShowConnectionTable)
+	SLATE_END_ARGS()
+
+	/** Virtual destructor. */
+	virtual ~SNetStatsPanel();
+
+	/**
+	* Constructs this widget.
+	*/
+	void Construct(const FArguments& InArgs);
+
+protected:
+	/** Pulls the latest snapshot from the client, and updates the graphs and table */
+	EActiveTimerReturnType UpdateStats(double InCurrentTime, float InDeltaTime);
+
+	TSharedRef<ITableRow> OnGenerateConnectionRow(TSharedPtr<FNetConnectionRowData> InItem, const TSharedRef<STableViewBase>& OwnerTable);
+
+protected:
+	UMinimalClient* MinimalClient;
+
+	TSharedPtr<SNetStatsGraph> InKBpsGraph;
+	TSharedPtr<SNetStatsGraph> OutKBpsGraph;
+	TSharedPtr<SNetStatsGraph> PacketsGraph;
+	TSharedPtr<SNetStatsGraph> RttGraph;
+	TSharedPtr<SNetStatsGraph> LossGraph;
+
+	TSharedPtr<SListView<TSharedPtr<FNetConnectionRowData>>> ConnectionList;
+
+	/** Table rows, in snapshot order (updated in place, rows read them through attributes) */
+	TArray<TSharedPtr<FNetConnectionRowData>> ConnectionRows;
+
+	/** The latest snapshot, and the one before it (for computing rates) */
+	TArray<FNetConnectionSample> CurSamples;
+	TArray<FNetConnectionSample> PrevSamples;
+
+	/** The index in PrevSamples of each connection id, rebuilt every update */
+	TMap<uint32, int32> PrevSampleIndices;
+};
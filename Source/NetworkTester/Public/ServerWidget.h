@@ -9,6 +9,8 @@
 #include "Widgets/Input/SMultiLineEditableTextBox.h"
 #include "MinimalClient.h"
 
+class SMessageHistory;
+
 /* Implements the server operating window. */
 class SServerWidget : public SCompoundWidget
 {
@@ -59,7 +61,7 @@ protected:
 
 	void OnReceiveMessage(const FString& InText, class UNetConnection* InConnection);
 protected:
-	TSharedPtr<SMultiLineEditableTextBox>  HistoryBox;
+	TSharedPtr<SMessageHistory>  HistoryBox;
 	TSharedPtr<SMultiLineEditableTextBox>  SendBox;
 
 	FString IpAddress;